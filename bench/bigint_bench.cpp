@@ -0,0 +1,89 @@
+/**
+ * @file bigint_bench.cpp
+ * @brief dep::BigInt微基准: 10^1..10^6位十进制数的解析/乘法/除法/十进制输出耗时, 并用恒等式检查结果
+ *
+ * 乘除法与十进制转换的算法切换阈值(karatsuba/toom3/ntt/bz/radix_dc)按本基准在各算法的交叉点选取
+ * 构建: cmake -DKIZ_BUILD_BENCH=ON, 运行: ./bigint_bench [最大十进制位数]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "bigint.hpp"
+
+std::mt19937_64 rng(42);
+
+std::string random_digits(const size_t digits) {
+    std::string s(digits, '0');
+    s[0] = static_cast<char>('1' + rng() % 9);
+    for (size_t i = 1; i < digits; ++i) s[i] = static_cast<char>('0' + rng() % 10);
+    return s;
+}
+
+template <typename F>
+double measure_ms(F&& f) {
+    // 至少重复到累计20ms, 取平均
+    int rounds = 0;
+    const auto start = std::chrono::steady_clock::now();
+    auto now = start;
+    do {
+        f();
+        ++rounds;
+        now = std::chrono::steady_clock::now();
+    } while (now - start < std::chrono::milliseconds(20));
+    return std::chrono::duration<double, std::milli>(now - start).count() / rounds;
+}
+
+// 乘除法与十进制转换的一致性: (a*b)/b == a, (a*b+c)%b == c, (a*b+c)/b == a (c < b), 模小素数同余, 字符串往返
+bool check(const size_t a_digits, const size_t b_digits) {
+    const std::string a_str = random_digits(a_digits);
+    const dep::BigInt a(a_str);
+    const dep::BigInt b(random_digits(b_digits));
+    const dep::BigInt c = b - dep::BigInt(1);
+    const dep::BigInt prod = a * b;
+    if (a.to_string() != a_str) return false;
+    if (prod / b != a) return false;
+    if ((prod + c) % b != c) return false;
+    if ((prod + c) / b != a) return false;
+    if ((prod + a - dep::BigInt(1)) / a != b) return false;
+    const dep::BigInt p(1000000007);
+    if (prod % p != ((a % p) * (b % p)) % p) return false;
+    if (a * a % p != ((a % p) * (a % p)) % p) return false;
+    if (dep::BigInt(prod.to_string()) != prod) return false;
+    const dep::BigInt neg = dep::BigInt(0) - a;
+    return neg * b == dep::BigInt(0) - prod and neg / b == dep::BigInt(0) - (a / b);
+}
+
+int main(const int argc, char* argv[]) {
+    const size_t max_digits = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    bool ok = true;
+    for (size_t digits = 1; digits <= 300000; digits = digits * 3 / 2 + 1) {
+        ok = ok and check(digits, digits / 2 + 1) and check(digits, digits);
+    }
+    std::cout << "consistency check: " << (ok ? "ok" : "FAILED") << "\n";
+
+    for (size_t digits = 10; digits <= max_digits; digits *= 10) {
+        const std::string a_str = random_digits(digits);
+        const dep::BigInt a(a_str);
+        const dep::BigInt b(random_digits(digits));
+        const dep::BigInt wide = a * b;
+        size_t sink = 0;
+        const double parse_ms = measure_ms([&] { sink += dep::BigInt(a_str).is_negative(); });
+        const double mul_ms = measure_ms([&] { sink += (a * b).is_negative(); });
+        const double sqr_ms = measure_ms([&] { sink += (a * a).is_negative(); });
+        const double div_ms = measure_ms([&] { sink += (wide / b).is_negative(); });
+        const double str_ms = measure_ms([&] { sink += a.to_string().size(); });
+        std::cout << "digits " << digits
+                  << "  parse " << parse_ms << " ms"
+                  << "  mul " << mul_ms << " ms"
+                  << "  square " << sqr_ms << " ms"
+                  << "  div(2n/n) " << div_ms << " ms"
+                  << "  to_string " << str_ms << " ms"
+                  << "  (" << sink << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file dict_bench.cpp
+ * @brief dep::Dict微基准: 紧凑有序字典的插入/更新/查找/删除/遍历, 并与std::unordered_map比对正确性
+ *
+ * 键为带自定义哈希的整数, 用极少的不同哈希值制造大量冲突, 检查冲突键不会互相覆盖
+ * 构建: cmake -DKIZ_BUILD_BENCH=ON, 运行: ./dict_bench [键数量]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dict.hpp"
+
+using KeyValue = std::pair<uint64_t, uint64_t>;
+
+size_t mix(const uint64_t key) {
+    return static_cast<size_t>(key * 0xBF58476D1CE4E5B9ULL);
+}
+
+auto key_is(const uint64_t key) {
+    return [key](const KeyValue& kv) { return kv.first == key; };
+}
+
+template <typename F>
+double measure_ns(F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+// 随机插入/更新/删除并与std::unordered_map比对; hash_bits限制哈希值个数以制造冲突
+bool check_against_std(const size_t ops, const uint64_t hash_bits) {
+    std::mt19937_64 rng(42);
+    dep::Dict<KeyValue> dict;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    std::vector<uint64_t> order;  // 参考插入顺序
+    const auto hash_of = [hash_bits](const uint64_t key) { return mix(key) & hash_bits; };
+    for (size_t i = 0; i < ops; ++i) {
+        const uint64_t key = rng() % 2048;
+        if (rng() % 3 == 0) {
+            const bool erased = dict.erase(hash_of(key), key_is(key));
+            if (erased != (ref.erase(key) == 1)) return false;
+            if (erased) order.erase(std::find(order.begin(), order.end(), key));
+        } else if (const auto entry = dict.find(hash_of(key), key_is(key))) {
+            entry->value.second = i;
+            ref[key] = i;
+        } else {
+            dict.append(hash_of(key), {key, i});
+            ref[key] = i;
+            order.push_back(key);
+        }
+        if (dict.size() != ref.size()) return false;
+    }
+    size_t pos = 0;
+    bool ok = true;
+    dict.for_each([&](size_t, const KeyValue& kv) {
+        ok = ok and pos < order.size() and kv.first == order[pos] and kv.second == ref[kv.first];
+        ++pos;
+    });
+    return ok and pos == order.size();
+}
+
+int main(const int argc, char* argv[]) {
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const bool ok = check_against_std(200000, ~0ULL) and check_against_std(200000, 0xF);
+    std::cout << "consistency check: " << (ok ? "ok" : "FAILED") << "\n";
+    std::cout << "keys: " << n << "\n";
+
+    // 聚合: n条记录落到n/8个键上, 与Dictionary的setitem路径相同(先find再append)
+    dep::Dict<KeyValue> dict;
+    const uint64_t groups = std::max<uint64_t>(1, n / 8);
+    uint64_t sink = 0;
+    const double agg_ns = measure_ns([&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            const uint64_t key = i % groups;
+            if (const auto entry = dict.find(mix(key), key_is(key))) {
+                entry->value.second += 1;
+            } else {
+                dict.append(mix(key), {key, 1});
+            }
+        }
+    });
+    const double iter_ns = measure_ns([&] {
+        for (size_t pos = 0; pos < dict.entry_count(); ++pos) {
+            if (const auto entry = dict.entry_at(pos)) sink += entry->value.second;
+        }
+    });
+    const double del_ns = measure_ns([&] {
+        for (uint64_t key = 0; key < groups; key += 2) sink += dict.erase(mix(key), key_is(key));
+    });
+
+    const auto records = static_cast<double>(n);
+    const auto keys = static_cast<double>(groups);
+    std::cout << "aggregate " << agg_ns / records << " ns/record"
+              << "  iterate " << iter_ns / keys << " ns/entry"
+              << "  erase " << del_ns / (keys / 2) << " ns/op"
+              << "  (" << sink << ")\n";
+    return 0;
+}
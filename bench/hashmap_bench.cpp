@@ -0,0 +1,174 @@
+/**
+ * @file hashmap_bench.cpp
+ * @brief dep::HashMap微基准: 与旧的链地址法实现(shared_ptr节点)对比插入/查找/删除
+ *
+ * 构建: cmake -DKIZ_BUILD_BENCH=ON, 运行: ./hashmap_bench [键数量]
+ *
+ * 命中查找和删除各按插入顺序与打乱顺序测一次: 旧实现的节点按插入顺序分配, 且FNV-1a低位让相邻的键
+ * 落在相邻的桶里, 按插入顺序访问时几乎是顺序读内存; 打乱后两者都是随机访问
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hashmap.hpp"
+
+namespace legacy {
+
+// 旧实现: 每个键值对一个shared_ptr链表节点
+template <typename VT>
+class ChainedHashMap {
+    struct Node {
+        std::string key;
+        VT value;
+        size_t hash;
+        std::shared_ptr<Node> next;
+    };
+    std::vector<std::shared_ptr<Node>> buckets_ = std::vector<std::shared_ptr<Node>>(16);
+    size_t elem_count_ = 0;
+
+    void resize() {
+        std::vector<std::shared_ptr<Node>> new_buckets(buckets_.size() * 2);
+        for (auto& head : buckets_) {
+            auto current = head;
+            while (current) {
+                auto next = current->next;
+                const size_t idx = current->hash & (new_buckets.size() - 1);
+                current->next = new_buckets[idx];
+                new_buckets[idx] = current;
+                current = next;
+            }
+        }
+        buckets_.swap(new_buckets);
+    }
+
+public:
+    void insert(const std::string& key, VT val) {
+        const size_t hash = dep::hash_string(key);
+        for (auto current = buckets_[hash & (buckets_.size() - 1)]; current; current = current->next) {
+            if (current->hash == hash && current->key == key) {
+                current->value = std::move(val);
+                return;
+            }
+        }
+        if (static_cast<float>(elem_count_) / buckets_.size() >= 0.7f) resize();
+        auto& head = buckets_[hash & (buckets_.size() - 1)];
+        head = std::make_shared<Node>(Node{key, std::move(val), hash, head});
+        ++elem_count_;
+    }
+
+    std::shared_ptr<Node> find(const std::string& key) const {
+        const size_t hash = dep::hash_string(key);
+        for (auto current = buckets_[hash & (buckets_.size() - 1)]; current; current = current->next) {
+            if (current->hash == hash && current->key == key) return current;
+        }
+        return nullptr;
+    }
+
+    bool del(const std::string& key) {
+        const size_t hash = dep::hash_string(key);
+        auto& head = buckets_[hash & (buckets_.size() - 1)];
+        std::shared_ptr<Node> prev = nullptr;
+        for (auto current = head; current; prev = current, current = current->next) {
+            if (current->hash == hash && current->key == key) {
+                (prev ? prev->next : head) = current->next;
+                --elem_count_;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace legacy
+
+template <typename F>
+double measure_ns(F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+// order: 命中查找和删除时访问键的顺序(keys的一个排列)
+template <typename Map>
+void run(const char* name, const std::vector<std::string>& keys, const std::vector<std::string>& order,
+         const std::vector<std::string>& misses) {
+    const int rounds = static_cast<int>(std::max<size_t>(10, 2000000 / keys.size()));
+    size_t sink = 0;
+    Map map;
+    const double insert_ns = measure_ns([&] {
+        for (size_t i = 0; i < keys.size(); ++i) map.insert(keys[i], i);
+    });
+    const double hit_ns = measure_ns([&] {
+        for (int r = 0; r < rounds; ++r)
+            for (const auto& k : order) sink += map.find(k)->value;
+    });
+    const double miss_ns = measure_ns([&] {
+        for (int r = 0; r < rounds; ++r)
+            for (const auto& k : misses) sink += map.find(k) ? 1 : 0;
+    });
+    const double del_ns = measure_ns([&] {
+        for (const auto& k : order) sink += map.del(k);
+    });
+    const auto n = static_cast<double>(keys.size());
+    std::cout << name
+              << "  insert " << insert_ns / n << " ns/op"
+              << "  find-hit " << hit_ns / (n * rounds) << " ns/op"
+              << "  find-miss " << miss_ns / (n * rounds) << " ns/op"
+              << "  del " << del_ns / n << " ns/op"
+              << "  (" << sink << ")\n";
+}
+
+// 随机插入/删除并与std::unordered_map比对, 检查向后移位删除的正确性
+bool check_against_std(const size_t ops) {
+    std::mt19937_64 rng(42);
+    dep::HashMap<size_t> map;
+    std::unordered_map<std::string, size_t> ref;
+    for (size_t i = 0; i < ops; ++i) {
+        const std::string key = "k" + std::to_string(rng() % 2048);
+        if (rng() % 3 == 0) {
+            if (map.del(key) != (ref.erase(key) == 1)) return false;
+        } else {
+            map.insert(key, i);
+            ref[key] = i;
+        }
+        if (map.size() != ref.size()) return false;
+    }
+    for (const auto& [k, v] : ref) {
+        const auto node = map.find(k);
+        if (!node || node->value != v) return false;
+    }
+    return true;
+}
+
+int main(const int argc, char* argv[]) {
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    std::vector<std::string> keys, misses;
+    keys.reserve(n);
+    misses.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back("attr_" + std::to_string(i));
+        misses.push_back("miss_" + std::to_string(i));
+    }
+
+    std::cout << "consistency check: " << (check_against_std(200000) ? "ok" : "FAILED") << "\n";
+    std::vector<std::string> shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(7));
+
+    std::cout << "keys: " << n << "\n";
+    std::cout << "-- hit/del in insertion order\n";
+    run<legacy::ChainedHashMap<size_t>>("chained", keys, keys, misses);
+    run<dep::HashMap<size_t>>("swiss  ", keys, keys, misses);
+    std::cout << "-- hit/del in shuffled order\n";
+    run<legacy::ChainedHashMap<size_t>>("chained", keys, shuffled, misses);
+    run<dep::HashMap<size_t>>("swiss  ", keys, shuffled, misses);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file object_bench.cpp
+ * @brief 对象模型热路径微基准: Vm::is_true与Int.__add__(int_add)的单次调用耗时
+ *
+ * 两者在几乎所有解释器profile中排在前列, 主要开销是对象类型判断与参数转换
+ * 构建: cmake -DKIZ_BUILD_BENCH=ON, 运行: ./object_bench [迭代次数]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "models/models.hpp"
+#include "vm/vm.hpp"
+#include "builtins/include/builtin_methods.hpp"
+
+template <typename F>
+double measure_ns(const size_t iterations, F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) f(i);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+}
+
+// 调用原生方法并释放返回值, 返回结果的哈希以免被优化掉
+size_t call_and_release(model::Object* (*method)(model::Object*, const model::List*),
+    model::Object* self, const model::List* args) {
+    const auto result = method(self, args);
+    result->make_ref();
+    const size_t sink = model::dyn<model::Int>(result) ? 1 : 0;
+    result->del_ref();
+    return sink;
+}
+
+int main(const int argc, char* argv[]) {
+    const size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    // 初始化内置原型与小整数池
+    kiz::Vm vm("<bench>");
+
+    // is_true: Bool/Nil走快速路径, 其余类型需分派__bool__, 这里只测快速路径
+    const std::vector<model::Object*> truthy = {
+        model::load_true(), model::load_false(), model::load_nil(), model::load_true()
+    };
+    size_t sink = 0;
+    const double is_true_ns = measure_ns(iterations, [&](const size_t i) {
+        sink += kiz::Vm::is_true(truthy[i & 3]);
+    });
+
+    // int_add: 机器字范围内的Int对象(结果超出小整数池, 需分配新Int)与BigInt
+    const auto word_a = new model::Int(dep::BigInt(1000));
+    const auto word_args = new model::List({new model::Int(dep::BigInt(2000))});
+    const auto big_a = new model::Int(dep::BigInt("123456789012345678901234567890"));
+    const auto big_args = new model::List({new model::Int(dep::BigInt("987654321098765432109876543210"))});
+    word_a->make_ref();
+    word_args->make_ref();
+    big_a->make_ref();
+    big_args->make_ref();
+
+    const double word_add_ns = measure_ns(iterations / 4, [&](size_t) {
+        sink += call_and_release(model::int_add, word_a, word_args);
+    });
+    const double big_add_ns = measure_ns(iterations / 4, [&](size_t) {
+        sink += call_and_release(model::int_add, big_a, big_args);
+    });
+
+    std::cout << "is_true         " << is_true_ns << " ns/call\n"
+              << "int_add (word)  " << word_add_ns << " ns/call\n"
+              << "int_add (big)   " << big_add_ns << " ns/call\n"
+              << "(" << sink << ")\n";
+    return 0;
+}
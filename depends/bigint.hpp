@@ -1,20 +1,24 @@
 /**
  * @file bigint.hpp
  * @brief 无限精度整数（BigInt）核心定义
- *  * 采用逆序存储 digits（如 123 存储为 [3,2,1]），最小化进位/借位时的元素移动开销；
- * 支持 size_t 与合法数字字符串初始化，内置高效比较与 IO 操作。
+ *
+ * 符号-绝对值表示: 绝对值按2^32进制的limb小端存放(低位limb在前),
+ * 符号与limb数合并保存在size_中(负数为负, 零为0, 与GMP相同).
+ * 不超过两个limb(即64位)的值直接内联在对象里, 不分配堆内存.
+ * 乘法按规模依次使用教科书乘法/Karatsuba/Toom-3/NTT(三素数数论变换),
+ * 除法使用Knuth算法D, 长除数时改用Burnikel-Ziegler递归除法;
+ * 十进制字符串转换在大数时按10^(9 * 2^k)分治, 与快速乘除法配合达到次二次复杂度.
  * @author azhz1107cat
  * @date 2025-10-25
- * @note 修复核心问题：
- *  1. div_mod_unsigned 中用二分查找替换逐次累加，避免无限循环
- *  2. Karatsuba 乘法添加基准阈值，减少递归深度
- *  3. shift_left 优化内存操作，避免 vector 开头插入的低效行为
  */
 
 #pragma once
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -26,209 +30,834 @@
 namespace dep {
 
 class BigInt {
-    std::vector<uint8_t> digits_; // 逆序存储（低位在前），每个元素 0-9
-    bool is_negative_;            // false=正，true=负；0恒为非负
+    using limb_t = uint32_t;
+    using dlimb_t = uint64_t;
+    static constexpr int limb_bits = 32;
+    static constexpr uint32_t inline_limbs = 2;
+
+    // 乘法算法切换阈值(按较短操作数的limb数), 由bench/bigint_bench.cpp测得
+    static constexpr size_t karatsuba_threshold = 32;
+    static constexpr size_t toom3_threshold = 200;
+    static constexpr size_t ntt_threshold = 5000;
+    // 除法: 除数和商都不少于该limb数时使用Burnikel-Ziegler递归除法
+    static constexpr size_t bz_threshold = 80;
+    // 十进制转换: 超过该limb数时使用分治
+    static constexpr size_t radix_dc_threshold = 30;
+
+    int32_t size_ = 0;                  // |size_|为有效limb数(无前导零limb), 负数时取负
+    uint32_t capacity_ = inline_limbs;  // 等于inline_limbs时使用内联存储
+    union {
+        limb_t inline_[inline_limbs];
+        limb_t* heap_;
+    };
+
+    // ========================= 存储管理 =========================
+    [[nodiscard]] limb_t* data() { return capacity_ == inline_limbs ? inline_ : heap_; }
+    [[nodiscard]] const limb_t* data() const { return capacity_ == inline_limbs ? inline_ : heap_; }
+    [[nodiscard]] uint32_t len() const { return size_ < 0 ? static_cast<uint32_t>(-size_) : static_cast<uint32_t>(size_); }
+    [[nodiscard]] bool is_zero() const { return size_ == 0; }
 
     /**
-     * @brief 移除前导零（逆序中为末尾零），确保数字表示唯一
+     * @brief 保证容量至少为n个limb
+     * @param keep 是否保留原有的limb
      */
-    void trim_leading_zeros() {
-        while (digits_.size() > 1 && digits_.back() == 0) {
-            digits_.pop_back();
+    void reserve(const uint32_t n, const bool keep = true) {
+        if (n <= capacity_) return;
+        auto new_data = new limb_t[n];
+        if (keep) std::copy_n(data(), len(), new_data);
+        if (capacity_ != inline_limbs) delete[] heap_;
+        heap_ = new_data;
+        capacity_ = n;
+    }
+
+    ///| 写入前n个limb后调用: 去掉前导零limb并设置符号, 零恒为非负
+    void set_trimmed(uint32_t n, const bool negative) {
+        const limb_t* d = data();
+        while (n > 0 && d[n - 1] == 0) --n;
+        size_ = negative ? -static_cast<int32_t>(n) : static_cast<int32_t>(n);
+    }
+
+    void set_u64(const uint64_t v, const bool negative) {
+        limb_t* d = data();
+        d[0] = static_cast<limb_t>(v);
+        d[1] = static_cast<limb_t>(v >> limb_bits);
+        set_trimmed(2, negative);
+    }
+
+    ///| 绝对值的低64位, 仅在len() <= 2时等于绝对值
+    [[nodiscard]] uint64_t low_u64() const {
+        const limb_t* d = data();
+        const uint32_t n = len();
+        uint64_t v = n > 0 ? d[0] : 0;
+        if (n > 1) v |= static_cast<uint64_t>(d[1]) << limb_bits;
+        return v;
+    }
+
+    static BigInt from_limbs(const limb_t* p, size_t n, const bool negative = false) {
+        while (n > 0 && p[n - 1] == 0) --n;
+        BigInt res;
+        res.reserve(static_cast<uint32_t>(n), false);
+        std::copy_n(p, n, res.data());
+        res.set_trimmed(static_cast<uint32_t>(n), negative);
+        return res;
+    }
+
+    // ========================= limb数组运算(均为无符号) =========================
+    static int cmp_limbs(const limb_t* a, const size_t an, const limb_t* b, const size_t bn) {
+        if (an != bn) return an < bn ? -1 : 1;
+        for (size_t i = an; i-- > 0;) {
+            if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
         }
-        if (digits_.size() == 1 && digits_[0] == 0) {
-            is_negative_ = false;
+        return 0;
+    }
+
+    ///| r[0, an) = a + b, 要求an >= bn, r可与a重合; 返回最高位进位
+    static limb_t add_limbs(limb_t* r, const limb_t* a, const size_t an, const limb_t* b, const size_t bn) {
+        dlimb_t carry = 0;
+        size_t i = 0;
+        for (; i < bn; ++i) {
+            carry += static_cast<dlimb_t>(a[i]) + b[i];
+            r[i] = static_cast<limb_t>(carry);
+            carry >>= limb_bits;
         }
+        for (; i < an; ++i) {
+            carry += a[i];
+            r[i] = static_cast<limb_t>(carry);
+            carry >>= limb_bits;
+        }
+        return static_cast<limb_t>(carry);
+    }
+
+    ///| r[0, an) = a - b, 要求an >= bn, r可与a重合; 返回最高位借位
+    static limb_t sub_limbs(limb_t* r, const limb_t* a, const size_t an, const limb_t* b, const size_t bn) {
+        limb_t borrow = 0;
+        size_t i = 0;
+        for (; i < bn; ++i) {
+            const dlimb_t diff = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<limb_t>(diff);
+            borrow = static_cast<limb_t>(diff >> limb_bits) & 1;
+        }
+        for (; i < an; ++i) {
+            const dlimb_t diff = static_cast<dlimb_t>(a[i]) - borrow;
+            r[i] = static_cast<limb_t>(diff);
+            borrow = static_cast<limb_t>(diff >> limb_bits) & 1;
+        }
+        return borrow;
+    }
+
+    ///| r[0, rn) += a[0, an), 调用方保证结果不溢出rn个limb
+    static void add_into(limb_t* r, const size_t rn, const limb_t* a, size_t an) {
+        while (an > 0 && a[an - 1] == 0) --an;
+        assert(an <= rn);
+        limb_t carry = add_limbs(r, r, an, a, an);
+        for (size_t i = an; carry && i < rn; ++i) carry = ++r[i] == 0;
+        assert(carry == 0);
     }
 
+    ///| r[0, rn) -= a[0, an), 调用方保证结果非负
+    static void sub_into(limb_t* r, const size_t rn, const limb_t* a, size_t an) {
+        while (an > 0 && a[an - 1] == 0) --an;
+        assert(an <= rn);
+        limb_t borrow = sub_limbs(r, r, an, a, an);
+        for (size_t i = an; borrow && i < rn; ++i) borrow = r[i]-- == 0;
+        assert(borrow == 0);
+    }
+
+    ///| r[0, n) = a * m + add, r可与a重合; 返回最高位进位
+    static limb_t mul_small_add(limb_t* r, const limb_t* a, const size_t n, const limb_t m, const limb_t add) {
+        dlimb_t carry = add;
+        for (size_t i = 0; i < n; ++i) {
+            carry += static_cast<dlimb_t>(a[i]) * m;
+            r[i] = static_cast<limb_t>(carry);
+            carry >>= limb_bits;
+        }
+        return static_cast<limb_t>(carry);
+    }
+
+    ///| q[0, n) = a / d, q可与a重合; 返回余数
+    static limb_t divmod_small(limb_t* q, const limb_t* a, const size_t n, const limb_t d) {
+        dlimb_t rem = 0;
+        for (size_t i = n; i-- > 0;) {
+            const dlimb_t cur = (rem << limb_bits) | a[i];
+            q[i] = static_cast<limb_t>(cur / d);
+            rem = cur % d;
+        }
+        return static_cast<limb_t>(rem);
+    }
+
+    ///| 教科书乘法, r[0, an + bn)
+    static void mul_schoolbook(limb_t* r, const limb_t* a, const size_t an, const limb_t* b, const size_t bn) {
+        std::fill_n(r, an + bn, 0);
+        for (size_t j = 0; j < bn; ++j) {
+            const dlimb_t m = b[j];
+            if (m == 0) continue;
+            dlimb_t carry = 0;
+            for (size_t i = 0; i < an; ++i) {
+                carry += a[i] * m + r[i + j];
+                r[i + j] = static_cast<limb_t>(carry);
+                carry >>= limb_bits;
+            }
+            r[an + j] = static_cast<limb_t>(carry);
+        }
+    }
+
+    /**
+     * @brief Karatsuba乘法, 要求bn <= an < 2 * bn
+     * a = a1 * B^m + a0, b = b1 * B^m + b0,
+     * a * b = z2 * B^2m + (z1 - z2 - z0) * B^m + z0, 其中z1 = (a0 + a1)(b0 + b1)
+     */
+    static void mul_karatsuba(limb_t* r, const limb_t* a, const size_t an, const limb_t* b, const size_t bn) {
+        const size_t m = an / 2;
+        const size_t a1n = an - m, b1n = bn - m;
+        mul_limbs(r, a, m, b, m);                   // z0 -> r[0, 2m)
+        mul_limbs(r + 2 * m, a + m, a1n, b + m, b1n);  // z2 -> r[2m, an + bn)
+
+        std::vector<limb_t> sa(a1n + 1), sb(std::max(m, b1n) + 1);
+        sa[a1n] = add_limbs(sa.data(), a + m, a1n, a, m);
+        if (b1n >= m) {
+            sb[b1n] = add_limbs(sb.data(), b + m, b1n, b, m);
+        } else {
+            sb[m] = add_limbs(sb.data(), b, m, b + m, b1n);
+        }
+
+        std::vector<limb_t> z1(sa.size() + sb.size());
+        mul_limbs(z1.data(), sa.data(), sa.size(), sb.data(), sb.size());
+        sub_into(z1.data(), z1.size(), r, 2 * m);
+        sub_into(z1.data(), z1.size(), r + 2 * m, a1n + b1n);
+        add_into(r + m, an + bn - m, z1.data(), z1.size());
+    }
+
+    ///| 精确除以小整数(余数必须为0), 保留符号
+    static void divexact_small(BigInt& x, const limb_t d) {
+        const bool negative = x.size_ < 0;
+        [[maybe_unused]] const limb_t rem = divmod_small(x.data(), x.data(), x.len(), d);
+        assert(rem == 0);
+        x.set_trimmed(x.len(), negative);
+    }
+
+    /**
+     * @brief Toom-3乘法, 要求bn <= an < 2 * bn
+     * 按B^k把操作数拆成三段视为二次多项式, 在0, 1, -1, -2, ∞五点求值后递归相乘,
+     * 再按Bodrato的插值序列还原乘积的五个系数. 求值点可能为负, 因此用带符号的BigInt计算
+     */
+    static void mul_toom3(limb_t* r, const limb_t* a, const size_t an, const limb_t* b, const size_t bn) {
+        const size_t k = (an + 2) / 3;
+        auto part = [k](const limb_t* p, const size_t n, const size_t i) {
+            const size_t lo = std::min(n, i * k);
+            const size_t hi = std::min(n, lo + k);
+            return from_limbs(p + lo, hi - lo);
+        };
+        const BigInt a0 = part(a, an, 0), a1 = part(a, an, 1), a2 = part(a, an, 2);
+        const BigInt b0 = part(b, bn, 0), b1 = part(b, bn, 1), b2 = part(b, bn, 2);
+
+        BigInt pa = a0 + a2, pb = b0 + b2;
+        const BigInt pa1 = pa + a1, pb1 = pb + b1;          // p(1)
+        const BigInt pam1 = pa - a1, pbm1 = pb - b1;        // p(-1)
+        const BigInt pam2 = (pam1 + a2) * BigInt(2) - a0;   // p(-2)
+        const BigInt pbm2 = (pbm1 + b2) * BigInt(2) - b0;
+
+        const BigInt v0 = a0 * b0;
+        const BigInt v1 = pa1 * pb1;
+        const BigInt vm1 = pam1 * pbm1;
+        const BigInt vm2 = pam2 * pbm2;
+        const BigInt vinf = a2 * b2;
+
+        BigInt r3 = vm2 - v1;
+        divexact_small(r3, 3);
+        BigInt r1 = v1 - vm1;
+        divexact_small(r1, 2);
+        BigInt r2 = vm1 - v0;
+        r3 = r2 - r3;
+        divexact_small(r3, 2);
+        r3 += vinf * BigInt(2);
+        r2 = r2 + r1 - vinf;
+        r1 -= r3;
+
+        // 五个系数都是非负数
+        const size_t rn = an + bn;
+        std::fill_n(r, rn, 0);
+        const BigInt* coeffs[] = {&v0, &r1, &r2, &r3, &vinf};
+        for (size_t i = 0; i < 5; ++i) {
+            assert(!coeffs[i]->is_negative());
+            if (coeffs[i]->is_zero()) continue;
+            add_into(r + i * k, rn - i * k, coeffs[i]->data(), coeffs[i]->len());
+        }
+    }
+
+    // ========================= 数论变换(NTT)乘法 =========================
     /**
-     * @brief 绝对值比较（辅助减法/乘法）：返回 *this 的绝对值是否小于 other 的绝对值
+     * @brief NTT友好素数 p = c * 2^k + 1 上的Montgomery模乘
+     * 元素以Montgomery形式(x * 2^32 mod p)保存在[0, p)中
      */
-    [[nodiscard]] bool abs_less(const BigInt& other) const {
-        if (digits_.size() != other.digits_.size()) {
-            return digits_.size() < other.digits_.size();
-        }
-        // 从最高位（digits_末尾）逐位比
-        for (auto it1 = digits_.rbegin(), it2 = other.digits_.rbegin(); it1 != digits_.rend(); ++it1, ++it2) {
-            if (*it1 != *it2) {
-                return *it1 < *it2;
+    struct NttPrime {
+        uint32_t mod;
+        uint32_t root;  // 原根
+        uint32_t ninv;  // -p^-1 mod 2^32
+        uint32_t r2;    // 2^64 mod p
+
+        constexpr NttPrime(const uint32_t p, const uint32_t g) : mod(p), root(g), ninv(0), r2(0) {
+            uint32_t inv = p;
+            for (int i = 0; i < 5; ++i) inv *= 2 - p * inv;  // 牛顿迭代求p在2^32下的逆元
+            ninv = 0 - inv;
+            r2 = static_cast<uint32_t>((0 - static_cast<uint64_t>(p)) % p);  // (2^64 - p) mod p
+        }
+
+        // p < 2^30, 条件减法用符号位掩码实现, 避免随数据变化的分支预测失败
+        [[nodiscard]] uint32_t fix(const uint32_t x) const {
+            const int32_t d = static_cast<int32_t>(x - mod);
+            return static_cast<uint32_t>(d + ((d >> 31) & static_cast<int32_t>(mod)));
+        }
+        [[nodiscard]] uint32_t reduce(const uint64_t t) const {
+            const uint32_t m = static_cast<uint32_t>(t) * ninv;
+            return fix(static_cast<uint32_t>((t + static_cast<uint64_t>(m) * mod) >> 32));
+        }
+        [[nodiscard]] uint32_t mul(const uint32_t a, const uint32_t b) const {
+            return reduce(static_cast<uint64_t>(a) * b);
+        }
+        [[nodiscard]] uint32_t add(const uint32_t a, const uint32_t b) const {
+            return fix(a + b);
+        }
+        [[nodiscard]] uint32_t sub(const uint32_t a, const uint32_t b) const {
+            return fix(a + mod - b);
+        }
+        // x < 2^32时x * r2 < p * 2^32, 无需先取模
+        [[nodiscard]] uint32_t to_mont(const uint32_t x) const {
+            return mul(x, r2);
+        }
+        [[nodiscard]] uint32_t from_mont(const uint32_t x) const {
+            return reduce(x);
+        }
+        [[nodiscard]] uint32_t pow(uint32_t base, uint64_t e) const {
+            uint32_t result = to_mont(1);
+            while (e) {
+                if (e & 1) result = mul(result, base);
+                base = mul(base, base);
+                e >>= 1;
             }
+            return result;
         }
-        return false; // 绝对值相等
+    };
+
+    // 三个素数之积约2^86, 足以无损表示min(an, bn) * (2^32)^2 (min(an, bn) <= 2^21)以内的卷积系数
+    static const NttPrime& ntt_prime(const size_t k) {
+        static constexpr NttPrime primes[3] = {
+            {998244353, 3},  // 119 * 2^23 + 1
+            {167772161, 3},  // 5 * 2^25 + 1
+            {469762049, 3},  // 7 * 2^26 + 1
+        };
+        return primes[k];
     }
+    static constexpr size_t ntt_max_length = static_cast<size_t>(1) << 23;
+    static constexpr size_t ntt_max_operand = static_cast<size_t>(1) << 21;
 
     /**
-     * @brief 核心辅助：计算 (dividend / divisor) 的商和余数（无符号，仅处理正整数）
-     * @param dividend 被除数（非负）
-     * @param divisor 除数（正，非零）
-     * @return  pair<商, 余数>（均非负）
-     * @note 修复：用二分查找替换逐次累加，避免无限循环
+     * @brief 原地NTT, a.size()为2的幂
+     * 正变换用DIF蝶形, 输出为位反转顺序; 逆变换用DIT蝶形, 接受位反转顺序的输入并输出自然顺序,
+     * 两者配合做卷积时无需位反转重排. 逆变换同时乘以n^-1并把结果转出Montgomery形式
      */
-    static std::pair<BigInt, BigInt> div_mod_unsigned(const BigInt& dividend, const BigInt& divisor) {
-        BigInt quotient, remainder;
-        quotient.digits_.clear();
-        remainder.digits_.clear();
-        remainder.is_negative_ = false;
-        quotient.is_negative_ = false;
-
-        // 从被除数最高位（digits_末尾）开始逐位构建余数
-        for (auto it = dividend.digits_.rbegin(); it != dividend.digits_.rend(); ++it) {
-            // 余数 = 余数 * 10 + 当前位（模拟手工除法）
-            remainder = remainder * BigInt(10) + BigInt(static_cast<size_t>(*it));
-
-            // 修复核心：二分查找最大的q_digit（0-9），避免逐次累加的无限循环
-            uint8_t q_digit = 0;
-            uint8_t left = 0, right = 9; // 单个数字位，范围固定0-9
-            while (left <= right) {
-                uint8_t mid = (left + right) / 2;
-                BigInt temp = divisor * BigInt(static_cast<size_t>(mid));
-                if (temp <= remainder) {
-                    q_digit = mid;
-                    left = mid + 1;
-                } else {
-                    right = mid - 1;
+    static void ntt(std::vector<uint32_t>& a, const NttPrime& p, const bool invert) {
+        const size_t n = a.size();
+        std::vector<uint32_t> roots(n / 2);
+        const auto fill_roots = [&](const size_t len) {
+            uint32_t w = p.pow(p.to_mont(p.root), (p.mod - 1) / len);
+            if (invert) w = p.pow(w, p.mod - 2);
+            roots[0] = p.to_mont(1);
+            for (size_t i = 1; i < len / 2; ++i) roots[i] = p.mul(roots[i - 1], w);
+        };
+
+        if (!invert) {
+            for (size_t len = n; len >= 2; len >>= 1) {
+                const size_t half = len / 2;
+                fill_roots(len);
+                for (size_t i = 0; i < n; i += len) {
+                    for (size_t j = 0; j < half; ++j) {
+                        const uint32_t u = a[i + j], v = a[i + j + half];
+                        a[i + j] = p.add(u, v);
+                        a[i + j + half] = p.mul(p.sub(u, v), roots[j]);
+                    }
                 }
             }
+            return;
+        }
 
-            // 商的当前位存入（注意商是正序构建，后续需逆序）
-            quotient.digits_.push_back(q_digit);
-            // 更新余数：remainder = remainder - (q_digit * divisor)
-            if (q_digit > 0) {
-                remainder -= (divisor * BigInt(static_cast<size_t>(q_digit)));
+        for (size_t len = 2; len <= n; len <<= 1) {
+            const size_t half = len / 2;
+            fill_roots(len);
+            for (size_t i = 0; i < n; i += len) {
+                for (size_t j = 0; j < half; ++j) {
+                    const uint32_t u = a[i + j];
+                    const uint32_t v = p.mul(a[i + j + half], roots[j]);
+                    a[i + j] = p.add(u, v);
+                    a[i + j + half] = p.sub(u, v);
+                }
             }
         }
+        // Montgomery乘以普通形式的n^-1, 结果恰为普通形式
+        const uint32_t n_inv = p.from_mont(p.pow(p.to_mont(static_cast<uint32_t>(n % p.mod)), p.mod - 2));
+        for (auto& x : a) x = p.mul(x, n_inv);
+    }
 
-        // 商是正序存储（高位在前），需逆转为统一的低位在前格式
-        std::reverse(quotient.digits_.begin(), quotient.digits_.end());
-        quotient.trim_leading_zeros();
-        remainder.trim_leading_zeros();
+    /**
+     * @brief NTT乘法, r[0, an + bn)
+     * 在三个素数下分别做循环卷积, 再用Garner算法(中国剩余定理)逐系数还原并进位.
+     * 要求an + bn <= ntt_max_length且min(an, bn) <= ntt_max_operand
+     */
+    static void mul_ntt(limb_t* r, const limb_t* a, const size_t an, const limb_t* b, const size_t bn) {
+        const size_t n = std::bit_ceil(an + bn);
+        const bool square = a == b && an == bn;
+        std::vector<uint32_t> residues[3];
+        std::vector<uint32_t> fb;
+        for (int k = 0; k < 3; ++k) {
+            const NttPrime& p = ntt_prime(k);
+            std::vector<uint32_t> fa(n, 0);
+            for (size_t i = 0; i < an; ++i) fa[i] = p.to_mont(a[i]);
+            ntt(fa, p, false);
+            if (square) {
+                for (size_t i = 0; i < n; ++i) fa[i] = p.mul(fa[i], fa[i]);
+            } else {
+                fb.assign(n, 0);
+                for (size_t i = 0; i < bn; ++i) fb[i] = p.to_mont(b[i]);
+                ntt(fb, p, false);
+                for (size_t i = 0; i < n; ++i) fa[i] = p.mul(fa[i], fb[i]);
+            }
+            ntt(fa, p, true);
+            residues[k] = std::move(fa);
+        }
 
-        return {quotient, remainder};
+        // Garner: c = x0 + p0 * y1 + p0 * p1 * y2, 其中y1 < p1, y2 < p2
+        // 常数取Montgomery形式, 与普通形式的余数相乘得到普通形式, 省去逐系数的形式转换
+        const NttPrime& p0 = ntt_prime(0);
+        const NttPrime& p1 = ntt_prime(1);
+        const NttPrime& p2 = ntt_prime(2);
+        const uint32_t one1 = p1.to_mont(1), one2 = p2.to_mont(1);
+        const uint32_t p0_inv_mod_p1 = p1.pow(p1.to_mont(p0.mod), p1.mod - 2);
+        const uint32_t p0_mod_p2 = p2.to_mont(p0.mod);
+        const uint32_t p0p1_inv_mod_p2 = p2.pow(p2.mul(p0_mod_p2, p2.to_mont(p1.mod)), p2.mod - 2);
+        const uint64_t p0p1 = static_cast<uint64_t>(p0.mod) * p1.mod;
+        const uint64_t p0p1_lo = p0p1 & 0xFFFFFFFFu, p0p1_hi = p0p1 >> 32;
+
+        // 进位累加器按2^32进制分三段, 每段用64位保存以容纳未传播的进位
+        uint64_t acc0 = 0, acc1 = 0, acc2 = 0;
+        for (size_t i = 0; i < an + bn; ++i) {
+            const uint32_t x0 = residues[0][i], x1 = residues[1][i], x2 = residues[2][i];
+            // mul(x, 1的Montgomery形式)即x mod p
+            const uint32_t y1 = p1.mul(p1.sub(x1, p1.mul(x0, one1)), p0_inv_mod_p1);
+            const uint32_t t = p2.sub(p2.sub(x2, p2.mul(x0, one2)), p2.mul(p0_mod_p2, y1));
+            const uint32_t y2 = p2.mul(t, p0p1_inv_mod_p2);
+
+            const uint64_t term1 = static_cast<uint64_t>(p0.mod) * y1;
+            const uint64_t term2_lo = p0p1_lo * y2;
+            const uint64_t term2_hi = p0p1_hi * y2;
+            acc0 += static_cast<uint64_t>(x0) + (term1 & 0xFFFFFFFFu) + (term2_lo & 0xFFFFFFFFu);
+            acc1 += (term1 >> 32) + (term2_lo >> 32) + (term2_hi & 0xFFFFFFFFu);
+            acc2 += term2_hi >> 32;
+
+            r[i] = static_cast<limb_t>(acc0);
+            acc0 = acc1 + (acc0 >> 32);
+            acc1 = acc2;
+            acc2 = 0;
+        }
+        assert(acc0 == 0 && acc1 == 0);
+    }
+
+    ///| 乘法入口, r[0, an + bn), r不能与a或b重合
+    static void mul_limbs(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        if (bn < karatsuba_threshold) {
+            mul_schoolbook(r, a, an, b, bn);
+            return;
+        }
+        if (bn >= ntt_threshold && an + bn <= ntt_max_length && bn <= ntt_max_operand) {
+            mul_ntt(r, a, an, b, bn);
+            return;
+        }
+        if (an >= 2 * bn) {
+            // 长度悬殊时把a按bn切块, 每块与b做平衡乘法后累加
+            std::fill_n(r, an + bn, 0);
+            std::vector<limb_t> tmp(2 * bn);
+            for (size_t i = 0; i < an; i += bn) {
+                const size_t chunk = std::min(bn, an - i);
+                mul_limbs(tmp.data(), a + i, chunk, b, bn);
+                add_into(r + i, an + bn - i, tmp.data(), chunk + bn);
+            }
+            return;
+        }
+        if (bn < toom3_threshold) {
+            mul_karatsuba(r, a, an, b, bn);
+        } else {
+            mul_toom3(r, a, an, b, bn);
+        }
     }
 
     /**
-     * @brief Karatsuba乘法核心（无符号，仅处理正整数）
-     * 时间复杂度 O(n^log3) ≈ O(n^1.58)，远快于普通O(n²)逐位乘
-     * @note 修复：添加基准阈值，减少递归深度
+     * @brief Knuth算法D(长除法): q[0, m - n + 1) = u / v, rem[0, n) = u % v
+     * 要求m >= n >= 2且v无前导零limb; 先把除数左移使最高位为1, 这样每一位商的估计值最多偏大2
      */
-    static BigInt karatsuba_mul(const BigInt& a, const BigInt& b) {
-        // 修复核心：基准条件优化，长度≤8时用普通乘法，减少递归深度
-        const size_t BASE_THRESHOLD = 8;
-        if (a.digits_.size() <= BASE_THRESHOLD || b.digits_.size() <= BASE_THRESHOLD) {
-            BigInt res;
-            res.digits_.resize(a.digits_.size() + b.digits_.size(), 0);
-            // 逐位相乘，累加至对应位置
-            for (size_t i = 0; i < a.digits_.size(); ++i) {
-                uint32_t carry = 0; // 用32位存进位，避免溢出
-                for (size_t j = 0; j < b.digits_.size(); ++j) {
-                    uint32_t sum = res.digits_[i + j] + a.digits_[i] * b.digits_[j] + carry;
-                    res.digits_[i + j] = static_cast<uint8_t>(sum % 10);
-                    carry = sum / 10;
-                }
-                // 处理剩余进位（可能超过1位）
-                size_t carry_pos = i + b.digits_.size();
-                while (carry > 0) {
-                    if (carry_pos >= res.digits_.size()) {
-                        res.digits_.push_back(0);
-                    }
-                    uint32_t sum = res.digits_[carry_pos] + carry;
-                    res.digits_[carry_pos] = static_cast<uint8_t>(sum % 10);
-                    carry = sum / 10;
-                    carry_pos++;
+    static void divmod_knuth(limb_t* q, limb_t* rem, const limb_t* u, const size_t m, const limb_t* v, const size_t n) {
+        const int s = std::countl_zero(v[n - 1]);
+        std::vector<limb_t> vn(n), un(m + 1);
+        for (size_t i = n - 1; i > 0; --i) {
+            vn[i] = s ? (v[i] << s) | (v[i - 1] >> (limb_bits - s)) : v[i];
+        }
+        vn[0] = v[0] << s;
+        un[m] = s ? u[m - 1] >> (limb_bits - s) : 0;
+        for (size_t i = m - 1; i > 0; --i) {
+            un[i] = s ? (u[i] << s) | (u[i - 1] >> (limb_bits - s)) : u[i];
+        }
+        un[0] = u[0] << s;
+
+        constexpr dlimb_t base = static_cast<dlimb_t>(1) << limb_bits;
+        for (size_t j = m - n + 1; j-- > 0;) {
+            // 用被除数最高两个limb除以除数最高limb估计商, 再用次高limb修正
+            const dlimb_t num = (static_cast<dlimb_t>(un[j + n]) << limb_bits) | un[j + n - 1];
+            dlimb_t qhat = num / vn[n - 1];
+            dlimb_t rhat = num % vn[n - 1];
+            while (qhat >= base || qhat * vn[n - 2] > ((rhat << limb_bits) | un[j + n - 2])) {
+                --qhat;
+                rhat += vn[n - 1];
+                if (rhat >= base) break;
+            }
+
+            // un[j, j + n] -= qhat * vn
+            int64_t borrow = 0;
+            int64_t t;
+            for (size_t i = 0; i < n; ++i) {
+                const dlimb_t p = qhat * vn[i];
+                t = static_cast<int64_t>(un[i + j]) - borrow - static_cast<int64_t>(p & 0xFFFFFFFFu);
+                un[i + j] = static_cast<limb_t>(t);
+                borrow = static_cast<int64_t>(p >> limb_bits) - (t >> limb_bits);
+            }
+            t = static_cast<int64_t>(un[j + n]) - borrow;
+            un[j + n] = static_cast<limb_t>(t);
+
+            q[j] = static_cast<limb_t>(qhat);
+            if (t < 0) {
+                // 估计值偏大1, 加回一个除数
+                --q[j];
+                dlimb_t carry = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    carry += static_cast<dlimb_t>(un[i + j]) + vn[i];
+                    un[i + j] = static_cast<limb_t>(carry);
+                    carry >>= limb_bits;
                 }
+                un[j + n] += static_cast<limb_t>(carry);
             }
-            res.trim_leading_zeros();
-            return res;
         }
 
-        // m 取较小长度的一半（向上取整）
-        size_t min_len = std::min(a.digits_.size(), b.digits_.size());
-        size_t m = (min_len + 1) / 2; // 向上取整，比如 min_len=5 → m=3，min_len=4→m=2
-
-        BigInt a_low, a_high, b_low, b_high;
-
-        // 拆分 a：a_low = a % 10^m，a_high = a / 10^m（逆序存储，前m位是低位）
-        a_low.digits_ = std::vector<uint8_t>(a.digits_.begin(), a.digits_.begin() + std::min(m, a.digits_.size()));
-        if (a.digits_.size() > m) {
-            a_high.digits_ = std::vector<uint8_t>(a.digits_.begin() + m, a.digits_.end());
-        } else {
-            a_high.digits_ = {0}; // 不足高位补0
+        if (rem) {
+            for (size_t i = 0; i < n - 1; ++i) {
+                rem[i] = s ? (un[i] >> s) | (un[i + 1] << (limb_bits - s)) : un[i];
+            }
+            rem[n - 1] = un[n - 1] >> s;
         }
+    }
 
-        // 拆分 b（同 a）
-        b_low.digits_ = std::vector<uint8_t>(b.digits_.begin(), b.digits_.begin() + std::min(m, b.digits_.size()));
-        if (b.digits_.size() > m) {
-            b_high.digits_ = std::vector<uint8_t>(b.digits_.begin() + m, b.digits_.end());
+    /**
+     * @brief 绝对值的商和余数(教科书长除法), q/r可为nullptr表示不需要
+     * @note 除数不能为0, 由调用方检查
+     */
+    static void divmod_schoolbook(const BigInt& a, const BigInt& b, BigInt* q, BigInt* r) {
+        const uint32_t an = a.len(), bn = b.len();
+        assert(bn > 0);
+        if (cmp_limbs(a.data(), an, b.data(), bn) < 0) {
+            if (q) *q = BigInt();
+            if (r) *r = a.abs();
+            return;
+        }
+        if (an <= 2) {
+            const uint64_t x = a.low_u64(), y = b.low_u64();
+            if (q) q->set_u64(x / y, false);
+            if (r) r->set_u64(x % y, false);
+            return;
+        }
+        BigInt quot;
+        quot.reserve(an - bn + 1, false);
+        if (bn == 1) {
+            const limb_t rem = divmod_small(quot.data(), a.data(), an, b.data()[0]);
+            quot.set_trimmed(an, false);
+            if (r) r->set_u64(rem, false);
         } else {
-            b_high.digits_ = {0};
+            BigInt rem;
+            rem.reserve(bn, false);
+            divmod_knuth(quot.data(), r ? rem.data() : nullptr, a.data(), an, b.data(), bn);
+            quot.set_trimmed(an - bn + 1, false);
+            if (r) {
+                rem.set_trimmed(bn, false);
+                *r = std::move(rem);
+            }
         }
+        if (q) *q = std::move(quot);
+    }
 
-        // Karatsuba公式：z0*10^(2m) + (z1 - z0 - z2)*10^m + z2
-        BigInt z0 = karatsuba_mul(a_low, b_low);
-        BigInt z1 = karatsuba_mul(a_low + a_high, b_low + b_high);
-        BigInt z2 = karatsuba_mul(a_high, b_high);
+    // ========================= 按limb/位移位(均为非负数) =========================
+    ///| x * B^k
+    static BigInt shl_limbs(const BigInt& x, const size_t k) {
+        const uint32_t n = x.len();
+        BigInt res;
+        if (n == 0) return res;
+        res.reserve(static_cast<uint32_t>(n + k), false);
+        std::fill_n(res.data(), k, 0);
+        std::copy_n(x.data(), n, res.data() + k);
+        res.set_trimmed(static_cast<uint32_t>(n + k), false);
+        return res;
+    }
 
-        // 按标准顺序计算（加法交换律下结果一致，但更易读）
-        BigInt res = z2.shift_left(2 * m) + (z1 - z0 - z2).shift_left(m) + z0;
-        res.trim_leading_zeros();
+    ///| x / B^k
+    static BigInt shr_limbs(const BigInt& x, const size_t k) {
+        const uint32_t n = x.len();
+        if (n <= k) return {};
+        return from_limbs(x.data() + k, n - k);
+    }
+
+    ///| x mod B^k
+    static BigInt low_limbs(const BigInt& x, const size_t k) {
+        return from_limbs(x.data(), std::min<size_t>(k, x.len()));
+    }
+
+    ///| x * 2^s, 0 <= s < 32
+    static BigInt shl_bits(const BigInt& x, const int s) {
+        const uint32_t n = x.len();
+        BigInt res;
+        res.reserve(n + 1, false);
+        const limb_t* src = x.data();
+        limb_t* dst = res.data();
+        limb_t carry = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            dst[i] = (src[i] << s) | carry;
+            carry = s ? src[i] >> (limb_bits - s) : 0;
+        }
+        dst[n] = carry;
+        res.set_trimmed(n + 1, false);
         return res;
     }
 
-    /**
-     * @brief 左移（乘以 10^k，逆序存储中为开头补k个0）
-     * @note 修复：优化内存操作，避免 vector 开头 insert 的低效行为
-     */
-    [[nodiscard]] BigInt shift_left(size_t k) const {
-        if (k == 0 || (digits_.size() == 1 && digits_[0] == 0)) {
-            return *this;
+    ///| x / 2^s, 0 <= s < 32
+    static BigInt shr_bits(const BigInt& x, const int s) {
+        const uint32_t n = x.len();
+        BigInt res;
+        res.reserve(n, false);
+        const limb_t* src = x.data();
+        limb_t* dst = res.data();
+        for (uint32_t i = 0; i < n; ++i) {
+            dst[i] = src[i] >> s;
+            if (s && i + 1 < n) dst[i] |= src[i + 1] << (limb_bits - s);
         }
-        BigInt res = *this;
-        // 修复核心：先resize预分配，再后移元素，最后填充0，避免开头insert
-        size_t old_size = res.digits_.size();
-        res.digits_.resize(old_size + k, 0); // 扩展内存
-        // 原有元素后移k位
-        for (size_t i = old_size + k - 1; i >= k; --i) {
-            res.digits_[i] = res.digits_[i - k];
-        }
-        // 前k位置0
-        std::fill(res.digits_.begin(), res.digits_.begin() + k, 0);
-        res.trim_leading_zeros(); // 补0后清理前导零
+        res.set_trimmed(n, false);
         return res;
     }
 
+    // ========================= Burnikel-Ziegler递归除法 =========================
     /**
-     * @brief 无符号减法：计算 |a| - |b|，要求 |a| >= |b|
+     * @brief 2n/n除法: 要求a < b * B^n, b恰有n个limb且最高位为1
+     * 把a, b各拆成两半, 化为两次3n/2n除法, 每次递归调用n/2规模的2n/n除法,
+     * 乘法部分走快速乘法, 总代价为O(M(n) log n)
      */
-    static BigInt unsigned_subtract(const BigInt& a, const BigInt& b) {
-        assert(!a.abs_less(b) && "unsigned_subtract requires |a| >= |b|");
+    static void div2n1n(const BigInt& a, const BigInt& b, const size_t n, BigInt& q, BigInt& r) {
+        if (n < bz_threshold) {
+            divmod_schoolbook(a, b, &q, &r);
+            return;
+        }
+        if (n & 1) {
+            // 奇数长度时a, b同乘B, 使两半等长
+            div2n1n(shl_limbs(a, 1), shl_limbs(b, 1), n + 1, q, r);
+            r = shr_limbs(r, 1);
+            return;
+        }
+        const size_t half = n / 2;
+        const BigInt b1 = shr_limbs(b, half), b2 = low_limbs(b, half);
+        BigInt q1, q2, r1;
+        div3n2n(shr_limbs(a, n), low_limbs(shr_limbs(a, half), half), b, b1, b2, half, q1, r1);
+        div3n2n(r1, low_limbs(a, half), b, b1, b2, half, q2, r);
+        q = shl_limbs(q1, half) + q2;
+    }
 
-        BigInt result;
-        result.digits_.clear();
-        result.is_negative_ = false;
+    ///| 3n/2n除法: 被除数为a12 * B^n + a3, 除数b = b1 * B^n + b2; 先用b1估计商, 再修正至多两次
+    static void div3n2n(const BigInt& a12, const BigInt& a3, const BigInt& b, const BigInt& b1,
+                        const BigInt& b2, const size_t n, BigInt& q, BigInt& r) {
+        if (shr_limbs(a12, n) == b1) {
+            q = shl_limbs(BigInt(1), n) - BigInt(1);
+            r = a12 - shl_limbs(b1, n) + b1;
+        } else {
+            div2n1n(a12, b1, n, q, r);
+        }
+        r = shl_limbs(r, n) + a3 - q * b2;
+        while (r.is_negative()) {
+            q -= BigInt(1);
+            r += b;
+        }
+    }
 
-        uint32_t borrow = 0;
-        for (size_t i = 0; i < a.digits_.size(); ++i) {
-            uint32_t a_digit = a.digits_[i];
-            uint32_t b_digit = (i < b.digits_.size()) ? b.digits_[i] : 0;
+    ///| 把a按除数长度n分块, 从高到低逐块做2n/n除法
+    static void divmod_bz(const BigInt& a, const BigInt& b, BigInt* q, BigInt* r) {
+        const int s = std::countl_zero(b.data()[b.len() - 1]);
+        const BigInt nb = shl_bits(b, s);
+        const BigInt na = shl_bits(a, s);
+        const size_t n = nb.len();
+        const size_t chunks = (na.len() + n - 1) / n;
+
+        BigInt quot;
+        quot.reserve(static_cast<uint32_t>(chunks * n), false);
+        std::fill_n(quot.data(), chunks * n, 0);
+        BigInt rem;
+        for (size_t i = chunks; i-- > 0;) {
+            const BigInt chunk = from_limbs(na.data() + i * n, std::min<size_t>(n, na.len() - i * n));
+            BigInt digit;
+            div2n1n(shl_limbs(rem, n) + chunk, nb, n, digit, rem);
+            std::copy_n(digit.data(), digit.len(), quot.data() + i * n);
+        }
+        quot.set_trimmed(static_cast<uint32_t>(chunks * n), false);
+        if (q) *q = std::move(quot);
+        if (r) *r = shr_bits(rem, s);
+    }
 
-            int32_t diff = static_cast<int32_t>(a_digit) - static_cast<int32_t>(b_digit) - borrow;
+    ///| 绝对值的商和余数, 除数和商都较长时使用递归除法
+    static void divmod_abs(const BigInt& a, const BigInt& b, BigInt* q, BigInt* r) {
+        const uint32_t an = a.len(), bn = b.len();
+        if (bn >= bz_threshold && an >= bn + bz_threshold) {
+            divmod_bz(a, b, q, r);
+        } else {
+            divmod_schoolbook(a, b, q, r);
+        }
+    }
 
-            if (diff < 0) {
-                diff += 10;
-                borrow = 1;
-            } else {
-                borrow = 0;
+    ///| 同号相加/异号相减的公共实现, b_negative为参与运算时b的符号
+    static BigInt add_signed(const BigInt& a, const BigInt& b, const bool b_negative) {
+        const bool a_negative = a.size_ < 0;
+        const uint32_t an = a.len(), bn = b.len();
+        BigInt res;
+        if (an <= 2 && bn <= 2) {
+            const uint64_t x = a.low_u64(), y = b.low_u64();
+            if (a_negative != b_negative) {
+                if (x >= y) res.set_u64(x - y, a_negative);
+                else res.set_u64(y - x, b_negative);
+                return res;
+            }
+            if (x + y >= x) {
+                res.set_u64(x + y, a_negative);
+                return res;
             }
+            // 64位溢出, 走通用路径
+        }
 
-            result.digits_.push_back(static_cast<uint8_t>(diff));
+        if (a_negative == b_negative) {
+            const bool a_longer = an >= bn;
+            const limb_t* lp = a_longer ? a.data() : b.data();
+            const limb_t* sp = a_longer ? b.data() : a.data();
+            const uint32_t ln = a_longer ? an : bn, sn = a_longer ? bn : an;
+            res.reserve(ln + 1, false);
+            res.data()[ln] = add_limbs(res.data(), lp, ln, sp, sn);
+            res.set_trimmed(ln + 1, a_negative);
+            return res;
         }
 
-        // 移除前导零
-        while (result.digits_.size() > 1 && result.digits_.back() == 0) {
-            result.digits_.pop_back();
+        const int cmp = cmp_limbs(a.data(), an, b.data(), bn);
+        if (cmp == 0) return res;
+        if (cmp > 0) {
+            res.reserve(an, false);
+            sub_limbs(res.data(), a.data(), an, b.data(), bn);
+            res.set_trimmed(an, a_negative);
+        } else {
+            res.reserve(bn, false);
+            sub_limbs(res.data(), b.data(), bn, a.data(), an);
+            res.set_trimmed(bn, b_negative);
         }
+        return res;
+    }
 
-        return result;
+    // ========================= 十进制转换 =========================
+    static constexpr limb_t decimal_chunk = 1000000000;  // 10^9, 一个limb可容纳的最大10的幂
+    static constexpr size_t decimal_chunk_digits = 9;
+
+    ///| 10^(9 * 2^k), k = 0, 1, ..., count - 1
+    static std::vector<BigInt> decimal_powers(const size_t count) {
+        std::vector<BigInt> pows{BigInt(decimal_chunk)};
+        while (pows.size() < count) pows.push_back(pows.back() * pows.back());
+        return pows;
+    }
+
+    ///| 逐块解析n位十进制数字串(已校验): x = x * 10^9 + chunk, O(n^2)
+    static BigInt parse_basic(const char* s, const size_t n) {
+        BigInt res;
+        res.reserve(static_cast<uint32_t>(n / decimal_chunk_digits + 2), false);
+        uint32_t len = 0;
+        size_t pos = 0;
+        size_t chunk_len = n % decimal_chunk_digits == 0 ? decimal_chunk_digits : n % decimal_chunk_digits;
+        while (pos < n) {
+            limb_t chunk = 0, scale = 1;
+            for (size_t i = 0; i < chunk_len; ++i) {
+                chunk = chunk * 10 + static_cast<limb_t>(s[pos + i] - '0');
+                scale *= 10;
+            }
+            const limb_t carry = mul_small_add(res.data(), res.data(), len, scale, chunk);
+            if (carry) res.data()[len++] = carry;
+            pos += chunk_len;
+            chunk_len = decimal_chunk_digits;
+        }
+        res.set_trimmed(len, false);
+        return res;
+    }
+
+    ///| 分治解析: 低9 * 2^k位与高位分别解析, 再合并为 high * 10^(9 * 2^k) + low
+    static BigInt parse_dc(const char* s, const size_t n, const std::vector<BigInt>& pows) {
+        if (n <= radix_dc_threshold * decimal_chunk_digits) return parse_basic(s, n);
+        size_t k = 0;
+        while (decimal_chunk_digits << (k + 1) < n) ++k;
+        const size_t low_len = decimal_chunk_digits << k;
+        return parse_dc(s, n - low_len, pows) * pows[k] + parse_dc(s + n - low_len, low_len, pows);
+    }
+
+    ///| 反复除以10^9逐块输出绝对值, O(n^2); width非零时左侧补零到width位
+    static void append_basic(std::string& out, const BigInt& x, const size_t width) {
+        std::vector<limb_t> mag(x.data(), x.data() + x.len());
+        std::vector<limb_t> chunks;
+        chunks.reserve(mag.size() * 32 / 29 + 1);
+        size_t n = mag.size();
+        while (n > 0) {
+            chunks.push_back(divmod_small(mag.data(), mag.data(), n, decimal_chunk));
+            while (n > 0 && mag[n - 1] == 0) --n;
+        }
+
+        std::string digits;
+        if (!chunks.empty()) {
+            digits = std::to_string(chunks.back());
+            char buf[decimal_chunk_digits];
+            for (size_t i = chunks.size() - 1; i-- > 0;) {
+                limb_t c = chunks[i];
+                for (size_t d = decimal_chunk_digits; d-- > 0;) {
+                    buf[d] = static_cast<char>('0' + c % 10);
+                    c /= 10;
+                }
+                digits.append(buf, decimal_chunk_digits);
+            }
+        } else if (width == 0) {
+            digits = "0";
+        }
+        if (width > digits.size()) out.append(width - digits.size(), '0');
+        out += digits;
+    }
+
+    /**
+     * @brief 分治输出: 要求x < pows[k]^2, 除以pows[k]后高低两半分别递归
+     * pad为真时左侧补零到2 * 9 * 2^k位(作为更高位之后的低半部分)
+     */
+    static void append_dc(std::string& out, const BigInt& x, const size_t k, const std::vector<BigInt>& pows,
+                          const bool pad) {
+        const size_t width = pad ? decimal_chunk_digits << (k + 1) : 0;
+        if (k == 0 || x.len() <= radix_dc_threshold) {
+            append_basic(out, x, width);
+            return;
+        }
+        BigInt q, r;
+        divmod_abs(x, pows[k], &q, &r);
+        if (!pad && q.is_zero()) {
+            append_dc(out, r, k - 1, pows, false);
+            return;
+        }
+        append_dc(out, q, k - 1, pows, pad);
+        append_dc(out, r, k - 1, pows, true);
     }
 
     /**
@@ -239,115 +868,173 @@ public:
     static BigInt fast_pow_unsigned(const BigInt& base, const BigInt& exp) {
         BigInt result(1); // 初始结果为 1（乘法单位元）
         BigInt current_base = base;
-        BigInt current_exp = exp;
-        const BigInt two(2);
 
-        while (current_exp > BigInt(0)) {
-            // 若当前指数为奇数，结果 *= 当前底数
-            if (current_exp % two == BigInt(1)) {
-                result = result * current_base; // 复用 Karatsuba 乘法，高效
+        // 从低位到高位逐个扫描指数的二进制位
+        const limb_t* e = exp.data();
+        const uint32_t en = exp.len();
+        for (uint32_t i = 0; i < en; ++i) {
+            for (int bit = 0; bit < limb_bits; ++bit) {
+                if ((e[i] >> bit) & 1) {
+                    result = result * current_base;
+                }
+                // 最高位之后无需再平方
+                if (i == en - 1 && (e[i] >> bit) <= 1) break;
+                current_base = current_base * current_base;
             }
-            // 底数平方，指数减半（整除）
-            current_base = current_base * current_base;
-            current_exp = current_exp / two; // 整数除法，向下取整
         }
 
         return result;
     }
 
     // ========================= 构造与析构 =========================
-    BigInt() : is_negative_(false), digits_(1, 0) {}
-    BigInt(size_t val) : is_negative_(false) {
-        if (val == 0) { digits_.push_back(0); return; }
-        while (val > 0) { digits_.push_back(static_cast<uint8_t>(val % 10)); val /= 10; }
+    BigInt() : inline_{} {}
+    BigInt(size_t val) : inline_{} {
+        set_u64(val, false);
     }
-    BigInt(const std::string& s) : is_negative_(false) {
-        if (s.empty()) { digits_.push_back(0); return; }
+    BigInt(const std::string& s) : inline_{} {
+        if (s.empty()) return;
         size_t start_idx = 0;
-        if (s[0] == '-') { is_negative_ = true; start_idx = 1; }
-        for (auto it = s.rbegin(); it != s.rend() - start_idx; ++it) {
-            if (*it < '0' || *it > '9') { digits_ = {0}; is_negative_ = false; return; }
-            digits_.push_back(static_cast<uint8_t>(*it - '0'));
+        bool negative = false;
+        if (s[0] == '-') { negative = true; start_idx = 1; }
+        for (size_t i = start_idx; i < s.size(); ++i) {
+            if (s[i] < '0' || s[i] > '9') return;  // 非法字符串得到0
         }
-        trim_leading_zeros();
+
+        const char* digits = s.data() + start_idx;
+        const size_t digit_count = s.size() - start_idx;
+        if (digit_count <= radix_dc_threshold * decimal_chunk_digits) {
+            *this = parse_basic(digits, digit_count);
+        } else {
+            // parse_dc用到的最大k满足9 * 2^(k + 1) < digit_count
+            size_t k = 0;
+            while (decimal_chunk_digits << (k + 1) < digit_count) ++k;
+            *this = parse_dc(digits, digit_count, decimal_powers(k + 1));
+        }
+        set_trimmed(len(), negative);
+    }
+    BigInt(const BigInt& other) : inline_{} {
+        const uint32_t n = other.len();
+        reserve(n, false);
+        std::copy_n(other.data(), n, data());
+        size_ = other.size_;
+    }
+    BigInt(BigInt&& other) noexcept : size_(other.size_), capacity_(other.capacity_), inline_{} {
+        if (capacity_ == inline_limbs) {
+            inline_[0] = other.inline_[0];
+            inline_[1] = other.inline_[1];
+        } else {
+            heap_ = other.heap_;
+        }
+        other.size_ = 0;
+        other.capacity_ = inline_limbs;
     }
-    BigInt(BigInt&& other) noexcept : digits_(std::move(other.digits_)), is_negative_(other.is_negative_) {
-        other.digits_.clear(); other.is_negative_ = false;
+    BigInt& operator=(const BigInt& other) {
+        if (this == &other) return *this;
+        const uint32_t n = other.len();
+        reserve(n, false);
+        std::copy_n(other.data(), n, data());
+        size_ = other.size_;
+        return *this;
     }
     BigInt& operator=(BigInt&& other) noexcept {
-        if (this != &other) { digits_ = std::move(other.digits_); is_negative_ = other.is_negative_; other.digits_.clear(); other.is_negative_ = false; }
+        if (this == &other) return *this;
+        if (capacity_ != inline_limbs) delete[] heap_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        if (capacity_ == inline_limbs) {
+            inline_[0] = other.inline_[0];
+            inline_[1] = other.inline_[1];
+        } else {
+            heap_ = other.heap_;
+        }
+        other.size_ = 0;
+        other.capacity_ = inline_limbs;
         return *this;
     }
-
-    BigInt(const BigInt& other) = default;
-    BigInt& operator=(const BigInt& other) = default;
-    ~BigInt() = default;
+    ~BigInt() {
+        if (capacity_ != inline_limbs) delete[] heap_;
+    }
 
     [[nodiscard]] bool is_negative() const {
-        return is_negative_;
+        return size_ < 0;
+    }
+
+    // ========================= 机器字整数互转 =========================
+    static BigInt from_int64(const int64_t val) {
+        BigInt res;
+        // 先转为无符号绝对值, 避免对INT64_MIN取负溢出
+        const uint64_t mag = val < 0 ? 0 - static_cast<uint64_t>(val) : static_cast<uint64_t>(val);
+        res.set_u64(mag, val < 0);
+        return res;
+    }
+
+    /**
+     * @brief 尝试转换为 int64_t
+     * @return 超出 int64_t 范围时返回 false, out 不变
+     */
+    bool try_to_int64(int64_t& out) const {
+        if (len() > 2) return false;
+        const uint64_t mag = low_u64();
+        if (is_negative()) {
+            if (mag > static_cast<uint64_t>(INT64_MAX) + 1) return false;
+            out = static_cast<int64_t>(0 - mag);
+        } else {
+            if (mag > static_cast<uint64_t>(INT64_MAX)) return false;
+            out = static_cast<int64_t>(mag);
+        }
+        return true;
+    }
+
+    /**
+     * @brief 转换为最接近的double(就近舍入, 超出范围时为±inf)
+     * 取最高64个有效位, 更低位非零时置最低位为粘滞位, 使硬件的一次舍入结果正确
+     */
+    [[nodiscard]] double to_double() const {
+        const uint32_t n = len();
+        if (n <= 2) {
+            const auto d = static_cast<double>(low_u64());
+            return is_negative() ? -d : d;
+        }
+        const limb_t* p = data();
+        const int lead = std::countl_zero(p[n - 1]);
+        const uint64_t top = static_cast<uint64_t>(p[n - 1]) << 32 | p[n - 2];
+        const uint64_t next = p[n - 3];
+        uint64_t bits = top;
+        uint64_t lost = next;
+        if (lead > 0) {
+            bits = top << lead | next >> (limb_bits - lead);
+            lost = next & ((static_cast<uint64_t>(1) << (limb_bits - lead)) - 1);
+        }
+        for (uint32_t i = 0; i + 3 < n && lost == 0; ++i) lost = p[i];
+        const double d = std::ldexp(static_cast<double>(bits | (lost != 0)),
+                                    static_cast<int>(limb_bits * (n - 2)) - lead);
+        return is_negative() ? -d : d;
     }
 
     // ========================= 绝对值 =========================
     [[nodiscard]] BigInt abs() const {
         BigInt res = *this;
-        res.is_negative_ = false;
+        res.size_ = static_cast<int32_t>(len());
         return res;
     }
 
     // ========================= 比较运算符 =========================
     bool operator==(const BigInt& other) const {
-        if (is_negative_ != other.is_negative_ || digits_.size() != other.digits_.size()) return false;
-        return digits_ == other.digits_;
+        return size_ == other.size_ && std::equal(data(), data() + len(), other.data());
     }
     bool operator!=(const BigInt& other) const { return !(*this == other); }
     bool operator<(const BigInt& other) const {
-        if (is_negative_ != other.is_negative_) return is_negative_;
-        if (digits_.size() != other.digits_.size()) return is_negative_ ? (digits_.size() > other.digits_.size()) : (digits_.size() < other.digits_.size());
-        for (auto it1 = digits_.rbegin(), it2 = other.digits_.rbegin(); it1 != digits_.rend(); ++it1, ++it2) {
-            if (*it1 != *it2) return is_negative_ ? (*it1 > *it2) : (*it1 < *it2);
-        }
-        return false;
+        if (size_ != other.size_) return size_ < other.size_;
+        const int cmp = cmp_limbs(data(), len(), other.data(), other.len());
+        return is_negative() ? cmp > 0 : cmp < 0;
     }
     bool operator>(const BigInt& other) const { return other < *this; }
-    bool operator<=(const BigInt& other) const { return *this < other || *this == other; }
-    bool operator>=(const BigInt& other) const { return *this > other || *this == other; }
+    bool operator<=(const BigInt& other) const { return !(other < *this); }
+    bool operator>=(const BigInt& other) const { return !(*this < other); }
 
-    // ========================= 核心运算：加法 =========================
+    // ========================= 核心运算：加减法 =========================
     BigInt operator+(const BigInt& other) const {
-        BigInt res;
-        res.digits_.clear(); // 清空默认的[0]
-
-        // 情况1：同号（都正或都负）→ 绝对值相加，符号不变
-        if (is_negative_ == other.is_negative_) {
-            res.is_negative_ = is_negative_;
-            uint32_t carry = 0; // 进位（用32位避免溢出）
-            size_t max_len = std::max(digits_.size(), other.digits_.size());
-
-            for (size_t i = 0; i < max_len || carry > 0; ++i) {
-                // 取当前位（不足补0）
-                uint32_t a = (i < digits_.size()) ? digits_[i] : 0;
-                uint32_t b = (i < other.digits_.size()) ? other.digits_[i] : 0;
-                uint32_t sum = a + b + carry;
-
-                res.digits_.push_back(static_cast<uint8_t>(sum % 10));
-                carry = sum / 10;
-            }
-        }
-        // 情况2：异号（一正一负）→ 绝对值相减，符号取绝对值大的
-        else {
-            if (abs_less(other)) {
-                // this绝对值 < other绝对值
-                res = unsigned_subtract(other, *this);
-                res.is_negative_ = other.is_negative_;
-            } else {
-                // this绝对值 >= other绝对值
-                res = unsigned_subtract(*this, other);
-                res.is_negative_ = is_negative_;
-            }
-        }
-
-        res.trim_leading_zeros();
-        return res;
+        return add_signed(*this, other, other.is_negative());
     }
 
     BigInt& operator+=(const BigInt& other) {
@@ -355,19 +1042,11 @@ public:
         return *this;
     }
 
-    // ========================= 核心运算：减法 =========================
     BigInt operator-(const BigInt& other) const {
-        // 特殊情况：减自己 → 0（保留，提升效率）
-        if (*this == other) {
-            return {0};
-        }
-        // 数学本质：a - b = a + (-b) （核心修复，复用加法的正确逻辑）
-        BigInt other_neg = other;       // 复制被减数
-        other_neg.is_negative_ = !other_neg.is_negative_; // 取反被减数的符号（得到相反数）
-        return *this + other_neg;       // 调用正确的加法运算符，完成所有计算
+        // a - b = a + (-b)
+        return add_signed(*this, other, !other.is_negative() && !other.is_zero());
     }
 
-
     BigInt& operator-=(const BigInt& other) {
         *this = *this - other;
         return *this;
@@ -375,15 +1054,18 @@ public:
 
     // ========================= 核心运算：乘法 =========================
     BigInt operator*(const BigInt& other) const {
-        if ((digits_.size() == 1 && digits_[0] == 0) || (other.digits_.size() == 1 && other.digits_[0] == 0)) {
-            return {0};
-        }
+        BigInt res;
+        if (is_zero() || other.is_zero()) return res;
 
-        // 先计算无符号乘法
-        BigInt res = karatsuba_mul(this->abs(), other.abs());
-        // 再设置符号（异或运算：同号得正，异号得负）
-        res.is_negative_ = is_negative_ ^ other.is_negative_;
-        res.trim_leading_zeros();
+        const bool negative = is_negative() != other.is_negative();
+        const uint32_t an = len(), bn = other.len();
+        if (an == 1 && bn == 1) {
+            res.set_u64(static_cast<uint64_t>(data()[0]) * other.data()[0], negative);
+            return res;
+        }
+        res.reserve(an + bn, false);
+        mul_limbs(res.data(), data(), an, other.data(), bn);
+        res.set_trimmed(an + bn, negative);
         return res;
     }
 
@@ -395,27 +1077,16 @@ public:
     // ========================= 核心运算：取模 =========================
     BigInt operator%(const BigInt& other) const {
         // 断言：除数不能为0
-        if(other.digits_.size() == 1 && other.digits_[0] == 0)
+        if (other.is_zero())
             throw NativeFuncError("CalculateError", "BigInt mod: divisor cannot be zero");
 
-        // 特殊情况：被除数为0→结果为0
-        if (digits_.size() == 1 && digits_[0] == 0) {
-            return BigInt(0);
-        }
-
-        // 计算被除数、除数的绝对值
-        BigInt a_abs = this->abs();
-        BigInt b_abs = other.abs();
+        BigInt remainder;
+        divmod_abs(*this, other, nullptr, &remainder);
 
-        // 无符号取模（得到非负余数）
-        BigInt remainder = div_mod_unsigned(a_abs, b_abs).second;
-
-        // 调整余数符号（与被除数一致）
-        if (this->is_negative_ && remainder != BigInt(0)) {
-            remainder = remainder - b_abs; // 非零负余数：remainder = - (b_abs - remainder)
+        // 调整余数符号：被除数为负且余数非零时 remainder = - (b_abs - remainder)
+        if (this->is_negative() && !remainder.is_zero()) {
+            remainder = remainder - other.abs();
         }
-
-        remainder.trim_leading_zeros();
         return remainder;
     }
 
@@ -427,22 +1098,13 @@ public:
     // ========================= 核心运算：除法 =========================
     BigInt operator/(const BigInt& other) const {
         // 断言：除数不能为0
-        if(other.digits_.size() == 1 && other.digits_[0] == 0)
+        if (other.is_zero())
             throw NativeFuncError("CalculateError", "divisor cannot be zero");
 
-        // 特殊情况：被除数为0→结果为0
-        if (digits_.size() == 1 && digits_[0] == 0) {
-            return {0};
-        }
-
-        // 符号：同号为正，异号为负（异或运算）
-        const bool res_neg = is_negative_ ^ other.is_negative_;
-
-        // 无符号除法取商
-        BigInt quotient = div_mod_unsigned(this->abs(), other.abs()).first;
-        quotient.is_negative_ = res_neg;
-        quotient.trim_leading_zeros();
-
+        // 向零取整, 符号：同号为正，异号为负
+        BigInt quotient;
+        divmod_abs(*this, other, &quotient, nullptr);
+        quotient.set_trimmed(quotient.len(), is_negative() != other.is_negative());
         return quotient;
     }
 
@@ -454,78 +1116,62 @@ public:
     // ========================= 核心运算：幂运算 =========================
     BigInt pow(const BigInt& other) const {
         // 指数必须为非负整数
-        if(other.is_negative_)
+        if (other.is_negative())
             throw NativeFuncError("CalculateError", "use negative int into Bigint.pow is unsupported");
 
-        const BigInt& exp = other;
-        const BigInt zero(0);
-        const BigInt one(1);
-
         // 边界情况：指数为 0 → 结果为 1
-        if (exp == zero) {
-            return one;
+        if (other.is_zero()) {
+            return {1};
         }
 
         // 边界情况：底数为 0 → 结果为 0（指数为正）
-        if (*this == zero) {
-            return zero;
+        if (is_zero()) {
+            return {};
         }
 
-        // 提取底数的绝对值（后续统一计算正数幂，最后处理符号）
-        BigInt base_abs = this->abs();
-        // 快速幂计算（处理正整数幂）
-        BigInt result_abs = fast_pow_unsigned(base_abs, exp);
-        // 确定结果符号（仅当底数为负且指数为奇数时，结果为负）
-        bool is_result_neg = this->is_negative_ && (exp % BigInt(2) == one);
-        result_abs.is_negative_ = is_result_neg;
-
-        result_abs.trim_leading_zeros();
-        return result_abs;
+        // 快速幂计算绝对值; 仅当底数为负且指数为奇数时，结果为负
+        BigInt result = fast_pow_unsigned(this->abs(), other);
+        const bool odd_exp = (other.data()[0] & 1) != 0;
+        result.set_trimmed(result.len(), is_negative() && odd_exp);
+        return result;
     }
 
     // ========================= 字符串/数值转换 =========================
     [[nodiscard]] std::string to_string() const {
-        std::string result;
-
-        // 边界处理：若 digits_ 为空（未初始化/零值），直接返回 "0"
-        if (digits_.empty()) {
+        if (is_zero()) {
             return "0";
         }
 
-        // 处理负数符号
-        if (is_negative_) {
+        std::string result;
+        if (is_negative()) {
             result += '-';
         }
-
-        // 逆序遍历
-        for (auto it = digits_.rbegin(); it != digits_.rend(); ++it) {
-            // *it 是 0-9 的数字，+'0' 转换为对应的 ASCII 字符（如 3 → '3'）
-            result += static_cast<char>('0' + *it);
+        const BigInt mag = abs();
+        if (len() <= radix_dc_threshold) {
+            append_basic(result, mag, 0);
+            return result;
         }
 
+        // 平方至少有len() + 1个limb时, pows.back()^2 > mag
+        std::vector<BigInt> pows{BigInt(decimal_chunk)};
+        while (pows.back().len() * 2 - 1 <= len()) pows.push_back(pows.back() * pows.back());
+        result.reserve(static_cast<size_t>(len()) * 10 + 2);
+        append_dc(result, mag, pows.size() - 1, pows, false);
         return result;
     }
 
     [[nodiscard]] unsigned long long to_unsigned_long_long() const {
         // 检查是否为负数
-        if (is_negative_) {
+        if (is_negative()) {
             throw NativeFuncError("CalculateError","BigInt is negative, cannot convert to unsigned long long");
         }
 
         // 检查是否超出范围
-        const BigInt ull_max_big(ULLONG_MAX);
-        if (*this > ull_max_big) {
+        if (len() > 2) {
             throw NativeFuncError("CalculateError","BigInt value exceeds ULLONG_MAX");
         }
 
-        unsigned long long result = 0;
-        // 修复核心：逆序遍历 digits_（从高位到低位）
-        for (auto it = digits_.rbegin(); it != digits_.rend(); ++it) {
-            unsigned char digit = *it;
-            result = result * 10 + digit;
-        }
-
-        return result;
+        return low_u64();
     }
 
     // ========================= 友元：输出运算符 =========================
@@ -535,4 +1181,4 @@ public:
     }
 };
 
-} // namespace dep
\ No newline at end of file
+} // namespace dep
@@ -0,0 +1,93 @@
+/**
+ * @file cow.hpp
+ * @brief 辅助容器（Cow）: 写时复制的共享存储
+ *
+ * 多个Cow共享同一份T, 复制Cow只增加共享计数; 第一次通过mut()修改时,
+ * 若存储仍被共享, 先复制出独占的一份. 元素的引用计数等语义由调用方维护:
+ * mut()复制后调用on_copy钩子让调用方为新的一份补充引用, 析构只释放存储本身.
+ * 空的Cow指向一份常驻的空存储, 直到第一次mut()才分配; 存储的内存由Alloc提供
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace dep {
+
+///| 默认的存储分配器: 全局operator new/delete
+struct CowHeapAlloc {
+    static void* allocate(const size_t size) { return ::operator new(size); }
+    static void deallocate(void* p, const size_t) { ::operator delete(p); }
+};
+
+template <typename T, typename Alloc = CowHeapAlloc>
+class Cow {
+    struct Rep {
+        T value;
+        size_t owners;
+        int8_t hint;  // 调用方缓存的由value导出的信息, -1表示未知; 每次mut()后重置
+    };
+
+    Rep* rep_;
+
+    ///| 所有空Cow共用的存储: 不计共享者, 不会被修改或释放(常驻内存)
+    static Rep* empty_rep() {
+        static Rep* const empty = new Rep{T(), 1, -1};
+        return empty;
+    }
+
+    static Rep* new_rep(const T& value) {
+        return new (Alloc::allocate(sizeof(Rep))) Rep{value, 1, -1};
+    }
+
+    void release() {
+        if (rep_ != empty_rep() and --rep_->owners == 0) {
+            rep_->~Rep();
+            Alloc::deallocate(rep_, sizeof(Rep));
+        }
+    }
+
+public:
+    Cow() : rep_(empty_rep()) {}
+    Cow(const Cow& other) : rep_(other.rep_) {
+        if (rep_ != empty_rep()) ++rep_->owners;
+    }
+    // 赋值会丢弃原有内容, 原有内容持有的资源必须由调用方先处理, 因此不提供
+    Cow& operator=(const Cow&) = delete;
+
+    ~Cow() { release(); }
+
+    [[nodiscard]] const T& get() const { return rep_->value; }
+
+    [[nodiscard]] bool shared() const { return rep_->owners > 1; }
+
+    ///| 存储的标识与共享者个数, 供调用方统计同一份存储被哪些对象共享
+    [[nodiscard]] const void* id() const { return rep_; }
+    [[nodiscard]] size_t owners() const { return rep_->owners; }
+
+    [[nodiscard]] int8_t& hint() const { return rep_->hint; }
+
+    ///| 独占存储后返回可修改的引用; 需要复制时对新的一份调用on_copy(T&)
+    template <typename F>
+    T& mut(F&& on_copy) {
+        if (rep_ == empty_rep()) [[unlikely]] {
+            rep_ = new_rep(T());
+        } else if (rep_->owners > 1) [[unlikely]] {
+            const auto rep = new_rep(rep_->value);
+            on_copy(rep->value);
+            --rep_->owners;
+            rep_ = rep;
+        }
+        rep_->hint = -1;
+        return rep_->value;
+    }
+
+    ///| 换成一份空存储. 独占时原内容直接丢弃(其中的资源由调用方负责), 共享时只减少共享计数
+    void reset() {
+        release();
+        rep_ = empty_rep();
+    }
+};
+
+} // namespace dep
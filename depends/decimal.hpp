@@ -3,14 +3,195 @@
 #include <string>
 #include <cassert>
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 
 namespace dep {
 
+///| 舍入模式
+enum class Rounding {
+    Down,       // 向零截断
+    HalfUp,     // 四舍五入(恰好一半时远离零)
+    HalfEven,   // 银行家舍入(恰好一半时取偶)
+    Up,         // 远离零
+    Floor,      // 向负无穷
+    Ceiling,    // 向正无穷
+};
+
+///| 十进制运算上下文: 无法精确表示的结果(除法)保留precision位小数, 多余部分按rounding舍入
+struct DecimalContext {
+    int precision = 10;
+    Rounding rounding = Rounding::Down;
+};
+
+///| 当前上下文(解释器单线程, 全局一份)
+inline DecimalContext& decimal_context() {
+    static DecimalContext ctx;
+    return ctx;
+}
+
+inline const char* rounding_name(const Rounding mode) {
+    switch (mode) {
+        case Rounding::Down: return "down";
+        case Rounding::HalfUp: return "half_up";
+        case Rounding::HalfEven: return "half_even";
+        case Rounding::Up: return "up";
+        case Rounding::Floor: return "floor";
+        case Rounding::Ceiling: return "ceiling";
+    }
+    return "down";
+}
+
+///| 按名称解析舍入模式, 未知名称返回false
+inline bool parse_rounding(const std::string& name, Rounding& out) {
+    for (const auto mode : {Rounding::Down, Rounding::HalfUp, Rounding::HalfEven,
+                            Rounding::Up, Rounding::Floor, Rounding::Ceiling}) {
+        if (name == rounding_name(mode)) {
+            out = mode;
+            return true;
+        }
+    }
+    return false;
+}
+
 class Decimal {
     BigInt mantissa_;   // 尾数（包含符号，归一化后无末尾零）
     int exponent_;      // 指数：value = mantissa_ * 10^exponent_
 
+    // ========================= 机器字快速路径 =========================
+    // 尾数能放入int64_t时, 对齐/运算/舍入都在机器字上完成, 不经过BigInt乘法和字符串;
+    // 中间结果用128位整数保存, 最终尾数放不进int64_t时退回BigInt路径
+#if defined(__SIZEOF_INT128__)
+    using wide_t = __int128;
+#else
+    // MSVC等没有__int128的平台: 中间结果也限制在int64_t内, 溢出检查改为显式比较
+    using wide_t = int64_t;
+#endif
+    static constexpr int max_small_scale = 18;  // 10^18 < 2^63
+
+    static int64_t pow10_small(const int k) {
+        static constexpr int64_t table[max_small_scale + 1] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+            10000000000, 100000000000, 1000000000000, 10000000000000, 100000000000000,
+            1000000000000000, 10000000000000000, 100000000000000000, 1000000000000000000,
+        };
+        return table[k];
+    }
+
+    ///| out = m * 10^k, 要求0 <= k; k过大或溢出时返回false
+    static bool scale_wide(const int64_t m, const int64_t k, wide_t& out) {
+        if (k < 0 || k > max_small_scale) return false;
+#if defined(__SIZEOF_INT128__)
+        out = static_cast<wide_t>(m) * pow10_small(static_cast<int>(k));  // |m| * 10^18 < 2^123
+        return true;
+#else
+        const int64_t p = pow10_small(static_cast<int>(k));
+        if (m > INT64_MAX / p || m < -(INT64_MAX / p)) return false;
+        out = m * p;
+        return true;
+#endif
+    }
+
+    static bool add_wide(const wide_t a, const wide_t b, wide_t& out) {
+#if defined(__SIZEOF_INT128__)
+        out = a + b;  // 两个操作数都来自scale_wide, 和不会溢出
+        return true;
+#else
+        if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b)) return false;
+        out = a + b;
+        return true;
+#endif
+    }
+
+    static bool mul_wide(const int64_t a, const int64_t b, wide_t& out) {
+#if defined(__SIZEOF_INT128__)
+        out = static_cast<wide_t>(a) * b;
+        return true;
+#else
+        const uint64_t ua = a < 0 ? 0 - static_cast<uint64_t>(a) : static_cast<uint64_t>(a);
+        const uint64_t ub = b < 0 ? 0 - static_cast<uint64_t>(b) : static_cast<uint64_t>(b);
+        if (ua != 0 && ub > static_cast<uint64_t>(INT64_MAX) / ua) return false;
+        out = a * b;
+        return true;
+#endif
+    }
+
+    static bool narrow(const wide_t v, int64_t& out) {
+#if defined(__SIZEOF_INT128__)
+        if (v > INT64_MAX || v < INT64_MIN) return false;
+#endif
+        out = static_cast<int64_t>(v);
+        return true;
+    }
+
+    ///| 由机器字尾数设置值, 同时去掉末尾零
+    void set_small(int64_t m, int exp) {
+        if (m == 0) {
+            exp = 0;
+        } else {
+            while (m % 10 == 0) {
+                m /= 10;
+                ++exp;
+            }
+        }
+        mantissa_ = BigInt::from_int64(m);
+        exponent_ = exp;
+    }
+
+    ///| 两数尾数都能放入int64_t时, 对齐到较小指数后的机器字尾数
+    static bool align_small(const Decimal& a, const Decimal& b, wide_t& a_mant, wide_t& b_mant, int& exp) {
+        int64_t am, bm;
+        if (!a.mantissa_.try_to_int64(am) || !b.mantissa_.try_to_int64(bm)) return false;
+        exp = std::min(a.exponent_, b.exponent_);
+        return scale_wide(am, static_cast<int64_t>(a.exponent_) - exp, a_mant)
+            && scale_wide(bm, static_cast<int64_t>(b.exponent_) - exp, b_mant);
+    }
+
+    /**
+     * @brief 截断除法的商是否需要向远离零的方向进一
+     * @param negative 精确商是否为负
+     * @param inexact 余数是否非零
+     * @param half_cmp 2|余数|与|除数|的比较结果(<0, 0, >0)
+     * @param odd 截断商是否为奇数
+     */
+    static bool round_away(const Rounding mode, const bool negative, const bool inexact,
+                           const int half_cmp, const bool odd) {
+        if (!inexact) return false;
+        switch (mode) {
+            case Rounding::Down: return false;
+            case Rounding::Up: return true;
+            case Rounding::Floor: return negative;
+            case Rounding::Ceiling: return !negative;
+            case Rounding::HalfUp: return half_cmp >= 0;
+            case Rounding::HalfEven: return half_cmp > 0 || (half_cmp == 0 && odd);
+        }
+        return false;
+    }
+
+    ///| 机器字快速路径的除法, 结果为商的尾数(指数-n); 放不进机器字时返回false
+    [[nodiscard]] bool div_small(const Decimal& other, const int n, const Rounding mode, Decimal& res) const {
+        int64_t am, bm;
+        if (!mantissa_.try_to_int64(am) || !other.mantissa_.try_to_int64(bm)) return false;
+        const int exp = std::min(exponent_, other.exponent_);
+        wide_t dividend, divisor;
+        if (!scale_wide(am, static_cast<int64_t>(exponent_) - exp + n, dividend)) return false;
+        if (!scale_wide(bm, static_cast<int64_t>(other.exponent_) - exp, divisor)) return false;
+
+        wide_t q = dividend / divisor;
+        const wide_t r = dividend % divisor;
+        const bool negative = (dividend < 0) != (divisor < 0);
+        const wide_t r_abs = r < 0 ? -r : r;
+        const wide_t d_abs = divisor < 0 ? -divisor : divisor;
+        // r_abs < d_abs, 用d_abs - r_abs比较避免2 * r_abs溢出
+        const int half_cmp = r_abs > d_abs - r_abs ? 1 : (r_abs == d_abs - r_abs ? 0 : -1);
+        if (round_away(mode, negative, r != 0, half_cmp, q % 2 != 0)) q += negative ? -1 : 1;
+
+        int64_t m;
+        if (!narrow(q, m)) return false;
+        res.set_small(m, -n);
+        return true;
+    }
+
     /**
      * @brief 归一化：确保尾数无末尾零，保证表示唯一性
      * 例如：1200×10^-3 → 12×10^-1；-000 → 0×10^0
@@ -20,6 +201,11 @@ class Decimal {
             exponent_ = 0;
             return;
         }
+        int64_t small;
+        if (mantissa_.try_to_int64(small)) {
+            set_small(small, exponent_);
+            return;
+        }
         // 移除尾数末尾的零，同步调整指数
         BigInt ten(10);
         while (mantissa_ % ten == BigInt(0)) {
@@ -288,6 +474,11 @@ public:
 
     // ========================= 比较运算符（逻辑正确，无需修改） =========================
     bool operator==(const Decimal& other) const {
+        // 归一化后表示唯一, 指数不同的两个机器字尾数必然不等
+        int64_t a, b;
+        if (mantissa_.try_to_int64(a) && other.mantissa_.try_to_int64(b)) {
+            return a == b && exponent_ == other.exponent_;
+        }
         if (exponent_ != other.exponent_) {
             BigInt a_mant, b_mant;
             align_exponent(*this, other, a_mant, b_mant);
@@ -301,6 +492,11 @@ public:
     }
 
     bool operator<(const Decimal& other) const {
+        wide_t a_small, b_small;
+        int exp;
+        if (align_small(*this, other, a_small, b_small, exp)) {
+            return a_small < b_small;
+        }
         BigInt a_mant, b_mant;
         align_exponent(*this, other, a_mant, b_mant);
         return a_mant < b_mant;
@@ -320,6 +516,15 @@ public:
 
     // ========================= 算术运算符（保持原有） =========================
     Decimal operator+(const Decimal& other) const {
+        wide_t a_small, b_small, sum;
+        int64_t m;
+        int small_exp;
+        if (align_small(*this, other, a_small, b_small, small_exp)
+            && add_wide(a_small, b_small, sum) && narrow(sum, m)) {
+            Decimal res;
+            res.set_small(m, small_exp);
+            return res;
+        }
         BigInt a_mant, b_mant;
         int exp = align_exponent(*this, other, a_mant, b_mant);
         BigInt sum_mant = a_mant + b_mant;
@@ -331,6 +536,16 @@ public:
     }
 
     Decimal operator-(const Decimal& other) const {
+        wide_t a_small, b_small, diff;
+        int64_t m;
+        int small_exp;
+        // scale_wide的结果都在(-2^127, 2^127)内且对称, 取负不会溢出
+        if (align_small(*this, other, a_small, b_small, small_exp)
+            && add_wide(a_small, -b_small, diff) && narrow(diff, m)) {
+            Decimal res;
+            res.set_small(m, small_exp);
+            return res;
+        }
         BigInt a_mant, b_mant;
         int exp = align_exponent(*this, other, a_mant, b_mant);
         BigInt sub_mant = a_mant - b_mant;
@@ -362,7 +577,7 @@ public:
         return res;
     }
 
-    // 在Decimal类中添加一个新的div_round方法
+    ///| 除法并四舍五入到n位小数
     [[nodiscard]] Decimal div_round(const Decimal& other, int n=10) const {
         if (other.mantissa_ == BigInt(0)) {
             throw NativeFuncError("Calculate", "Division by zero");
@@ -370,73 +585,15 @@ public:
         if (n < 0) {
             throw NativeFuncError("Calculate", "n must be non-negative");
         }
+        return div(other, n, Rounding::HalfUp);
+    }
 
-        // 先计算到n+1位小数
-        Decimal temp = this->div(other, n + 1);
-
-        // 将结果转换为字符串
-        std::string str = temp.to_string();
-
-        // 找到小数点
-        size_t dot_pos = str.find('.');
-
-        if (dot_pos == std::string::npos) {
-            return temp;  // 没有小数部分
-        }
-
-        // 分离整数和小数部分
-        std::string int_part = str.substr(0, dot_pos);
-        std::string frac_part = str.substr(dot_pos + 1);
-
-        // 确保小数部分至少有n+1位
-        if (frac_part.size() < static_cast<size_t>(n + 1)) {
-            frac_part.append(n + 1 - frac_part.size(), '0');
-        }
-
-        // 检查第n+1位
-        if (frac_part[n] >= '5') {
-            // 需要进位
-            // 构建前n位小数
-            std::string new_frac = (n > 0) ? frac_part.substr(0, n) : "";
-
-            // 对前n位进行进位操作
-            bool carry = true;
-            for (int i = n - 1; i >= 0 && carry; --i) {
-                if (new_frac[i] == '9') {
-                    new_frac[i] = '0';
-                } else {
-                    new_frac[i] += 1;
-                    carry = false;
-                }
-            }
-
-            // 处理整数部分的进位
-            BigInt int_val(int_part);
-            if (carry) {
-                if (int_part[0] == '-') {
-                    int_val = int_val - BigInt(1);
-                } else {
-                    int_val = int_val + BigInt(1);
-                }
-                int_part = int_val.to_string();
-            }
-
-            // 构建结果字符串
-            std::string result_str = int_part;
-            if (n > 0 && new_frac != std::string(n, '0')) {
-                result_str += "." + new_frac;
-            }
-
-            return Decimal(result_str);
-        } else {
-            // 直接截断到n位
-            if (n == 0) {
-                return Decimal(int_part);
-            } else {
-                std::string result_str = int_part + "." + frac_part.substr(0, n);
-                return Decimal(result_str);
-            }
-        }
+    ///| 按舍入模式保留n位小数
+    [[nodiscard]] Decimal quantize(const int n, const Rounding mode) const {
+        if (n < 0)
+            throw NativeFuncError("CalculateError", "n must be non-negative");
+        if (exponent_ >= -n) return *this;
+        return div(Decimal(1), n, mode);
     }
 
     /**
@@ -477,24 +634,36 @@ public:
     }
 
     Decimal operator*(const Decimal& other) const {
-        BigInt mul_mant = mantissa_ * other.mantissa_;
-        Decimal res(mul_mant);
-        res.exponent_ = exponent_ + other.exponent_;
+        int64_t a_small, b_small, m;
+        wide_t prod;
+        if (mantissa_.try_to_int64(a_small) && other.mantissa_.try_to_int64(b_small)
+            && mul_wide(a_small, b_small, prod) && narrow(prod, m)) {
+            Decimal res;
+            res.set_small(m, exponent_ + other.exponent_);
+            return res;
+        }
+        // 不能用Decimal(BigInt)构造: 它先归一化会改动指数, 随后被覆盖导致丢失末尾零的位数
+        Decimal res(mantissa_ * other.mantissa_, exponent_ + other.exponent_);
         res.normalize();
         return res;
     }
 
     Decimal operator/(const Decimal& other) const {
-        return this->div(other, 10); // 默认保留10位小数
+        const DecimalContext& ctx = decimal_context();
+        return this->div(other, ctx.precision, ctx.rounding);
     }
 
-    [[nodiscard]] Decimal div(const Decimal& other, int n=10) const { // n改为int类型
+    ///| 除法, 保留n位小数, 多余部分按mode舍入(默认截断)
+    [[nodiscard]] Decimal div(const Decimal& other, int n=10, const Rounding mode=Rounding::Down) const {
         if (other.mantissa_ == BigInt(0)) {
             throw KizStopRunningSignal();
         }
         if (n < 0)
             throw NativeFuncError("CalculateError", "n must be non-negative");
 
+        Decimal small_res;
+        if (div_small(other, n, mode, small_res)) return small_res;
+
         BigInt a_mant, b_mant;
         // 对齐指数（抵消a/b的指数影响）
         align_exponent(*this, other, a_mant, b_mant);
@@ -504,8 +673,20 @@ public:
         BigInt scale = BigInt::fast_pow_unsigned(ten, BigInt(n));
         BigInt dividend = a_mant * scale;
 
-        // 整数除法（截断余数）
+        // 整数除法（截断余数）, 再按舍入模式调整
         BigInt quotient = dividend / b_mant;
+        const BigInt remainder = dividend - quotient * b_mant;
+        if (remainder != BigInt(0)) {
+            const bool negative = dividend.is_negative() != b_mant.is_negative();
+            const BigInt r_abs = remainder.abs();
+            const BigInt twice = r_abs + r_abs;
+            const BigInt d_abs = b_mant.abs();
+            const int half_cmp = twice > d_abs ? 1 : (twice == d_abs ? 0 : -1);
+            const bool odd = quotient.abs() % BigInt(2) != BigInt(0);
+            if (round_away(mode, negative, true, half_cmp, odd)) {
+                quotient = negative ? quotient - BigInt(1) : quotient + BigInt(1);
+            }
+        }
 
         // 修复核心：先创建空对象，避免构造函数提前normalize
         Decimal res; // 空构造：mantissa_=0，exponent_=0
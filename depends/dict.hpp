@@ -1,284 +1,228 @@
+/**
+ * @file dict.hpp
+ * @brief 辅助容器（Dict）核心定义与实现
+ *
+ * 保持插入顺序的紧凑字典: 条目(哈希值, 值)按插入顺序稠密存放在entries_中,
+ * 另有一个开放寻址的稀疏索引表indices_, 保存条目下标. 哈希值为机器字,
+ * 键相等性由调用方传入的谓词判断, 因此哈希冲突的不同键不会互相覆盖.
+ * 删除只在索引表留下墓碑、在条目数组留下空洞, 扩容时一并压缩
+ * @author azhz1107cat
+ * @date 2025-10-25
+ */
+
 #pragma once
-#include "bigint.hpp"
-#include <vector>
-#include <memory>
+#include <bit>
+#include <cstdint>
 #include <sstream>
+#include <string>
+#include <type_traits>
 #include <utility>
-#include <functional>
+#include <vector>
 
 namespace dep {
 
 template <typename VT>
 class Dict {
 public:
-    // 桶节点：键为 BigInt，存储键值对与链表指针
-    struct Bucket {
-        BigInt key;          // 键类型改为 BigInt（支持哈希后的值）
-        VT value;            // 值类型保持泛型
-        std::shared_ptr<Bucket> next;
+    struct Entry {
+        size_t hash;
+        VT value;
+        bool alive;
+    };
 
-        // 构造函数：直接接收 BigInt 键，无需计算字符串哈希
-        Bucket(const BigInt& k, VT val)
-            : key(k), value(std::move(val)), next(nullptr) {}
+private:
+    static constexpr uint32_t empty_slot = UINT32_MAX;       // 从未使用的索引槽
+    static constexpr uint32_t dummy_slot = UINT32_MAX - 1;   // 已删除条目的墓碑
+    static constexpr size_t min_capacity = 8;
 
-        Bucket(BigInt&& k, VT&& val)
-            : key(std::move(k)), value(std::move(val)), next(nullptr) {}
-    };
+    std::vector<Entry> entries_;     // 按插入顺序排列, 删除后留下alive=false的空洞
+    std::vector<uint32_t> indices_;  // 稀疏索引表, 容量为2的幂, 懒分配
+    size_t size_ = 0;                // 存活条目数
+    int home_shift_ = 61;            // 64 - log2(indices_.size())
 
-    using Node = Bucket;
-    std::vector<std::shared_ptr<Node>> buckets_;  // 桶数组（链表头指针）
-    size_t elem_count_ = 0;                       // 元素总数
-    const float load_factor_ = 0.7f;              // 负载因子（const 不可修改）
+    // Fibonacci哈希: 用乘法把哈希高位散开, 避免连续整数键聚集在同一段槽位
+    [[nodiscard]] size_t home(const size_t hash) const {
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> home_shift_);
+    }
 
-    /**
-     * @brief 从 BigInt 键生成桶索引（基于 BigInt 的字符串哈希）
-     * 保证相同 BigInt 键始终映射到相同索引
-     */
-    [[nodiscard]] size_t getBucketIndex(const BigInt& key) const {
-        std::string key_str = key.to_string();
-        size_t hash = std::hash<std::string>()(key_str);
-        return hash & (buckets_.size() - 1);  // 位运算取模，要求桶大小为 2 的幂
+    // 条目数组可用上限: 索引表容量的2/3(条目数组满即需重建, 包括空洞)
+    [[nodiscard]] size_t usable() const {
+        return indices_.size() * 2 / 3;
     }
 
-    /**
-     * @brief 扩容：桶大小翻倍，重新哈希所有元素
-     * 修复原逻辑中索引计算依赖节点 hash 的耦合问题
-     */
-    void resize() {
-        const size_t old_size = buckets_.size();
-        const size_t new_size = old_size * 2;
-        std::vector<std::shared_ptr<Node>> new_buckets(new_size, nullptr);
+    // 按存活条目数重建索引表并压缩条目数组
+    void rebuild(const size_t min_entries) {
+        size_t capacity = min_capacity;
+        while (capacity * 2 / 3 < min_entries) capacity *= 2;
 
-        for (size_t i = 0; i < old_size; ++i) {
-            std::shared_ptr<Node> current = buckets_[i];
-            while (current != nullptr) {
-                std::shared_ptr<Node> next_node = current->next;
-                // 基于当前节点的 BigInt 键重新计算新索引
-                size_t new_idx = getBucketIndex(current->key);
-                // 头插法插入新桶
-                current->next = new_buckets[new_idx];
-                new_buckets[new_idx] = current;
-                current = next_node;
+        if (size_ != entries_.size()) {
+            std::vector<Entry> compact;
+            compact.reserve(capacity * 2 / 3);
+            for (auto& entry : entries_) {
+                if (entry.alive) compact.push_back(std::move(entry));
             }
+            entries_.swap(compact);
+        } else {
+            entries_.reserve(capacity * 2 / 3);
         }
 
-        buckets_.swap(new_buckets);
-    }
-
-    // ========================= 构造与析构 =========================
-    explicit Dict() {
-        constexpr size_t init_size = 16;  // 初始桶大小为 2 的幂
-        buckets_.resize(init_size, nullptr);
-    }
-
-    // 用 BigInt 键值对 vector 初始化
-    explicit Dict(const std::vector<std::pair<BigInt, VT>>& vec) {
-        // 计算初始桶大小，保证负载因子不超限
-        size_t init_size = 16;
-        while (init_size < (vec.size() / load_factor_)) {
-            init_size *= 2;
+        indices_.assign(capacity, empty_slot);
+        home_shift_ = 64 - std::countr_zero(capacity);
+        const size_t mask = capacity - 1;
+        for (uint32_t i = 0; i < entries_.size(); ++i) {
+            size_t pos = home(entries_[i].hash);
+            while (indices_[pos] != empty_slot) pos = (pos + 1) & mask;
+            indices_[pos] = i;
         }
-        buckets_.resize(init_size, nullptr);
+    }
 
-        for (const auto& [key, val] : vec) {
-            insert(key, val);
+    // 查找键所在的索引槽, 不存在返回indices_.size()
+    template <typename Eq>
+    [[nodiscard]] size_t find_slot(const size_t hash, Eq&& eq) const {
+        if (indices_.empty()) return 0;
+        const size_t mask = indices_.size() - 1;
+        for (size_t pos = home(hash);; pos = (pos + 1) & mask) {
+            const uint32_t idx = indices_[pos];
+            if (idx == empty_slot) return indices_.size();
+            if (idx == dummy_slot) continue;
+            const Entry& entry = entries_[idx];
+            if (entry.hash == hash and eq(entry.value)) return pos;
         }
     }
 
-    ~Dict() = default;  // shared_ptr 自动管理内存
+public:
+    // ========================= 构造与析构 =========================
+    Dict() = default;
+    ~Dict() = default;
 
-    // ========================= 拷贝与移动语义 =========================
-    // 深拷贝构造：逐节点拷贝键值对
-    Dict(const Dict& other)
-        : load_factor_(other.load_factor_) {  // const 成员只能初始化，不能赋值
-        auto all_kv = other.to_vector();
-        size_t init_size = 16;
-        while (init_size < (all_kv.size() / load_factor_)) {
-            init_size *= 2;
-        }
-        buckets_.resize(init_size, nullptr);
+    Dict(const Dict&) = default;
+    Dict(Dict&&) noexcept = default;
+    Dict& operator=(const Dict&) = default;
+    Dict& operator=(Dict&&) noexcept = default;
 
-        for (const auto& [key, val] : all_kv) {
-            insert(key, val);
-        }
-        elem_count_ = other.elem_count_;
+    ///| 预留至少n个条目的空间
+    void reserve(const size_t n) {
+        if (n > usable()) rebuild(n);
     }
 
-    // 移动构造：转移资源所有权
-    Dict(Dict&& other) noexcept
-        : buckets_(std::move(other.buckets_)),
-          elem_count_(other.elem_count_),
-          load_factor_(other.load_factor_) {  // const 成员直接拷贝初始化
-        other.elem_count_ = 0;
-        other.buckets_.clear();
+    // ========================= 核心操作 =========================
+    /**
+     * @brief 查找键对应的条目
+     * @param hash 键的哈希值
+     * @param eq 键相等谓词, 参数为条目中保存的值; 不能修改本字典(探测过程中的下标与引用会失效)
+     * @return 找到返回条目指针(追加新条目前有效), 否则返回nullptr
+     */
+    template <typename Eq>
+    [[nodiscard]] Entry* find(const size_t hash, Eq&& eq) {
+        const size_t pos = find_slot(hash, eq);
+        return pos < indices_.size() ? &entries_[indices_[pos]] : nullptr;
     }
 
-    // 深拷贝赋值
-    Dict& operator=(const Dict& other) {
-        if (this == &other) return *this;
-
-        // 清空当前资源
-        buckets_.clear();
-        elem_count_ = 0;
-
-        // 重新初始化桶并插入数据
-        auto all_kv = other.to_vector();
-        size_t init_size = 16;
-        while (init_size < (all_kv.size() / load_factor_)) {
-            init_size *= 2;
-        }
-        buckets_.resize(init_size, nullptr);
-
-        for (const auto& [key, val] : all_kv) {
-            insert(key, val);
-        }
-        elem_count_ = all_kv.size();
-
-        return *this;
+    template <typename Eq>
+    [[nodiscard]] const Entry* find(const size_t hash, Eq&& eq) const {
+        const size_t pos = find_slot(hash, eq);
+        return pos < indices_.size() ? &entries_[indices_[pos]] : nullptr;
     }
 
-    // 移动赋值：修复原逻辑中修改 const 成员的 Bug
-    Dict& operator=(Dict&& other) noexcept {
-        if (this == &other) return *this;
-
-        // 清空当前资源
-        buckets_.clear();
-        elem_count_ = 0;
-
-        // 转移 other 的资源（不修改 load_factor_）
-        buckets_ = std::move(other.buckets_);
-        elem_count_ = other.elem_count_;
-
-        // 置空原对象
-        other.elem_count_ = 0;
-        other.buckets_.clear();
+    ///| 条目在条目数组中的位置, entry必须是本字典find/entry_at返回的条目
+    [[nodiscard]] size_t position(const Entry* entry) const {
+        return static_cast<size_t>(entry - entries_.data());
+    }
 
-        return *this;
+    ///| 按位置取可修改的条目, 调用方保证该位置的条目存活
+    [[nodiscard]] Entry& entry_ref(const size_t pos) {
+        return entries_[pos];
     }
 
-    // ========================= 核心操作：插入与查找 =========================
     /**
-     * @brief 插入/更新键值对（基于 BigInt 键）
-     * @param key BigInt 类型键（支持已哈希值）
-     * @param val 要存储的值
-     * @return 旧值（若存在），否则返回 VT()
+     * @brief 追加一个新条目, 调用方保证键不存在(先用find检查)
+     * @return 新条目的指针
      */
-    VT insert(const BigInt& key, VT val) {
-        if (buckets_.empty()) {
-            buckets_.resize(16, nullptr);
-        }
-
-        size_t bucket_idx = getBucketIndex(key);
-        VT old_val = VT();
-
-        // 检查键是否已存在：存在则更新值
-        std::shared_ptr<Node> current = buckets_[bucket_idx];
-        while (current != nullptr) {
-            if (current->key == key) {
-                old_val = std::move(current->value);
-                current->value = std::move(val);
-                return old_val;
-            }
-            current = current->next;
-        }
-
-        // 检查负载因子，触发扩容
-        if (static_cast<float>(elem_count_) / buckets_.size() >= load_factor_) {
-            resize();
-            // 扩容后重新计算索引
-            bucket_idx = getBucketIndex(key);
-        }
-
-        // 插入新节点（头插法）
-        auto new_node = std::make_shared<Node>(key, std::move(val));
-        new_node->next = buckets_[bucket_idx];
-        buckets_[bucket_idx] = new_node;
-        elem_count_++;
-
-        return old_val;
+    Entry* append(const size_t hash, VT val) {
+        if (entries_.size() >= usable()) rebuild((size_ + 1) * 2);
+        const size_t mask = indices_.size() - 1;
+        size_t pos = home(hash);
+        // 墓碑槽可复用, 但墓碑之后仍可能链着其他键, 因此只在确认键不存在时追加
+        while (indices_[pos] != empty_slot and indices_[pos] != dummy_slot) pos = (pos + 1) & mask;
+        indices_[pos] = static_cast<uint32_t>(entries_.size());
+        entries_.push_back(Entry{hash, std::move(val), true});
+        ++size_;
+        return &entries_.back();
     }
 
     /**
-     * @brief 查找 BigInt 键对应的节点
-     * @return 找到返回节点指针，否则返回 nullptr
+     * @brief 删除键对应的条目
+     * @param out 若非空, 接收被删除的值
+     * @return 是否删除成功
      */
-    [[nodiscard]] std::shared_ptr<Node> find(const BigInt& key) const {
-        if (buckets_.empty()) {
-            return nullptr;
-        }
+    template <typename Eq>
+    bool erase(const size_t hash, Eq&& eq, VT* out = nullptr) {
+        const size_t pos = find_slot(hash, eq);
+        if (pos >= indices_.size()) return false;
+        Entry& entry = entries_[indices_[pos]];
+        if (out) *out = std::move(entry.value);
+        entry.value = VT();
+        entry.alive = false;
+        indices_[pos] = dummy_slot;
+        --size_;
+        return true;
+    }
 
-        size_t bucket_idx = getBucketIndex(key);
-        std::shared_ptr<Node> current = buckets_[bucket_idx];
+    // ========================= 遍历 =========================
+    ///| 条目数组长度(含删除留下的空洞), 配合entry_at按位置遍历
+    [[nodiscard]] size_t entry_count() const {
+        return entries_.size();
+    }
 
-        while (current != nullptr) {
-            if (current->key == key) {
-                return current;
-            }
-            current = current->next;
-        }
+    ///| 第pos个条目, 已删除返回nullptr
+    [[nodiscard]] const Entry* entry_at(const size_t pos) const {
+        return entries_[pos].alive ? &entries_[pos] : nullptr;
+    }
 
-        return nullptr;
+    ///| 按插入顺序遍历存活条目, f(hash, value)
+    template <typename F>
+    void for_each(F&& f) const {
+        for (const auto& entry : entries_) {
+            if (entry.alive) f(entry.hash, entry.value);
+        }
     }
 
     // ========================= 辅助方法 =========================
-    /**
-     * @brief 转换为字符串（支持 VT 类型的 to_string 方法或指针）
-     */
     [[nodiscard]] std::string to_string() const {
         std::stringstream ss;
         ss << "{ ";
-
-        size_t printed = 0;
-        for (const auto& bucket_head : buckets_) {
-            auto current = bucket_head;
-            while (current != nullptr) {
-                ss << current->key.to_string() << ": ";
-                if constexpr (std::is_pointer_v<VT>) {
-                    ss << static_cast<void*>(current->value);
-                } else {
-                    ss << current->value.to_string();
-                }
-
-                printed++;
-                if (printed < elem_count_) {
-                    ss << ", ";
-                }
-                current = current->next;
+        bool first = true;
+        for_each([&](const size_t hash, const VT& value) {
+            if (!first) ss << ", ";
+            ss << hash << ": ";
+            if constexpr (std::is_pointer_v<VT>) {
+                ss << static_cast<const void*>(value);
+            } else {
+                ss << value.to_string();
             }
-        }
-
+            first = false;
+        });
         ss << " }";
         return ss.str();
     }
 
     /**
-     * @brief 转换为 BigInt 键值对 vector
+     * @brief 按插入顺序转换为 哈希值-值 对 vector
      */
-    [[nodiscard]] std::vector<std::pair<BigInt, VT>> to_vector() const {
-        std::vector<std::pair<BigInt, VT>> vec;
-        for (const auto& bucket_head : buckets_) {
-            auto current = bucket_head;
-            while (current != nullptr) {
-                vec.emplace_back(current->key, current->value);
-                current = current->next;
-            }
-        }
+    [[nodiscard]] std::vector<std::pair<size_t, VT>> to_vector() const {
+        std::vector<std::pair<size_t, VT>> vec;
+        vec.reserve(size_);
+        for_each([&vec](const size_t hash, const VT& value) { vec.emplace_back(hash, value); });
         return vec;
     }
 
-    /**
-     * @brief 获取元素数量
-     */
     [[nodiscard]] size_t size() const {
-        return elem_count_;
+        return size_;
     }
 
-    /**
-     * @brief 判断是否为空
-     */
     [[nodiscard]] bool empty() const {
-        return elem_count_ == 0;
+        return size_ == 0;
     }
 };
 
-} // namespace dep
\ No newline at end of file
+} // namespace dep
@@ -1,18 +1,32 @@
 /**
  * @file hashmap.hpp
  * @brief 辅助容器（HashMap）核心定义与实现
- * 
+ *
+ * 开放寻址的Swiss table: 槽位内联存放键值对和缓存的哈希值,
+ * 另有一个控制字节数组(每槽1字节: 空, 或哈希值高7位), 查找时一次比较16个控制字节
+ * (SSE2/NEON, 其他平台使用标量回退). 采用线性探测, 删除时向后移位填补空洞, 不使用墓碑
  * @author azhz1107cat
  * @date 2025-10-25
  */
 
 #pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <vector>
-#include <string>
-#include <memory>
+#include <new>
 #include <sstream>
+#include <string>
 #include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DEP_HASHMAP_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DEP_HASHMAP_NEON 1
+#endif
 
 namespace dep {
 
@@ -28,219 +42,316 @@ inline size_t hash_string(const std::string& key) {
     return hash;
 }
 
+namespace swiss {
+
+constexpr size_t group_width = 16;
+constexpr uint8_t ctrl_empty = 0x80;  // 最高位为1表示空槽, 满槽保存哈希值高7位(最高位为0)
+
+// 一组16个控制字节的匹配结果, 每个匹配的字节对应stride个位中的一位
+struct BitMask {
+#if DEP_HASHMAP_NEON
+    static constexpr int stride = 4;
+#else
+    static constexpr int stride = 1;
+#endif
+    uint64_t bits;
+
+    explicit operator bool() const { return bits != 0; }
+    [[nodiscard]] size_t lowest() const { return static_cast<size_t>(std::countr_zero(bits)) / stride; }
+    void clear_lowest() { bits &= bits - 1; }
+    // 仅保留位于第一个空槽之前的匹配(线性探测下键一定出现在第一个空槽之前)
+    [[nodiscard]] BitMask before(const BitMask& empty) const {
+        if (!empty) return *this;
+        return BitMask{bits & ((uint64_t{1} << std::countr_zero(empty.bits)) - 1)};
+    }
+};
+
+struct Group {
+#if DEP_HASHMAP_SSE2
+    __m128i ctrl;
+    explicit Group(const uint8_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+    [[nodiscard]] BitMask match(const uint8_t h2) const {
+        const auto eq = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(h2)));
+        return BitMask{static_cast<uint32_t>(_mm_movemask_epi8(eq))};
+    }
+    [[nodiscard]] BitMask match_empty() const {
+        return BitMask{static_cast<uint32_t>(_mm_movemask_epi8(ctrl))};
+    }
+#elif DEP_HASHMAP_NEON
+    uint8x16_t ctrl;
+    explicit Group(const uint8_t* p) : ctrl(vld1q_u8(p)) {}
+
+    static BitMask to_mask(const uint8x16_t eq) {
+        // 每字节压缩为4位, 每个匹配只保留其中一位
+        const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+        return BitMask{vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL};
+    }
+    [[nodiscard]] BitMask match(const uint8_t h2) const { return to_mask(vceqq_u8(ctrl, vdupq_n_u8(h2))); }
+    [[nodiscard]] BitMask match_empty() const { return to_mask(vceqq_u8(ctrl, vdupq_n_u8(ctrl_empty))); }
+#else
+    uint8_t ctrl[group_width];
+    explicit Group(const uint8_t* p) { std::memcpy(ctrl, p, group_width); }
+
+    [[nodiscard]] BitMask match(const uint8_t h2) const {
+        uint64_t bits = 0;
+        for (size_t i = 0; i < group_width; ++i) {
+            if (ctrl[i] == h2) bits |= uint64_t{1} << i;
+        }
+        return BitMask{bits};
+    }
+    [[nodiscard]] BitMask match_empty() const { return match(ctrl_empty); }
+#endif
+};
+
+} // namespace swiss
+
 // 模板类：键为std::string，值为任意类型T的HashMap
 template <typename VT>
 class HashMap {
 public:
-    // 嵌套桶节点结构体（存储键值对、哈希值、链表指针）
+    // 槽位节点（存储键值对与缓存的哈希值）
     struct StringBucket {
         std::string key;
         VT value;
         size_t hash;
-        std::shared_ptr<StringBucket> next;
-
-        // 修复：先拷贝key，计算hash后再move，避免初始化顺序问题
-        StringBucket(const std::string& k, VT val)
-            : key(k),  // 先拷贝，不提前move
-              value(std::move(val)),
-              hash(hash_string(k)), // 直接用入参k计算hash，避免依赖成员变量初始化顺序
-              next(nullptr) {}
-
-        // 保留移动构造（优化性能）
-        StringBucket(std::string&& k, VT&& val)
-            : key(std::move(k)),
-              value(std::move(val)),
-              hash(hash_string(this->key)), // 此时key已move完成
-              next(nullptr) {}
     };
 
     using Node = StringBucket;  // 简化节点类型名
-    std::vector<std::shared_ptr<Node>> buckets_;  // 桶数组（每个元素是链表头指针）
-    size_t elem_count_ = 0;                       // 元素总数
-    const float load_factor_ = 0.7f;              // 负载因子（触发扩容的阈值）
 
-    // 计算键对应的桶索引（利用位运算，要求桶大小为2的幂）
-    [[nodiscard]] size_t getBucketIndex(const size_t hash) const {
-        return hash & (this->buckets_.size() - 1);
+private:
+    uint8_t* ctrl_ = nullptr;   // capacity_ + group_width - 1 个控制字节, 末尾复制开头的字节供跨界整组读取
+    Node* slots_ = nullptr;     // 未初始化的槽位存储, 仅满槽上有构造好的Node
+    size_t capacity_ = 0;       // 0或不小于group_width的2的幂
+    size_t elem_count_ = 0;
+    int home_shift_ = 63;       // 64 - log2(capacity_)
+
+    static uint8_t h2(const size_t hash) { return static_cast<uint8_t>(hash >> 57); }
+    // FNV-1a的低位只由各字符的低位决定, 相近的键会聚成簇; 用斐波那契散列取高位作为起始槽位
+    [[nodiscard]] size_t home(const size_t hash) const {
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> home_shift_);
+    }
+    [[nodiscard]] bool is_full(const size_t i) const { return ctrl_[i] != swiss::ctrl_empty; }
+
+    void set_ctrl(const size_t i, const uint8_t c) {
+        ctrl_[i] = c;
+        if (i < swiss::group_width - 1) ctrl_[capacity_ + i] = c;
+    }
+
+    void allocate(const size_t capacity) {
+        capacity_ = capacity;
+        home_shift_ = 64 - std::countr_zero(capacity);
+        ctrl_ = new uint8_t[capacity + swiss::group_width - 1];
+        std::memset(ctrl_, swiss::ctrl_empty, capacity + swiss::group_width - 1);
+        slots_ = static_cast<Node*>(::operator new(capacity * sizeof(Node), std::align_val_t{alignof(Node)}));
     }
 
-    // 扩容：桶数组大小翻倍，重新哈希所有元素
-    void resize() {
-        const size_t old_size = buckets_.size();
-        const size_t new_size = old_size * 2;
-        std::vector<std::shared_ptr<Node>> new_buckets(new_size, nullptr);
-
-        for (size_t i = 0; i < old_size; ++i) {
-            std::shared_ptr<Node> current = buckets_[i];
-            while (current != nullptr) {
-                const std::shared_ptr<Node> next = current->next;
-                // 修复：使用节点自身缓存的hash计算新索引
-                const size_t new_idx = current->hash & (new_size - 1);
-                current->next = new_buckets[new_idx];
-                new_buckets[new_idx] = current;
-                current = next;
+    void release() {
+        if (!ctrl_) return;
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (is_full(i)) slots_[i].~Node();
+        }
+        ::operator delete(slots_, std::align_val_t{alignof(Node)});
+        delete[] ctrl_;
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        capacity_ = 0;
+        elem_count_ = 0;
+    }
+
+    // 返回第一个空槽的下标(调用方保证键不存在且有空位)
+    [[nodiscard]] size_t find_empty(const size_t hash) const {
+        size_t pos = home(hash);
+        while (true) {
+            const swiss::Group g(ctrl_ + pos);
+            if (const auto empty = g.match_empty()) {
+                return (pos + empty.lowest()) & (capacity_ - 1);
             }
+            pos = (pos + swiss::group_width) & (capacity_ - 1);
         }
+    }
 
-        buckets_.swap(new_buckets);
+    // 扩容：容量翻倍，重新放置所有元素
+    void resize(const size_t new_capacity) {
+        uint8_t* old_ctrl = ctrl_;
+        Node* old_slots = slots_;
+        const size_t old_capacity = capacity_;
+
+        allocate(new_capacity);
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] == swiss::ctrl_empty) continue;
+            Node& node = old_slots[i];
+            const size_t slot = find_empty(node.hash);
+            new (slots_ + slot) Node(std::move(node));
+            set_ctrl(slot, h2(node.hash));
+            node.~Node();
+        }
+        if (old_ctrl) {
+            ::operator delete(old_slots, std::align_val_t{alignof(Node)});
+            delete[] old_ctrl;
+        }
     }
 
-    // 默认构造函数（初始桶大小为16，2的幂）
-    explicit HashMap() {
-        constexpr size_t init_size = 16;
-        buckets_.resize(init_size, nullptr);
+    void reserve_for_insert() {
+        if (capacity_ == 0) {
+            allocate(swiss::group_width);
+        } else if ((elem_count_ + 1) * 4 > capacity_ * 3) {
+            // 线性探测的簇长度随负载快速增长, 负载因子上限取3/4
+            resize(capacity_ * 2);
+        }
     }
 
-    // 用键值对vector初始化
-    explicit HashMap(const std::vector<std::pair<std::string, VT>>& vec) {
-        // 计算初始桶大小（确保负载因子不超过阈值）
-        size_t init_size = 16;
-        while (init_size < (vec.size() / load_factor_)) {
-            init_size *= 2;
+    void copy_from(const HashMap& other) {
+        if (other.elem_count_ == 0) return;
+        allocate(other.capacity_);
+        for (size_t i = 0; i < other.capacity_; ++i) {
+            if (!other.is_full(i)) continue;
+            new (slots_ + i) Node(other.slots_[i]);
+            set_ctrl(i, other.ctrl_[i]);
         }
-        buckets_.resize(init_size, nullptr);
+        elem_count_ = other.elem_count_;
+    }
+
+public:
+    // 默认构造函数（首次插入时才分配）
+    HashMap() = default;
 
-        // 插入所有初始键值对
+    // 用键值对vector初始化
+    explicit HashMap(const std::vector<std::pair<std::string, VT>>& vec) {
         for (const auto& [key, val] : vec) {
             insert(key, val);
         }
     }
 
-    // 析构函数（默认即可，shared_ptr自动释放内存）
-    ~HashMap() = default;
+    ~HashMap() { release(); }
 
-    // 插入/更新键值对（存在则更新，不存在则插入）
-    VT insert(const std::string& key, VT val) {
-        if (buckets_.empty()) {
-            buckets_.resize(16, nullptr);
-        }
+    // 深拷贝构造函数
+    HashMap(const HashMap& other) { copy_from(other); }
 
-        // 修复：先计算hash和bucket_idx（基于当前桶大小）
-        const size_t hash = hash_string(key);
-        size_t bucket_idx = getBucketIndex(hash);
-
-        // 检查是否已存在（扩容前先查，避免扩容后索引变化）
-        std::shared_ptr<Node> current = buckets_[bucket_idx];
-        while (current != nullptr) {
-            if (current->hash == hash && current->key == key) {
-                current->value = std::move(val);
-                return VT(); // 更新值，不递增计数
-            }
-            current = current->next;
-        }
+    HashMap(HashMap&& other) noexcept
+        : ctrl_(other.ctrl_), slots_(other.slots_), capacity_(other.capacity_), elem_count_(other.elem_count_),
+          home_shift_(other.home_shift_) {
+        other.ctrl_ = nullptr;
+        other.slots_ = nullptr;
+        other.capacity_ = 0;
+        other.elem_count_ = 0;
+    }
 
-        // 检查负载因子，需要扩容则重新计算索引
-        if (static_cast<float>(elem_count_) / buckets_.size() >= load_factor_) {
-            this->resize();
-            // 扩容后重新计算索引（基于新桶大小）
-            bucket_idx = getBucketIndex(hash);
-        }
+    HashMap& operator=(const HashMap& other) {
+        if (this == &other) return *this;
+        release();
+        copy_from(other);
+        return *this;
+    }
+
+    HashMap& operator=(HashMap&& other) noexcept {
+        if (this == &other) return *this;
+        release();
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(elem_count_, other.elem_count_);
+        std::swap(home_shift_, other.home_shift_);
+        return *this;
+    }
 
-        // 插入新节点（头插法）
-        auto new_node = std::make_shared<Node>(key, std::move(val));
-        new_node->next = buckets_[bucket_idx];
-        buckets_[bucket_idx] = new_node;
-        elem_count_++; // 仅插入新节点时递增
+    [[nodiscard]] size_t size() const { return elem_count_; }
 
+    // 插入/更新键值对（存在则更新，不存在则插入）
+    VT insert(const std::string& key, VT val) {
+        const size_t hash = hash_string(key);
+        if (Node* node = find_hashed(key, hash)) {
+            node->value = std::move(val);
+            return VT(); // 更新值，不递增计数
+        }
+        reserve_for_insert();
+        const size_t slot = find_empty(hash);
+        new (slots_ + slot) Node{key, std::move(val), hash};
+        set_ctrl(slot, h2(hash));
+        elem_count_++;
         return VT();
     }
 
-    [[nodiscard]] std::shared_ptr<Node> find(const std::string& key) const {
-        return find_in_current(key);
+    // 返回的指针在下一次插入或删除前有效
+    [[nodiscard]] Node* find(const std::string& key) const {
+        return find_hashed(key, hash_string(key));
     }
 
     // 仅在当前HashMap查找键（不递归父结构体）
-    [[nodiscard]] std::shared_ptr<Node> find_in_current(const std::string& key) const {
-        if (buckets_.empty()) {
-            return nullptr;
-        }
-
-        const size_t hash = hash_string(key);
-        const size_t bucket_idx = getBucketIndex(hash);
-        if (bucket_idx >= buckets_.size()) {
-            return nullptr;
-        }
+    [[nodiscard]] Node* find_in_current(const std::string& key) const {
+        return find_hashed(key, hash_string(key));
+    }
 
-        // 遍历桶对应的链表查找
-        std::shared_ptr<Node> current = buckets_[bucket_idx];
-        while (current != nullptr) {
-            if (current->hash == hash && current->key == key) {
-                return current;
+    // 使用预先计算好的哈希值查找
+    [[nodiscard]] Node* find_hashed(const std::string& key, const size_t hash) const {
+        if (elem_count_ == 0) return nullptr;
+        const uint8_t tag = h2(hash);
+        size_t pos = home(hash);
+        while (true) {
+            const swiss::Group g(ctrl_ + pos);
+            const auto empty = g.match_empty();
+            for (auto m = g.match(tag).before(empty); m; m.clear_lowest()) {
+                Node& node = slots_[(pos + m.lowest()) & (capacity_ - 1)];
+                if (node.hash == hash && node.key == key) return &node;
             }
-            current = current->next;
+            if (empty) return nullptr;
+            pos = (pos + swiss::group_width) & (capacity_ - 1);
         }
-
-        return nullptr;
     }
 
     bool del(const std::string& attr_name) {
-        // 空桶数组直接返回删除失败
-        if (buckets_.empty()) {
-            return false;
-        }
-
-        // 计算键的哈希值和桶索引
-        const size_t hash = hash_string(attr_name);
-        const size_t bucket_idx = getBucketIndex(hash);
-        if (bucket_idx >= buckets_.size()) {
-            return false;
+        Node* node = find(attr_name);
+        if (!node) return false;
+
+        // 向后移位删除: 把后续簇中可以前移的元素移入空洞, 保证线性探测链不断开
+        const size_t mask = capacity_ - 1;
+        size_t hole = static_cast<size_t>(node - slots_);
+        node->~Node();
+        size_t next = hole;
+        while (true) {
+            next = (next + 1) & mask;
+            if (!is_full(next)) break;
+            const size_t ideal = home(slots_[next].hash);
+            // ideal不在(hole, next]之间时, 该元素可以移入hole
+            const bool movable = hole <= next
+                ? (ideal <= hole || ideal > next)
+                : (ideal <= hole && ideal > next);
+            if (!movable) continue;
+            new (slots_ + hole) Node(std::move(slots_[next]));
+            slots_[next].~Node();
+            set_ctrl(hole, ctrl_[next]);
+            hole = next;
         }
+        set_ctrl(hole, swiss::ctrl_empty);
+        elem_count_--;
+        return true;
+    }
 
-        // 遍历链表查找目标节点（需要前驱节点指针）
-        std::shared_ptr<Node> prev = nullptr;
-        std::shared_ptr<Node> current = buckets_[bucket_idx];
-
-        while (current != nullptr) {
-            // 哈希值+键双重校验（避免哈希碰撞）
-            if (current->hash == hash && current->key == attr_name) {
-                // 要删除的是头节点
-                if (prev == nullptr) {
-                    buckets_[bucket_idx] = current->next;
-                }
-                // 要删除的是中间/尾节点
-                else {
-                    prev->next = current->next;
-                }
-
-                // 释放当前节点（shared_ptr自动管理，断开链接后计数减1）
-                current.reset();
-                elem_count_--; // 减少元素计数
-                return true;   // 删除成功
-            }
-
-            prev = current;
-            current = current->next;
+    // 按槽位顺序遍历所有键值对
+    template <typename F>
+    void for_each(F&& f) const {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (is_full(i)) f(slots_[i].key, slots_[i].value);
         }
-
-        // 遍历完未找到对应键，删除失败
-        return false;
     }
 
     // 转换为字符串（需T支持to_string()成员函数）
     [[nodiscard]] std::string to_string() const {
         std::stringstream ss;
         ss << "{ ";
-
         size_t current_idx = 0;
-        size_t total_count = this->elem_count_; // 直接用已统计的数量，无需遍历
-
-        for (const auto& bucket_head : buckets_) {
-            auto current = bucket_head;
-            while (current != nullptr) {
-                ss << current->key << ": ";
-                if constexpr (std::is_pointer_v<VT>) {
-                    ss << static_cast<void*>(current->value);
-                } else {
-                    ss << current->value.to_string();
-                }
-                if (current_idx < total_count - 1) {
-                    ss << ", ";
-                }
-                current = current->next;
-                current_idx++;
+        for_each([&](const std::string& key, const VT& value) {
+            ss << key << ": ";
+            if constexpr (std::is_pointer_v<VT>) {
+                ss << static_cast<void*>(value);
+            } else {
+                ss << value.to_string();
             }
-        }
-
+            if (current_idx < elem_count_ - 1) {
+                ss << ", ";
+            }
+            current_idx++;
+        });
         ss << " }";
         return ss.str();
     }
@@ -248,83 +359,12 @@ public:
     // 转换为键值对vector
     [[nodiscard]] std::vector<std::pair<std::string, VT>> to_vector() const {
         std::vector<std::pair<std::string, VT>> vec;
-        for (const auto& bucket_head : buckets_) {
-            auto current = bucket_head;
-            while (current != nullptr) {
-                vec.emplace_back(current->key, current->value);
-                current = current->next;
-            }
-        }
+        vec.reserve(elem_count_);
+        for_each([&vec](const std::string& key, const VT& value) {
+            vec.emplace_back(key, value);
+        });
         return vec;
     }
-
-    // 深拷贝构造函数
-    HashMap(const HashMap& other)
-        : load_factor_(other.load_factor_) {
-        // 获取源HashMap的所有键值对
-        auto all_kv = other.to_vector();
-        // 计算初始桶大小
-        size_t init_size = 16;
-        while (init_size < (all_kv.size() / load_factor_)) {
-            init_size *= 2;
-        }
-        buckets_.resize(init_size, nullptr);
-
-        // 插入所有键值对（深拷贝）
-        for (auto& [key, val] : all_kv) {
-            this->insert(key, val);
-        }
-        this->elem_count_ = other.elem_count_;
-    }
-
-    HashMap(HashMap&& other) noexcept
-    : buckets_(std::move(other.buckets_)),
-      elem_count_(other.elem_count_),
-      load_factor_(other.load_factor_) {
-        other.elem_count_ = 0; // 置空原对象计数
-        other.buckets_.clear(); // 置空原对象桶数组
-    }
-
-    HashMap& operator=(const HashMap& other) {
-        if (this == &other) return *this;
-
-        buckets_.clear();
-        elem_count_ = 0; // 重置计数
-
-        auto all_kv = other.to_vector();
-        size_t init_size = 16;
-        while (init_size < (all_kv.size() / load_factor_)) {
-            init_size *= 2;
-        }
-        buckets_.resize(init_size, nullptr);
-
-        // 修复：手动计数，避免insert自动递增的误差
-        for (auto& [key, val] : all_kv) {
-            this->insert(key, val);
-        }
-        this->elem_count_ = all_kv.size(); // 直接赋值正确的数量
-
-        return *this;
-    }
-
-    // 修复移动赋值运算符
-    HashMap& operator=(HashMap&& other) noexcept {
-        if (this == &other) return *this; // 自赋值检查
-
-        // 释放当前资源
-        buckets_.clear();
-        elem_count_ = 0;
-
-        // 转移其他对象的资源（删除 load_factor_ = other.load_factor_）
-        buckets_ = std::move(other.buckets_);
-        elem_count_ = other.elem_count_;
-
-        // 置空原对象
-        other.elem_count_ = 0;
-        other.buckets_.clear();
-
-        return *this;
-    }
 };
 
-} // namespace dep
\ No newline at end of file
+} // namespace dep
@@ -12,7 +12,7 @@ Object* bool_call(Object* self, const List* args) {
 }
 
 Object* bool_str(Object* self, const List* args) {
-    const auto s = dynamic_cast<Bool*>(self);
+    const auto s = dyn<Bool>(self);
     return new String(s->val ? "True" : "False");
 }
 
@@ -21,8 +21,8 @@ Object* bool_str(Object* self, const List* args) {
 Object* bool_eq(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_bool = dynamic_cast<Bool*>(self);
-    auto another_bool = dynamic_cast<Bool*>(args->val[0]);
+    auto self_bool = dyn<Bool>(self);
+    auto another_bool = dyn<Bool>(args->val[0]);
     if (!another_bool)
         throw NativeFuncError("TypeError", "Bool.eq only supports Bool type argument");
     
@@ -31,7 +31,7 @@ Object* bool_eq(Object* self, const List* args) {
 
 // Bool.__hash__
 Object* bool_hash(Object* self, const List* args) {
-    auto self_bool = dynamic_cast<Bool*>(self);
+    auto self_bool = dyn<Bool>(self);
     if (self_bool->val == true) {
         return kiz::Vm::small_int_pool[1];
     }
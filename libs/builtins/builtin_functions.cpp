@@ -1,4 +1,5 @@
 #include "include/builtin_functions.hpp"
+#include "include/builtin_methods.hpp"
 
 #include <chrono>
 #include <cstdint>
@@ -9,9 +10,9 @@
 
 namespace builtin {
 
-model::Object* print(model::Object* self, const model::List* args) {
+model::Object* print(model::Object* self, const std::span<model::Object* const> args) {
     dep::UTF8String text;
-    for (auto arg : args->val) {
+    for (auto arg : args) {
         text += dep::UTF8String(kiz::Vm::obj_to_str(arg)) + " ";
     }
     std::cout << text << std::endl;
@@ -81,8 +82,9 @@ Built-in Objects:
 
 model::Object* breakpoint(model::Object* self, const model::List* args) {
     size_t i = 0;
-    for (auto& frame: kiz::Vm::call_stack) {
-        std::cout << "Frame [" << i << "] " << frame->name << "\n";
+    for (auto& frame_slot: kiz::Vm::call_stack) {
+        const auto frame = &frame_slot;
+        std::cout << "Frame [" << i << "] " << kiz::Vm::frame_name(frame) << "\n";
         std::cout << "=================================" << "\n";
         std::cout << "Owner: " << kiz::Vm::obj_to_debug_str(frame->owner) << "\n";
         std::cout << "Pc: " << frame->pc << "\n";
@@ -157,54 +159,17 @@ model::Object* cmd(model::Object* self, const model::List* args) {
     return model::load_nil();
 }
 
-model::Object* now(model::Object* self, const model::List* args) {
+model::Object* now(model::Object* self, std::span<model::Object* const> args) {
     auto now =
         std::chrono::high_resolution_clock::now()
         .time_since_epoch();
     int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
-    return new model::Int( dep::BigInt(std::to_string(time)) );
+    return model::make_int_value(time);
 }
 
+// range与Range(...)相同, 返回惰性的Range对象
 model::Object* range(model::Object* self, const model::List* args) {
-    auto arg_vector = args->val;
-    std::vector<model::Object*> range_vector;
-    dep::BigInt start_int = 0;
-    dep::BigInt step_int = 1;
-    dep::BigInt end_int = 1;
-
-    if (arg_vector.size() == 1) {
-        auto end_obj = arg_vector[0];
-        auto end_int_obj = model::cast_to_int(end_obj);
-        end_int = end_int_obj->val;
-    }
-    else if (arg_vector.size() == 2) {
-        auto start_obj = arg_vector[0];
-        auto start_int_obj = model::cast_to_int(start_obj);
-        start_int = start_int_obj->val;
-
-        auto end_obj = arg_vector[1];
-        auto end_int_obj = model::cast_to_int(end_obj);
-        end_int = end_int_obj->val;
-    }
-    else if (arg_vector.size() == 3) {
-        auto start_obj = arg_vector[0];
-        auto start_int_obj = model::cast_to_int(start_obj);
-        start_int = start_int_obj->val;
-
-        auto step_obj = arg_vector[1];
-        auto step_int_obj = model::cast_to_int(step_obj);
-        step_int = step_int_obj->val;
-
-        auto end_obj = arg_vector[2];
-        auto end_int_obj = model::cast_to_int(end_obj);
-        end_int = end_int_obj->val;
-    } else kiz::Vm::assert_argc({1,2,3}, args);
-
-    for (dep::BigInt i = start_int; i < end_int; i+=step_int) {
-        auto i_obj = new model::Int(i);
-        range_vector.emplace_back(i_obj);
-    }
-    return new model::List(range_vector);
+    return model::range_call(model::based_range, args);
 }
 
 model::Object* setattr(model::Object* self, const model::List* args) {
@@ -228,30 +193,19 @@ model::Object* getattr(model::Object* self, const model::List* args) {
         if (arg_vector.size() == 3) {
             default_value = arg_vector[2];
         }
-        try {
-            return kiz::Vm::get_attr(obj, model::cast_to_str(attr_name)->val);
-        } catch (...) {
-            return default_value;
-        }
+        const auto value = kiz::Vm::try_get_attr(obj, model::cast_to_str(attr_name)->val);
+        return value ? value : default_value;
     }
     if (arg_vector.size() == 4) {
         model::Object* current_only = arg_vector[0];
         obj = arg_vector[1];
         attr_name = arg_vector[2];
         default_value = arg_vector[3];
-        if (kiz::Vm::is_true(current_only)) {
-            if (const auto value =
-                obj->attrs.find(model::cast_to_str(attr_name)->val)
-            ) return value->value;
-            return default_value;
-        }
-
-        try {
-            return kiz::Vm::get_attr(obj, model::cast_to_str(attr_name)->val);
-        } catch (...) {
-            return default_value;
-        }
-
+        const auto& name = model::cast_to_str(attr_name)->val;
+        const auto value = kiz::Vm::is_true(current_only)
+            ? kiz::Vm::try_get_attr_current(obj, name)
+            : kiz::Vm::try_get_attr(obj, name);
+        return value ? value : default_value;
     }
     kiz::Vm::assert_argc({2,3,4}, args);
 }
@@ -262,7 +216,7 @@ model::Object* delattr(model::Object* self, const model::List* args) {
 
     model::Object* obj = arg_vector[0];
     model::Object* attr_name = arg_vector[1];
-    obj->attrs.del(model::cast_to_str(attr_name)->val);
+    obj->attrs_del(model::cast_to_str(attr_name)->val);
     return model::load_nil();
 }
 
@@ -274,29 +228,17 @@ model::Object* hasattr(model::Object* self, const model::List* args) {
         obj = arg_vector[0];
         attr_name = arg_vector[1];
 
-        try {
-            kiz::Vm::get_attr(obj, model::cast_to_str(attr_name)->val);
-            return model::load_true();
-        } catch (...) {
-            return model::load_false();
-        }
+        return model::load_bool(kiz::Vm::try_get_attr(obj, model::cast_to_str(attr_name)->val) != nullptr);
     }
     if (arg_vector.size() == 3) {
         model::Object* current_only = arg_vector[0];
         obj = arg_vector[1];
         attr_name = arg_vector[2];
-        if (kiz::Vm::is_true(current_only)) {
-            if (const auto value =
-                obj->attrs.find(model::cast_to_str(attr_name)->val)
-            ) return model::load_true();
-            return model::load_false();
-        }
-        try {
-            kiz::Vm::get_attr(obj, model::cast_to_str(attr_name)->val);
-            return model::load_true();
-        } catch (...) {
-            return model::load_false();
-        }
+        const auto& name = model::cast_to_str(attr_name)->val;
+        const auto value = kiz::Vm::is_true(current_only)
+            ? kiz::Vm::try_get_attr_current(obj, name)
+            : kiz::Vm::try_get_attr(obj, name);
+        return model::load_bool(value != nullptr);
     }
     kiz::Vm::assert_argc({2,3}, args);
 }
@@ -325,8 +267,9 @@ model::Object* create(model::Object* self, const model::List* args) {
     return new_obj;
 }
 
-model::Object* type_of_obj(model::Object* self, const model::List* args) {
+model::Object* type_of_obj(model::Object* self, const std::span<model::Object* const> args) {
     const auto for_check = get_one_arg(args);
+    if (model::is_imm_int(for_check)) return new model::String("Int");
     std::string type_str;
     switch (for_check->get_type()) {
         case model::Object::ObjectType::Bool: type_str = "Bool"; break;
@@ -339,9 +282,12 @@ model::Object* type_of_obj(model::Object* self, const model::List* args) {
         case model::Object::ObjectType::List: type_str = "List"; break;
         case model::Object::ObjectType::Dictionary: type_str = "Dict"; break;
         case model::Object::ObjectType::Decimal: type_str = "Decimal"; break;
+        case model::Object::ObjectType::Float: type_str = "Float"; break;
         case model::Object::ObjectType::CodeObject: type_str = "__CodeObject"; break;
         case model::Object::ObjectType::NativeFunction: type_str = "NFunc"; break;
         case model::Object::ObjectType::Module: type_str = "Module"; break;
+        case model::Object::ObjectType::FileHandle: type_str = "FileHandle"; break;
+        case model::Object::ObjectType::Range: type_str = "Range"; break;
         default: type_str = "<Unknown>"; break;
     }
     return new model::String(type_str);
@@ -355,14 +301,12 @@ model::Object* debug_str(model::Object* self, const model::List* args) {
 
 model::Object* attr(model::Object* self, const model::List* args) {
     auto obj = get_one_arg(args);
-    std::vector<std::pair<dep::BigInt, std::pair<model::Object*, model::Object*>>> elem_list;
-    for (auto& [name, obj]: obj->attrs.to_vector()) {
-        obj->make_ref();
-        elem_list.emplace_back(dep::hash_string(name),
-            std::pair {new model::String(name), obj}
-        );
-    }
-    return new model::Dictionary(dep::Dict(elem_list));
+    auto dict = new model::Dictionary();
+    dict->val.reserve(obj->attrs.size());
+    obj->attrs.for_each([dict](const std::string& name, model::Object* value) {
+        dict->insert(new model::String(name), value);
+    });
+    return dict;
 }
 
 model::Object* sleep(model::Object* self, const model::List* args) {
@@ -11,17 +11,25 @@ Object* decimal_call(Object* self, const List* args) {
     dep::Decimal val(0);
 
     // 从String初始化（如 "123.45", "-67.89e2"）
-    if (auto s = dynamic_cast<String*>(a)) {
+    if (auto s = dyn<String>(a)) {
         val = dep::Decimal(s->val);
     }
     // 从Int初始化
-    else if (auto i = dynamic_cast<Int*>(a)) {
+    else if (auto i = dyn<Int>(a)) {
         val = dep::Decimal(i->val);
     }
     // 从Decimal初始化（拷贝）
-    else if (auto d = dynamic_cast<Decimal*>(a)) {
+    else if (auto d = dyn<Decimal>(a)) {
         val = d->val;
     }
+    // 从Float初始化: 取能往返还原该double的最短十进制表示
+    else if (auto f = dyn<Float>(a)) {
+        if (!std::isfinite(f->val))
+            throw NativeFuncError("CalculateError", "cannot convert inf or nan to Decimal");
+        char buf[32];
+        const auto res = std::to_chars(buf, buf + sizeof(buf), f->val);
+        val = dep::Decimal(std::string(buf, res.ptr));
+    }
     // 假值（Nil/Bool(false)）初始化为0
     else if (!kiz::Vm::is_true(a)) {
         val = dep::Decimal(0);
@@ -32,8 +40,7 @@ Object* decimal_call(Object* self, const List* args) {
 
 // Decimal.__bool__：非零判断（0为false，其余为true）
 Object* decimal_bool(Object* self, const List* args) {
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
     // 0的Decimal（mantissa=0，exponent=0）返回false
     return load_bool(!(self_dec->val == dep::Decimal(0)));
 }
@@ -42,16 +49,15 @@ Object* decimal_bool(Object* self, const List* args) {
 Object* decimal_add(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
 
     // 与Int相加
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         dep::Decimal res = self_dec->val + another_int->val;
         return new Decimal(res);
     }
     // 与Decimal相加
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = dyn<Decimal>(args->val[0])) {
         dep::Decimal res = self_dec->val + another_dec->val;
         return new Decimal(res);
     }
@@ -63,16 +69,15 @@ Object* decimal_add(Object* self, const List* args) {
 Object* decimal_sub(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
 
     // 与Int相减
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         dep::Decimal res = self_dec->val - another_int->val;
         return new Decimal(res);
     }
     // 与Decimal相减
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = dyn<Decimal>(args->val[0])) {
         dep::Decimal res = self_dec->val - another_dec->val;
         return new Decimal(res);
     }
@@ -84,16 +89,15 @@ Object* decimal_sub(Object* self, const List* args) {
 Object* decimal_mul(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
 
     // 与Int相乘
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         dep::Decimal res = self_dec->val * another_int->val;
         return new Decimal(res);
     }
     // 与Decimal相乘
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = dyn<Decimal>(args->val[0])) {
         dep::Decimal res = self_dec->val * another_dec->val;
         return new Decimal(res);
     }
@@ -101,12 +105,11 @@ Object* decimal_mul(Object* self, const List* args) {
     throw NativeFuncError("TypeError", "Decimal.mul second arg need be Int or Decimal");
 }
 
-// Decimal.__div__：除法（self / args[0]），支持Int/Decimal（默认保留10位小数）
+// Decimal.__div__：除法（self / args[0]），支持Int/Decimal（按Decimal上下文保留小数位数并舍入）
 Object* decimal_div(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
 
     // 除数不能为0（提前检查）
     auto check_zero = [](const dep::Decimal& val) {
@@ -114,20 +117,20 @@ Object* decimal_div(Object* self, const List* args) {
     };
 
     // 与Int相除
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         dep::Decimal divisor(another_int->val);
         if(check_zero(divisor))
             throw NativeFuncError("CalculateError", "decimal_div: division by zero");
 
-        dep::Decimal res = self_dec->val.div(divisor, 10); // 保留10位小数
+        dep::Decimal res = self_dec->val / divisor;
         return new Decimal(res);
     }
     // 与Decimal相除
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = dyn<Decimal>(args->val[0])) {
         if(check_zero(another_dec->val) )
             throw NativeFuncError("CalculateError",  "decimal_div: division by zero");
 
-        dep::Decimal res = self_dec->val.div(another_dec->val, 10); // 保留10位小数
+        dep::Decimal res = self_dec->val / another_dec->val;
         return new Decimal(res);
     }
     // 仅允许Int/Decimal
@@ -138,11 +141,10 @@ Object* decimal_div(Object* self, const List* args) {
 Object* decimal_pow(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
 
     // 指数仅支持Int（非负）
-    auto exp_int = dynamic_cast<Int*>(args->val[0]);
+    auto exp_int = dyn<Int>(args->val[0]);
     if (!exp_int)
         throw NativeFuncError("TypeError", "Decimal.pow second arg need be Int");
 
@@ -157,16 +159,15 @@ Object* decimal_pow(Object* self, const List* args) {
 Object* decimal_eq(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
 
     // 与Int比较
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         dep::Decimal cmp_val(another_int->val);
         return load_bool(self_dec->val == cmp_val);
     }
     // 与Decimal比较
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = dyn<Decimal>(args->val[0])) {
         return load_bool(self_dec->val == another_dec->val);
     }
     // 仅允许Int/Decimal
@@ -177,16 +178,15 @@ Object* decimal_eq(Object* self, const List* args) {
 Object* decimal_lt(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
 
     // 与Int比较
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         dep::Decimal cmp_val(another_int->val);
         return load_bool(self_dec->val < cmp_val);
     }
     // 与Decimal比较
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = dyn<Decimal>(args->val[0])) {
         return load_bool(self_dec->val < another_dec->val);
     }
     // 仅允许Int/Decimal
@@ -198,16 +198,15 @@ Object* decimal_gt(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
 
     // 与Int比较
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         dep::Decimal cmp_val(another_int->val);
         return load_bool(self_dec->val > cmp_val);
     }
     // 与Decimal比较
-    if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    if (auto another_dec = dyn<Decimal>(args->val[0])) {
         return load_bool(self_dec->val > another_dec->val);
     }
     // 仅允许Int/Decimal
@@ -217,8 +216,7 @@ Object* decimal_gt(Object* self, const List* args) {
 // Decimal.__neg__：取反操作(-self)
 Object* decimal_neg(Object* self, const List* args) {
     // 确保调用者是Decimal对象
-    auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    auto self_dec = as<Decimal>(self);
 
     // 对Decimal值取反（0 - self_val 或直接用重载的-运算符）
     dep::Decimal neg_val = dep::Decimal(dep::BigInt(0)) - self_dec->val;
@@ -228,8 +226,7 @@ Object* decimal_neg(Object* self, const List* args) {
 
 // Decimal.__hash__
 Object* decimal_hash(Object* self, const List* args) {
-    const auto self_dec = dynamic_cast<Decimal*>(self);
-    assert(self_dec != nullptr);
+    const auto self_dec = as<Decimal>(self);
     return new Int(self_dec->val.hash());
 }
 
@@ -238,7 +235,7 @@ Object* decimal_hash(Object* self, const List* args) {
 Object* decimal_limit_div(Object* self, const List* args) {
     kiz::Vm::assert_argc(2, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = dyn<Decimal>(self);
 
     // 解析保留小数位数（转为int，避免BigInt越界）
     const auto n_obj = cast_to_int(args->val[1]);
@@ -250,11 +247,11 @@ Object* decimal_limit_div(Object* self, const List* args) {
 
     dep::Decimal divisor;
     // 处理除数为Int
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         divisor = dep::Decimal(another_int->val);
     }
     // 处理除数为Decimal
-    else if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    else if (auto another_dec = dyn<Decimal>(args->val[0])) {
         divisor = another_dec->val;
     }
     else {
@@ -275,7 +272,7 @@ Object* decimal_limit_div(Object* self, const List* args) {
 Object* decimal_approx(Object* self, const List* args) {
     kiz::Vm::assert_argc(2, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = dyn<Decimal>(self);
 
     // 解析保留小数位数
     const auto n_obj = cast_to_int(args->val[1]);
@@ -290,10 +287,10 @@ Object* decimal_approx(Object* self, const List* args) {
 
     // 处理要比较的数
     dep::Decimal other_dec;
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         other_dec = dep::Decimal(another_int->val);
     }
-    else if (auto another_dec_obj = dynamic_cast<Decimal*>(args->val[0])) {
+    else if (auto another_dec_obj = dyn<Decimal>(args->val[0])) {
         other_dec = another_dec_obj->val;
     }
     else {
@@ -310,7 +307,7 @@ Object* decimal_approx(Object* self, const List* args) {
 Object* decimal_round_div(Object* self, const List* args) {
     kiz::Vm::assert_argc(2, args);
 
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = dyn<Decimal>(self);
 
     // 解析保留小数位数
     const auto n_obj = cast_to_int(args->val[1]);
@@ -325,11 +322,11 @@ Object* decimal_round_div(Object* self, const List* args) {
 
     dep::Decimal divisor;
     // 处理除数为Int
-    if (auto another_int = dynamic_cast<Int*>(args->val[0])) {
+    if (auto another_int = dyn<Int>(args->val[0])) {
         divisor = dep::Decimal(another_int->val);
     }
     // 处理除数为Decimal
-    else if (auto another_dec = dynamic_cast<Decimal*>(args->val[0])) {
+    else if (auto another_dec = dyn<Decimal>(args->val[0])) {
         divisor = another_dec->val;
     }
     else {
@@ -346,8 +343,57 @@ Object* decimal_round_div(Object* self, const List* args) {
     return new Decimal(res);
 }
 
+// Decimal.round：按上下文的舍入模式保留args[0]位小数
+Object* decimal_round(Object* self, const List* args) {
+    kiz::Vm::assert_argc(1, args);
+
+    const auto self_dec = dyn<Decimal>(self);
+    if (!self_dec)
+        throw NativeFuncError("TypeError", "Decimal.round need be called on a Decimal");
+
+    const auto n_obj = cast_to_int(args->val[0]);
+    if (n_obj->val < dep::BigInt(0))
+        throw NativeFuncError("CalculateError", "decimal_round: decimal places must be non-negative");
+    if (n_obj->val >= dep::BigInt(1000))
+        throw NativeFuncError("CalculateError", "decimal_round: decimal places too large (max 999)");
+
+    const int n = static_cast<int>(n_obj->val.to_unsigned_long_long());
+    return new Decimal(self_dec->val.quantize(n, dep::decimal_context().rounding));
+}
+
+// Decimal.set_context：设置除法保留的小数位数args[0]和舍入模式args[1]
+// 舍入模式: "down" "half_up" "half_even" "up" "floor" "ceiling"
+Object* decimal_set_context(Object* self, const List* args) {
+    kiz::Vm::assert_argc(2, args);
+
+    const auto n_obj = cast_to_int(args->val[0]);
+    if (n_obj->val < dep::BigInt(0))
+        throw NativeFuncError("CalculateError", "decimal_set_context: precision must be non-negative");
+    if (n_obj->val >= dep::BigInt(1000))
+        throw NativeFuncError("CalculateError", "decimal_set_context: precision too large (max 999)");
+
+    dep::Rounding rounding;
+    const auto mode_obj = cast_to_str(args->val[1]);
+    if (!dep::parse_rounding(mode_obj->val, rounding))
+        throw NativeFuncError("CalculateError", std::format("decimal_set_context: unknown rounding mode '{}'", mode_obj->val));
+
+    auto& ctx = dep::decimal_context();
+    ctx.precision = static_cast<int>(n_obj->val.to_unsigned_long_long());
+    ctx.rounding = rounding;
+    return load_nil();
+}
+
+// Decimal.get_context：返回[小数位数, 舍入模式]
+Object* decimal_get_context(Object* self, const List* args) {
+    const auto& ctx = dep::decimal_context();
+    return new List({
+        new Int(dep::BigInt(static_cast<size_t>(ctx.precision))),
+        new String(dep::rounding_name(ctx.rounding))
+    });
+}
+
 Object* decimal_str(Object* self, const List* args) {
-    const auto self_dec = dynamic_cast<Decimal*>(self);
+    const auto self_dec = dyn<Decimal>(self);
     return new String(self_dec->val.to_string());
 }
 
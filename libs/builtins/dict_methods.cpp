@@ -3,63 +3,84 @@
 
 namespace model {
 
-dep::BigInt hash_object(Object* key_obj) {
-    // hash对象
-    kiz::Vm::call_method(key_obj, "__hash__", {});
+namespace {
 
-    const auto result = kiz::Vm::get_and_pop_stack_top();
+// __hash__返回的Int折叠为机器字: int64_t范围内直接取值, 否则对十进制表示求哈希
+size_t fold_hash(const dep::BigInt& val) {
+    int64_t v;
+    if (val.try_to_int64(v)) return static_cast<size_t>(v);
+    return std::hash<std::string>()(val.to_string());
+}
+
+}  // namespace
 
-    const auto result_int = dynamic_cast<Int*>(result.get());
+size_t hash_key(Object* key) {
+    switch (key->get_type()) {
+        case Object::ObjectType::String:
+            return dep::hash_string(static_cast<String*>(key)->val);
+        case Object::ObjectType::Int:
+            return fold_hash(static_cast<Int*>(key)->val);
+        default:
+            break;
+    }
+
+    // hash对象
+    kiz::Vm::call_magic(key, Magic::Hash, {});
+    const auto result = kiz::Vm::get_and_pop_stack_top();
+    const auto result_int = dyn<Int>(result.get());
     if (!result_int)
         throw NativeFuncError("TypeError", "Object's hash method return a value which type isn't Int");
-    dep::BigInt key_hash_val = result_int->val;
-    return key_hash_val;
+    return fold_hash(result_int->val);
+}
+
+bool key_equal(Object* a, Object* b) {
+    if (a == b) return true;
+    const auto a_type = a->get_type();
+    const auto b_type = b->get_type();
+    if (a_type == Object::ObjectType::String and b_type == Object::ObjectType::String)
+        return static_cast<String*>(a)->val == static_cast<String*>(b)->val;
+    if (a_type == Object::ObjectType::Int and b_type == Object::ObjectType::Int)
+        return static_cast<Int*>(a)->val == static_cast<Int*>(b)->val;
+    // 内置类型的__eq__不接受其他类型的参数, 类型不同的内置值必不相等
+    if (a_type != b_type and a_type != Object::ObjectType::Object and b_type != Object::ObjectType::Object)
+        return false;
+
+    kiz::Vm::call_magic(a, Magic::Eq, {b});
+    const auto result = kiz::Vm::get_and_pop_stack_top();
+    return kiz::Vm::is_true(result.get());
 }
 
 // Dictionary.__add__
 Object* dict_add(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    assert(self_dict != nullptr);
+    auto self_dict = as<Dictionary>(self);
     
-    auto another_dict = dynamic_cast<Dictionary*>(args->val[0]);
+    auto another_dict = dyn<Dictionary>(args->val[0]);
     if (! another_dict)
         throw NativeFuncError("TypeError", "Dict.add first argument must be Dict type");
 
-    auto self_dict_to_vec = self_dict->val.to_vector();
-    auto another_dict_to_vec = another_dict->val.to_vector();
-
-    self_dict_to_vec.insert(
-        self_dict_to_vec.end(),
-        another_dict_to_vec.begin(),
-        another_dict_to_vec.end()
-    );
-    
-    auto new_dict = new Dictionary(dep::Dict(
-        self_dict_to_vec
-    ));
+    auto new_dict = new Dictionary();
+    new_dict->val.reserve(self_dict->val.size() + another_dict->val.size());
+    // 条目已缓存哈希值, 合并时无需重新计算; 插入时键的__eq__可能修改源字典, 遍历固定的存储
+    for (const auto dict : {self_dict, another_dict}) {
+        const DictItems::Pin pinned(dict->val);
+        pinned.get().for_each([&](const size_t hash, const Dictionary::KeyValue& kv) {
+            new_dict->insert_hashed(kv.first, kv.second, hash);
+        });
+    }
     new_dict->make_ref();
     
     return new_dict;
 };
 
-// Dictionary.contains：判断是否包含指定键（key: String），返回Bool
+// Dictionary.contains：判断是否包含指定键，返回Bool
 Object* dict_contains(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    assert(self_dict != nullptr);
+    auto self_dict = as<Dictionary>(self);
     
-    // 键
-    auto key_obj = args->val[0];
-    dep::BigInt key_hash_val = hash_object(key_obj);
-
-    auto found_pair_it = self_dict->val.find(
-        key_hash_val
-    );
-
-    if (found_pair_it) {
+    if (self_dict->find(args->val[0])) {
         return load_true();
     }
     return load_false();
@@ -67,27 +88,17 @@ Object* dict_contains(Object* self, const List* args) {
 
 Object* dict_setitem(Object* self, const List* args) {
     kiz::Vm::assert_argc(2, args);
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    auto key_obj = args->val[0];
-    auto value_obj = args->val[1];
-    dep::BigInt key_hash_val = hash_object(key_obj);
-
-    self_dict->val.insert(
-        key_hash_val,
-        std::pair{key_obj, value_obj}
-    );
+    auto self_dict = dyn<Dictionary>(self);
+    self_dict->insert(args->val[0], args->val[1]);
     return load_nil();
 }
 
 Object* dict_getitem(Object* self, const List* args) {
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+    auto self_dict = dyn<Dictionary>(self);
     auto key_obj = builtin::get_one_arg(args);
 
-    dep::BigInt key_hash_val = hash_object(key_obj);
-
-    auto found_pair_it = self_dict->val.find(key_hash_val);
-    if (found_pair_it) {
-        return found_pair_it->value.second;
+    if (const auto entry = self_dict->find(key_obj)) {
+        return entry->value.second;
     }
 
     throw NativeFuncError("KeyError",
@@ -97,33 +108,27 @@ Object* dict_getitem(Object* self, const List* args) {
 
 
 Object* dict_str(Object* self, const List* args) {
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+    auto self_dict = dyn<Dictionary>(self);
     std::string result = "{";
-    auto kv_list = self_dict->val.to_vector();
-    size_t i = 0;
-    for (auto& kv_pair : kv_list | std::views::values) {
-        result += kiz::Vm::obj_to_str(kv_pair.first) + ": " + kiz::Vm::obj_to_str(kv_pair.second);
-        if (i != kv_list.size() - 1) {
-            result += ", ";
-        }
-        ++i;
-    }
+    bool first = true;
+    self_dict->val.for_each([&](size_t, const Dictionary::KeyValue& kv) {
+        if (!first) result += ", ";
+        result += kiz::Vm::obj_to_str(kv.first) + ": " + kiz::Vm::obj_to_str(kv.second);
+        first = false;
+    });
     result += "}";
     return new String(result);
 }
 
 Object* dict_dstr(Object* self, const List* args) {
-    auto self_dict = dynamic_cast<Dictionary*>(self);
+    auto self_dict = dyn<Dictionary>(self);
     std::string result = "{";
-    auto kv_list = self_dict->val.to_vector();
-    size_t i = 0;
-    for (auto& kv_pair : kv_list | std::views::values) {
-        result += kiz::Vm::obj_to_debug_str(kv_pair.first) + ": " + kiz::Vm::obj_to_debug_str(kv_pair.second);
-        if (i != kv_list.size() - 1) {
-            result += ", ";
-        }
-        ++i;
-    }
+    bool first = true;
+    self_dict->val.for_each([&](size_t, const Dictionary::KeyValue& kv) {
+        if (!first) result += ", ";
+        result += kiz::Vm::obj_to_debug_str(kv.first) + ": " + kiz::Vm::obj_to_debug_str(kv.second);
+        first = false;
+    });
     result += "}";
     return new String(result);
 }
@@ -131,39 +136,18 @@ Object* dict_dstr(Object* self, const List* args) {
 Object* dict_foreach(Object* self, const List* args) {
     auto func_obj = builtin::get_one_arg(args);
 
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    assert(self_dict != nullptr);
+    auto self_dict = as<Dictionary>(self);
 
-    dep::BigInt idx = 0;
-    for (auto pair : self_dict->val.to_vector() | std::views::values) {
-        kiz::Vm::call_function(func_obj, {pair.first, pair.second}, nullptr);
-        idx += 1;
+    // 回调可能修改字典, 先取出当前条目
+    for (const auto& kv : self_dict->val.to_vector() | std::views::values) {
+        kiz::Vm::call_function(func_obj, {kv.first, kv.second}, nullptr);
     }
     return load_nil();
 }
 
-Object* dict_next(Object* self, const List* args) {
-    auto curr_idx_it = self->attrs.find("__current_index__");
-    if(!curr_idx_it)
-        throw NativeFuncError("TypeError", "Dict.next cannot find attribute '__current_index__' to get current item");
-
-    auto curr_idx = curr_idx_it->value;
-
-    auto index =  cast_to_int(curr_idx) ->val.to_unsigned_long_long();
-
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    if (index < self_dict->val.size()) {
-        auto res = self_dict->val.to_vector()[index].second.second;
-        self->attrs_insert("__current_index__", new Int(index+1));
-        return res;
-    }
-    self->attrs_insert("__current_index__", kiz::Vm::small_int_pool[0]);
-    return load_stop_iter_signal();
-}
-
-Object* dict_len(Object* self, const List* args) {
-    auto self_dict = dynamic_cast<Dictionary*>(self);
-    return new Int(self_dict->val.to_vector().size());
+Object* dict_len(Object* self, std::span<Object* const> args) {
+    auto self_dict = dyn<Dictionary>(self);
+    return make_int_value(static_cast<int64_t>(self_dict->val.size()));
 }
 
-}  // namespace model
\ No newline at end of file
+}  // namespace model
@@ -5,8 +5,7 @@ namespace model {
 Object* file_handle_flush(Object* self, const List* args) {
     kiz::Vm::assert_argc(0, args);
 
-    auto f_obj = dynamic_cast<FileHandle*>(self);
-    assert(f_obj);
+    auto f_obj = as<FileHandle>(self);
 
     if (f_obj->is_closed) {
         throw NativeFuncError("FileError", "Cannot flush closed file handle");
@@ -26,8 +25,7 @@ Object* file_handle_flush(Object* self, const List* args) {
 
 Object* file_handle_read(Object* self, const List* args) {
     kiz::Vm::assert_argc(0, args);
-    auto f_obj = dynamic_cast<FileHandle*>(self);
-    assert(f_obj);
+    auto f_obj = as<FileHandle>(self);
 
     if (f_obj->is_closed) {
         throw NativeFuncError("FileError", "Cannot read from closed file handle");
@@ -55,8 +53,7 @@ Object* file_handle_write(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
     // 类型转换并校验
-    auto f_obj = dynamic_cast<FileHandle*>(self);
-    assert(f_obj);
+    auto f_obj = as<FileHandle>(self);
 
     // 校验文件句柄状态
     if (f_obj->is_closed) {
@@ -80,8 +77,7 @@ Object* file_handle_write(Object* self, const List* args) {
 Object* file_handle_readline(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto f_obj = dynamic_cast<FileHandle*>(self);
-    assert(f_obj);
+    auto f_obj = as<FileHandle>(self);
 
     if (f_obj->is_closed) {
         throw NativeFuncError("FileError", "Cannot read from closed file handle");
@@ -120,8 +116,7 @@ Object* file_handle_close(Object* self, const List* args) {
     kiz::Vm::assert_argc(0, args);
 
     // 类型转换并校验
-    auto f_obj = dynamic_cast<FileHandle*>(self);
-    assert(f_obj);
+    auto f_obj = as<FileHandle>(self);
 
     if (f_obj->is_closed) {
         return load_nil();
@@ -0,0 +1,116 @@
+#include <cmath>
+
+#include "../../src/models/models.hpp"
+#include "../../src/vm/vm.hpp"
+#include "include/builtin_methods.hpp"
+#include "include/builtin_functions.hpp"
+
+namespace model {
+
+namespace {
+
+// 读取二元运算的右操作数(Float/Int), 其他类型抛出TypeError
+double float_operand(const List* args, const char* method) {
+    kiz::Vm::assert_argc(1, args);
+    double val;
+    if (!float_value_of(args->val[0], val))
+        throw NativeFuncError("TypeError", std::format("Float.{} second arg need be Float or Int", method));
+    return val;
+}
+
+double float_self(Object* self) {
+    const auto self_float = as<Float>(self);
+    return self_float->val;
+}
+
+}
+
+// Float.__call__：构造Float对象（支持字符串/Int/Float/Decimal初始化）
+Object* float_call(Object* self, const List* args) {
+    auto a = builtin::get_one_arg(args);
+    double val = 0.0;
+
+    // 从String初始化（如 "1.5", "-2e10", "inf", "nan"）
+    if (auto s = dyn<String>(a)) {
+        const char* begin = s->val.data();
+        const char* end = begin + s->val.size();
+        if (begin != end and *begin == '+') ++begin;
+        const auto [ptr, ec] = std::from_chars(begin, end, val);
+        if (ec != std::errc() or ptr != end or begin == end)
+            throw NativeFuncError("TypeError", "Cannot cast this string to Float");
+    }
+    // 从Decimal初始化: 取最接近十进制值的double
+    else if (auto d = dyn<Decimal>(a)) {
+        val = std::strtod(d->val.to_string().c_str(), nullptr);
+    }
+    // 从Int/Float初始化, 其余假值（Nil/Bool(false)）初始化为0
+    else if (!float_value_of(a, val) and kiz::Vm::is_true(a)) {
+        throw NativeFuncError("TypeError", "Float() arg need be Str, Int, Float or Decimal");
+    }
+
+    return new Float(val);
+}
+
+// Float.__bool__：非零判断（nan为true）
+Object* float_bool(Object* self, const List* args) {
+    return load_bool(float_self(self) != 0.0);
+}
+
+// 算术运算按IEEE-754语义: 除以0得到±inf或nan, 不抛出异常
+Object* float_add(Object* self, const List* args) {
+    return new Float(float_self(self) + float_operand(args, "add"));
+}
+
+Object* float_sub(Object* self, const List* args) {
+    return new Float(float_self(self) - float_operand(args, "sub"));
+}
+
+Object* float_mul(Object* self, const List* args) {
+    return new Float(float_self(self) * float_operand(args, "mul"));
+}
+
+Object* float_div(Object* self, const List* args) {
+    return new Float(float_self(self) / float_operand(args, "div"));
+}
+
+Object* float_pow(Object* self, const List* args) {
+    return new Float(std::pow(float_self(self), float_operand(args, "pow")));
+}
+
+// Float.__mod__：向下取整的余数, 余数与除数同号（-7.0 % 3.0 == 2.0, -7.0 % -3.0 == -1.0）
+// 注意与Int.__mod__不同: Int在被除数为负时的结果不是向下取整的余数（-7 % 3 == 1, -7 % -3 == -2）
+Object* float_mod(Object* self, const List* args) {
+    const double b = float_operand(args, "mod");
+    double r = std::fmod(float_self(self), b);
+    if (r != 0.0 and (r < 0) != (b < 0)) r += b;
+    return new Float(r);
+}
+
+Object* float_neg(Object* self, const List* args) {
+    return new Float(-float_self(self));
+}
+
+// 比较运算: nan与任何值(包括自身)都不相等也无大小关系
+Object* float_eq(Object* self, const List* args) {
+    return load_bool(float_self(self) == float_operand(args, "eq"));
+}
+
+Object* float_lt(Object* self, const List* args) {
+    return load_bool(float_self(self) < float_operand(args, "lt"));
+}
+
+Object* float_gt(Object* self, const List* args) {
+    return load_bool(float_self(self) > float_operand(args, "gt"));
+}
+
+// Float.__hash__：0.0与-0.0相等, 哈希也相同
+Object* float_hash(Object* self, const List* args) {
+    const double val = float_self(self);
+    return new Int(dep::BigInt(std::hash<double>()(val == 0.0 ? 0.0 : val)));
+}
+
+Object* float_str(Object* self, const List* args) {
+    return new String(float_to_string(float_self(self)));
+}
+
+}  // namespace model
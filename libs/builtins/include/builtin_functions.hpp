@@ -9,7 +9,18 @@ inline model::Object* get_one_arg(const model::List* args) {
     if (!args->val.empty()) {
         return args->val[0];
     }
+    // 参数为空时assert_argc总会抛出ArgCountError, 不会执行到这里
     kiz::Vm::assert_argc(1, args);
+    return nullptr;
+}
+
+inline model::Object* get_one_arg(const std::span<model::Object* const> args) {
+    if (!args.empty()) {
+        return args[0];
+    }
+    // 参数为空时assert_argc总会抛出ArgCountError, 不会执行到这里
+    kiz::Vm::assert_argc(1, args);
+    return nullptr;
 }
 
 inline model::Object* check_based_object_inner(
@@ -39,21 +50,21 @@ inline model::Object* check_based_object(model::Object* src_obj, model::Object*
 }
 
 // 内置函数
-model::Object* print(model::Object* self, const model::List* args);
+model::Object* print(model::Object* self, std::span<model::Object* const> args);
 model::Object* input(model::Object* self, const model::List* args);
 model::Object* ischild(model::Object* self, const model::List* args);
 model::Object* help(model::Object* self, const model::List* args);
 model::Object* breakpoint(model::Object* self, const model::List* args);
 model::Object* range(model::Object* self, const model::List* args);
 model::Object* cmd(model::Object* self, const model::List* args);
-model::Object* now(model::Object* self, const model::List* args);
+model::Object* now(model::Object* self, std::span<model::Object* const> args);
 model::Object* setattr(model::Object* self, const model::List* args);
 model::Object* getattr(model::Object* self, const model::List* args);
 model::Object* delattr(model::Object* self, const model::List* args);
 model::Object* hasattr(model::Object* self, const model::List* args);
 model::Object* get_refc(model::Object* self, const model::List* args);
 model::Object* create(model::Object* self, const model::List* args);
-model::Object* type_of_obj(model::Object* self, const model::List* args);
+model::Object* type_of_obj(model::Object* self, std::span<model::Object* const> args);
 model::Object* debug_str(model::Object* self, const model::List* args);
 model::Object* attr(model::Object* self, const model::List* args);
 model::Object* sleep(model::Object* self, const model::List* args);
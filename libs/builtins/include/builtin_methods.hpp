@@ -11,6 +11,14 @@ Object* object_eq(Object* self, const List* args);
 Object* object_setitem(Object* self, const List* args);
 Object* object_getitem(Object* self, const List* args);
 
+// 机器字整数运算核心(溢出时提升为BigInt), 供VM快速路径与Int方法共用
+Object* small_int_add(int64_t a, int64_t b);
+Object* small_int_sub(int64_t a, int64_t b);
+Object* small_int_mul(int64_t a, int64_t b);
+Object* small_int_mod(int64_t a, int64_t b);
+Object* small_int_neg(int64_t a);
+dep::BigInt float_to_bigint(double x);
+
 // Int 类型原生函数
 Object* int_add(Object* self, const List* args);
 Object* int_sub(Object* self, const List* args);
@@ -27,6 +35,22 @@ Object* int_call(Object* self, const List* args);
 Object* int_hash(Object* self, const List* args);
 Object* int_str(Object* self, const List* args);
 
+// Float 类型原生函数
+Object* float_call(Object* self, const List* args);
+Object* float_bool(Object* self, const List* args);
+Object* float_add(Object* self, const List* args);
+Object* float_sub(Object* self, const List* args);
+Object* float_mul(Object* self, const List* args);
+Object* float_div(Object* self, const List* args);
+Object* float_pow(Object* self, const List* args);
+Object* float_mod(Object* self, const List* args);
+Object* float_neg(Object* self, const List* args);
+Object* float_eq(Object* self, const List* args);
+Object* float_lt(Object* self, const List* args);
+Object* float_gt(Object* self, const List* args);
+Object* float_hash(Object* self, const List* args);
+Object* float_str(Object* self, const List* args);
+
 // Decimal类型原生函数
 Object* decimal_add(Object* self, const List* args);
 Object* decimal_sub(Object* self, const List* args);
@@ -44,6 +68,9 @@ Object* decimal_str(Object* self, const List* args);
 Object* decimal_limit_div(Object* self, const List* args);
 Object* decimal_round_div(Object* self, const List* args);
 Object* decimal_approx(Object* self, const List* args);
+Object* decimal_round(Object* self, const List* args);
+Object* decimal_set_context(Object* self, const List* args);
+Object* decimal_get_context(Object* self, const List* args);
 
 // Nil 类型原生函数
 Object* nil_eq(Object* self, const List* args);
@@ -64,7 +91,6 @@ Object* str_contains(Object* self, const List* args);
 Object* str_call(Object* self, const List* args);
 Object* str_bool(Object* self, const List* args);
 Object* str_hash(Object* self, const List* args);
-Object* str_next(Object* self, const List* args);
 Object* str_getitem(Object* self, const List* args);
 Object* str_str(Object* self, const List* args);
 Object* str_dstr(Object* self, const List* args);
@@ -73,7 +99,7 @@ Object* str_foreach(Object* self, const List* args);
 Object* str_count(Object* self, const List* args);
 Object* str_startswith(Object* self, const List* args);
 Object* str_endswith(Object* self, const List* args);
-Object* str_len(Object* self, const List* args);
+Object* str_len(Object* self, std::span<Object* const> args);
 Object* str_substr(Object* self, const List* args);
 Object* str_is_alpha(Object* self, const List* args);
 Object* str_is_digit(Object* self, const List* args);
@@ -90,8 +116,7 @@ Object* dict_getitem(Object* self, const List* args);
 Object* dict_str(Object* self, const List* args);
 Object* dict_dstr(Object* self, const List* args);
 Object* dict_foreach(Object* self, const List* args);
-Object* dict_next(Object* self, const List* args);
-Object* dict_len(Object* self, const List* args);
+Object* dict_len(Object* self, std::span<Object* const> args);
 
 // List 类型原生函数
 Object* list_eq(Object* self, const List* args);
@@ -99,14 +124,13 @@ Object* list_add(Object* self, const List* args);
 Object* list_mul(Object* self, const List* args);
 Object* list_call(Object* self, const List* args);
 Object* list_bool(Object* self, const List* args);
-Object* list_next(Object* self, const List* args);
 Object* list_setitem(Object* self, const List* args);
 Object* list_getitem(Object* self, const List* args);
 Object* list_str(Object* self, const List* args);
 Object* list_dstr(Object* self, const List* args);
 // 普通方法
 Object* list_contains(Object* self, const List* args);
-Object* list_append(Object* self, const List* args);
+Object* list_append(Object* self, std::span<Object* const> args);
 Object* list_foreach(Object* self, const List* args);
 Object* list_reverse(Object* self, const List* args);
 Object* list_extend(Object* self, const List* args);
@@ -115,7 +139,7 @@ Object* list_insert(Object* self, const List* args);
 Object* list_find(Object* self, const List* args);
 Object* list_map(Object* self, const List* args);
 Object* list_count(Object* self, const List* args);
-Object* list_len(Object* self, const List* args);
+Object* list_len(Object* self, std::span<Object* const> args);
 Object* list_filter(Object* self, const List* args);
 Object* list_join(Object* self, const List* args);
 
@@ -128,8 +152,14 @@ Object* file_handle_close(Object* self, const List* args);
 
 // Range类型
 Object* range_call(Object* self, const List* args);
-Object* range_next(Object* self, const List* args);
 Object* range_str(Object* self, const List* args);
+Object* range_len(Object* self, std::span<Object* const> args);
+Object* range_contains(Object* self, const List* args);
+Object* range_getitem(Object* self, const List* args);
+Object* range_bool(Object* self, const List* args);
+
+// Iterator类型
+Object* iterator_next(Object* self, const List* args);
 
 // Error类型
 Object* error_str(Object* self, const List* args);
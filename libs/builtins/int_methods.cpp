@@ -5,11 +5,102 @@
 
 namespace model {
 
+namespace {
+
+// 带溢出检查的int64运算, 溢出返回true
+bool add_overflow(const int64_t a, const int64_t b, int64_t& r) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(a, b, &r);
+#else
+    if ((b > 0 and a > INT64_MAX - b) or (b < 0 and a < INT64_MIN - b)) return true;
+    r = a + b;
+    return false;
+#endif
+}
+
+bool sub_overflow(const int64_t a, const int64_t b, int64_t& r) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_sub_overflow(a, b, &r);
+#else
+    if ((b < 0 and a > INT64_MAX + b) or (b > 0 and a < INT64_MIN + b)) return true;
+    r = a - b;
+    return false;
+#endif
+}
+
+bool mul_overflow(const int64_t a, const int64_t b, int64_t& r) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_mul_overflow(a, b, &r);
+#else
+    if (a == 0 or b == 0) {
+        r = 0;
+        return false;
+    }
+    const auto p = static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+    if ((a == -1 and b == INT64_MIN) or (b == -1 and a == INT64_MIN) or p / b != a) return true;
+    r = p;
+    return false;
+#endif
+}
+
+}
+
+// 机器字整数运算核心: 结果在立即数范围内时不分配对象, 溢出时提升为BigInt
+Object* small_int_add(const int64_t a, const int64_t b) {
+    int64_t r;
+    if (!add_overflow(a, b, r)) return make_int_value(r);
+    return new Int(dep::BigInt::from_int64(a) + dep::BigInt::from_int64(b));
+}
+
+Object* small_int_sub(const int64_t a, const int64_t b) {
+    int64_t r;
+    if (!sub_overflow(a, b, r)) return make_int_value(r);
+    return new Int(dep::BigInt::from_int64(a) - dep::BigInt::from_int64(b));
+}
+
+Object* small_int_mul(const int64_t a, const int64_t b) {
+    int64_t r;
+    if (!mul_overflow(a, b, r)) return make_int_value(r);
+    return new Int(dep::BigInt::from_int64(a) * dep::BigInt::from_int64(b));
+}
+
+Object* small_int_neg(const int64_t a) {
+    if (a == INT64_MIN) return new Int(dep::BigInt(0) - dep::BigInt::from_int64(a));
+    return make_int_value(-a);
+}
+
+// 与int_mod保持一致: 先按BigInt::operator%取余(余数与被除数同号), 再修正为与除数同号
+Object* small_int_mod(const int64_t a, const int64_t b) {
+    if (b == 0) throw NativeFuncError("CalculateError", "mod by zero");
+    const uint64_t a_abs = a < 0 ? 0 - static_cast<uint64_t>(a) : static_cast<uint64_t>(a);
+    const uint64_t b_abs = b < 0 ? 0 - static_cast<uint64_t>(b) : static_cast<uint64_t>(b);
+    const uint64_t r_abs = a_abs % b_abs;
+    if (r_abs == 0) return make_int_value(0);
+
+    // |r| < |b| <= 2^63, 以下运算均不会溢出
+    auto r = a < 0 ? static_cast<int64_t>(r_abs - b_abs) : static_cast<int64_t>(r_abs);
+    if ((a < 0) != (b < 0)) r += b;
+    return make_int_value(r);
+}
+
+// double向零截断为BigInt: |x| < 2^63时直接转换, 否则x = m * 2^e (m为53位整数)
+dep::BigInt float_to_bigint(const double x) {
+    if (!std::isfinite(x))
+        throw NativeFuncError("CalculateError", "cannot convert inf or nan to Int");
+    const double t = std::trunc(x);
+    if (std::fabs(t) < 9223372036854775808.0) return dep::BigInt::from_int64(static_cast<int64_t>(t));
+    int exp;
+    const double frac = std::frexp(std::fabs(t), &exp);
+    const auto mant = static_cast<int64_t>(std::ldexp(frac, 53));
+    dep::BigInt res = dep::BigInt::from_int64(mant) * dep::BigInt(2).pow(dep::BigInt(static_cast<size_t>(exp - 53)));
+    return t < 0 ? dep::BigInt(0) - res : res;
+}
+
 // Int.__call__
 Object* int_call(Object* self, const List* args) {
     auto a = builtin::get_one_arg(args);
     dep::BigInt val(0);
-    if (auto s = dynamic_cast<String*>(a)) {
+    if (auto s = dyn<String>(a)) {
         auto str = dep::UTF8String(s->val);
         bool is_digit = true;
         for (const auto& c : str) {
@@ -21,12 +112,16 @@ Object* int_call(Object* self, const List* args) {
             throw NativeFuncError("TypeError", "Cannot cast this string to Int");
         }
     }
-    if (auto i = dynamic_cast<Int*>(a)) {
+    if (auto i = dyn<Int>(a)) {
         val = dep::BigInt(i->val);
     }
-    if (auto i = dynamic_cast<Decimal*>(a)) {
+    if (auto i = dyn<Decimal>(a)) {
         val = dep::BigInt(i->val.integer_part());
     }
+    // 从Float初始化（向零截断）
+    else if (auto f = dyn<Float>(a)) {
+        val = float_to_bigint(f->val);
+    }
 
     else if (!kiz::Vm::is_true(a)) val = dep::BigInt(0);
     return new Int(val);
@@ -34,7 +129,7 @@ Object* int_call(Object* self, const List* args) {
 
 // Int.__bool__
 Object* int_bool(Object* self, const List* args) {
-    const auto self_int = dynamic_cast<Int*>(self);
+    const auto self_int = dyn<Int>(self);
     if (self_int->val == dep::BigInt(0)) {
         return load_false();
     }
@@ -45,68 +140,98 @@ Object* int_bool(Object* self, const List* args) {
 Object* int_add(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    const auto self_int = dynamic_cast<Int*>(self);
-    assert(self_int!=nullptr);
+    int64_t a, b;
+    if (int_value_of(self, a) and int_value_of(args->val[0], b)) {
+        return box_value(small_int_add(a, b));
+    }
+
+    const auto self_int = as<Int>(self);
 
     // 与Int相加
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = dyn<Int>(args->val[0]);
     if (another_int) {
         return new Int(self_int->val + another_int->val);
     }
     // 与Decimal相加（返回Decimal）
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = dyn<Decimal>(args->val[0]);
     if (another_dec) {
         dep::Decimal left_dec(self_int->val);
         return new Decimal(left_dec + another_dec->val);
     }
-    // 仅允许Int/Decimal
-    throw NativeFuncError("TypeError", "function Int.add second arg need be Int or Decimal");
+    // 与Float相加（返回Float）
+    if (auto another_float = dyn<Float>(args->val[0])) {
+        return new Float(self_int->val.to_double() + another_float->val);
+    }
+    // 仅允许Int/Decimal/Float
+    throw NativeFuncError("TypeError", "function Int.add second arg need be Int, Decimal or Float");
 };
 
 // Int.__sub__ 整数减法：self - args[0]（仅支持Int/Decimal）
 Object* int_sub(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto self_int = dynamic_cast<Int*>(self);
+    int64_t a, b;
+    if (int_value_of(self, a) and int_value_of(args->val[0], b)) {
+        return box_value(small_int_sub(a, b));
+    }
+
+    auto self_int = dyn<Int>(self);
     // 与Int相减
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = dyn<Int>(args->val[0]);
     if (another_int) {
         return new Int(self_int->val - another_int->val);
     }
     // 与Decimal相减（返回Decimal）
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = dyn<Decimal>(args->val[0]);
     if (another_dec) {
         dep::Decimal left_dec(self_int->val);
         return new Decimal(left_dec - another_dec->val);
     }
-    // 仅允许Int/Decimal
-    throw NativeFuncError("TypeError", "function Int.sub second arg need be Int or Decimal");
+    // 与Float相减（返回Float）
+    if (auto another_float = dyn<Float>(args->val[0])) {
+        return new Float(self_int->val.to_double() - another_float->val);
+    }
+    // 仅允许Int/Decimal/Float
+    throw NativeFuncError("TypeError", "function Int.sub second arg need be Int, Decimal or Float");
 };
 
 // Int.__mul__ 整数乘法：self * args[0]（仅支持Int/Decimal）
 Object* int_mul(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto self_int = dynamic_cast<Int*>(self);
+    int64_t a, b;
+    if (int_value_of(self, a) and int_value_of(args->val[0], b)) {
+        return box_value(small_int_mul(a, b));
+    }
+
+    auto self_int = dyn<Int>(self);
     // 与Int相乘
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = dyn<Int>(args->val[0]);
     if (another_int) {
         return new Int(self_int->val * another_int->val);
     }
     // 与Decimal相乘（返回Decimal）
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = dyn<Decimal>(args->val[0]);
     if (another_dec) {
         dep::Decimal left_dec(self_int->val);
         return new Decimal(left_dec * another_dec->val);
     }
-    // 仅允许Int/Decimal
-    throw NativeFuncError("TypeError", "function Int.mul second arg need be Int or Decimal");
+    // 与Float相乘（返回Float）
+    if (auto another_float = dyn<Float>(args->val[0])) {
+        return new Float(self_int->val.to_double() * another_float->val);
+    }
+    // 仅允许Int/Decimal/Float
+    throw NativeFuncError("TypeError", "function Int.mul second arg need be Int, Decimal or Float");
 };
 
 // Int.__neg__ 取反
 Object* int_neg(Object* self, const List* args) {
-    auto self_int = dynamic_cast<Int*>(self);
-    assert(self_int!=nullptr);
+    int64_t a;
+    if (int_value_of(self, a)) {
+        return box_value(small_int_neg(a));
+    }
+
+    auto self_int = as<Int>(self);
 
     auto new_int = dep::BigInt(0) - self_int->val;
     return new Int(new_int);
@@ -116,35 +241,42 @@ Object* int_neg(Object* self, const List* args) {
 Object* int_div(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto self_int = dynamic_cast<Int*>(self);
-    assert(self_int!=nullptr);
-    // 与Int相除（返回Decimal，保留10位小数）
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto self_int = as<Int>(self);
+    // 与Int相除（返回Decimal，按Decimal上下文保留小数位数并舍入）
+    auto another_int = dyn<Int>(args->val[0]);
     if (another_int) {
         if (another_int->val == 0) throw NativeFuncError("CalculateError", "divisor cannot be zero");
         dep::Decimal left_dec(self_int->val);
         dep::Decimal right_dec(another_int->val);
-        return new Decimal(left_dec.div(right_dec, 10));
+        return new Decimal(left_dec / right_dec);
     }
     // 与Decimal相除（返回Decimal）
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = dyn<Decimal>(args->val[0]);
     if (another_dec) {
         if(another_dec->val == dep::Decimal(0)) throw NativeFuncError("CalculateError", "divisor cannot be zero");
         dep::Decimal left_dec(self_int->val);
-        return new Decimal(left_dec.div(another_dec->val, 10));
+        return new Decimal(left_dec / another_dec->val);
     }
-    // 仅允许Int/Decimal
-    throw NativeFuncError("TypeError", "function Int.div second arg need be Int or Decimal");
+    // 与Float相除（返回Float）
+    if (auto another_float = dyn<Float>(args->val[0])) {
+        return new Float(self_int->val.to_double() / another_float->val);
+    }
+    // 仅允许Int/Decimal/Float
+    throw NativeFuncError("TypeError", "function Int.div second arg need be Int, Decimal or Float");
 };
 
 // Int.__pow__ 整数幂运算：self ^ args[0]（self的args[0]次方，仅支持Int指数）
 Object* int_pow(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto self_int = dynamic_cast<Int*>(self);
-    auto exp_int = dynamic_cast<Int*>(args->val[0]);
+    auto self_int = dyn<Int>(self);
+    // Float指数（返回Float）
+    if (auto exp_float = dyn<Float>(args->val[0])) {
+        return new Float(std::pow(self_int->val.to_double(), exp_float->val));
+    }
+    auto exp_int = dyn<Int>(args->val[0]);
     if (! exp_int)
-        throw NativeFuncError("TypeError", "function Int.pow second arg need be Int");
+        throw NativeFuncError("TypeError", "function Int.pow second arg need be Int or Float");
 
     // 指数非负时返回Int，负指数返回Decimal（扩展支持）
     if (exp_int->val.is_negative()) {
@@ -153,7 +285,7 @@ Object* int_pow(Object* self, const List* args) {
         dep::Decimal res = base_dec.pow(abs_exp);
         // 负指数：1 / res
         dep::Decimal one(1);
-        return new Decimal(one.div(res, 10));
+        return new Decimal(one / res);
     } else {
         return new Int(self_int->val.pow(exp_int->val));
     }
@@ -163,14 +295,19 @@ Object* int_pow(Object* self, const List* args) {
 Object* int_mod(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    int64_t a, b;
+    if (int_value_of(self, a) and int_value_of(args->val[0], b)) {
+        return box_value(small_int_mod(a, b));
+    }
+
+    auto another_int = dyn<Int>(args->val[0]);
     if (! another_int)
         throw NativeFuncError("TypeError", "function Int.mod second arg need be Int");
 
     if(another_int->val == dep::BigInt(0))
         throw NativeFuncError("CalculateError", "mod by zero");
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = dyn<Int>(self);
     dep::BigInt remainder = self_int->val % another_int->val;
     // 修正余数符号（确保与除数同号）
     if (remainder != dep::BigInt(0)
@@ -185,70 +322,82 @@ Object* int_mod(Object* self, const List* args) {
 Object* int_eq(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = dyn<Int>(self);
     // 与Int比较
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = dyn<Int>(args->val[0]);
     if (another_int) {
         return load_bool(self_int->val == another_int->val);
     }
     // 与Decimal比较
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = dyn<Decimal>(args->val[0]);
     if (another_dec) {
         dep::Decimal cmp_val(self_int->val);
         return load_bool(cmp_val == another_dec->val);
     }
-    // 仅允许Int/Decimal
-    throw NativeFuncError("TypeError", "function Int.eq second arg need be Int or Decimal");
+    // 与Float比较
+    if (auto another_float = dyn<Float>(args->val[0])) {
+        return load_bool(self_int->val.to_double() == another_float->val);
+    }
+    // 仅允许Int/Decimal/Float
+    throw NativeFuncError("TypeError", "function Int.eq second arg need be Int, Decimal or Float");
 };
 
 // Int.__lt__ 小于判断：self < args[0]（仅支持Int/Decimal）
 Object* int_lt(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = dyn<Int>(self);
     // 与Int比较
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = dyn<Int>(args->val[0]);
     if (another_int) {
         return load_bool(self_int->val < another_int->val);
     }
     // 与Decimal比较
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = dyn<Decimal>(args->val[0]);
     if (another_dec) {
         dep::Decimal cmp_val(self_int->val);
         return load_bool(cmp_val < another_dec->val);
     }
-    // 仅允许Int/Decimal
-    throw NativeFuncError("TypeError", "function Int.lt second arg need be Int or Decimal");
+    // 与Float比较
+    if (auto another_float = dyn<Float>(args->val[0])) {
+        return load_bool(self_int->val.to_double() < another_float->val);
+    }
+    // 仅允许Int/Decimal/Float
+    throw NativeFuncError("TypeError", "function Int.lt second arg need be Int, Decimal or Float");
 };
 
 // Int.__gt__ 大于判断：self > args[0]（仅支持Int/Decimal）
 Object* int_gt(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
 
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = dyn<Int>(self);
     // 与Int比较
-    auto another_int = dynamic_cast<Int*>(args->val[0]);
+    auto another_int = dyn<Int>(args->val[0]);
     if (another_int) {
         return load_bool(self_int->val > another_int->val);
     }
     // 与Decimal比较
-    auto another_dec = dynamic_cast<Decimal*>(args->val[0]);
+    auto another_dec = dyn<Decimal>(args->val[0]);
     if (another_dec) {
         dep::Decimal cmp_val(self_int->val);
         return load_bool(cmp_val > another_dec->val);
     }
-    // 仅允许Int/Decimal
-    throw NativeFuncError("TypeError", "function Int.gt second arg need be Int or Decimal");
+    // 与Float比较
+    if (auto another_float = dyn<Float>(args->val[0])) {
+        return load_bool(self_int->val.to_double() > another_float->val);
+    }
+    // 仅允许Int/Decimal/Float
+    throw NativeFuncError("TypeError", "function Int.gt second arg need be Int, Decimal or Float");
 };
 
 // Int.__hash__
 Object* int_hash(Object* self, const List* args) {
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = dyn<Int>(self);
     return new Int(self_int->val);
 }
 
 Object* int_str(Object* self, const List* args) {
-    auto self_int = dynamic_cast<Int*>(self);
+    auto self_int = dyn<Int>(self);
     return new String(self_int->val.to_string());
 }
 
@@ -13,8 +13,18 @@ Object* list_call(Object* self, const List* args) {
     }
 
     auto for_cast = builtin::get_one_arg(args);
+    if (Iterator::supports(for_cast)) {
+        // 内置容器直接用原生迭代器, 不逐个调用__next__
+        const auto it = new Iterator(for_cast);
+        it->make_ref();
+        // Range产生立即数, 放入列表前装箱
+        while (const auto item = it->next()) list.push_back(box_value(item));
+        const auto result = new List(list);
+        it->del_ref();
+        return result;
+    }
     while (true) {
-        kiz::Vm::call_method(for_cast, "__next__", {});
+        kiz::Vm::call_magic(for_cast, Magic::Next, {});
         auto res = kiz::Vm::simple_get_and_pop_stack_top();
         if (res == stop_iter_signal) {
             break;
@@ -26,8 +36,7 @@ Object* list_call(Object* self, const List* args) {
 
 // List.__bool__
 Object* list_bool(Object* self, const List* args) {
-    const auto self_int = dynamic_cast<List*>(self);
-    assert(self_int != nullptr);
+    const auto self_int = as<List>(self);
     if (self_int->val.empty()) return load_false();
     return load_true();
 }
@@ -36,15 +45,14 @@ Object* list_bool(Object* self, const List* args) {
 Object* list_add(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
     
-    auto another_list = dynamic_cast<List*>(args->val[0]);
+    auto another_list = dyn<List>(args->val[0]);
     if (!another_list)
         throw NativeFuncError("TypeError", "List.add only supports List type argument");
     
     // 浅拷贝
-    std::vector<Object*> new_vals = self_list->val;
+    std::vector<Object*> new_vals = self_list->val.vec();
     new_vals.insert(new_vals.end(), another_list->val.begin(), another_list->val.end());
     
     return new List(std::move(new_vals));
@@ -54,10 +62,9 @@ Object* list_add(Object* self, const List* args) {
 Object* list_mul(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
     
-    auto times_int = dynamic_cast<Int*>(args->val[0]);
+    auto times_int = dyn<Int>(args->val[0]);
     if (! times_int)
         throw NativeFuncError("TypeError", "List.mul only supports Int type argument");
     if (times_int->val < dep::BigInt(0))
@@ -76,10 +83,9 @@ Object* list_mul(Object* self, const List* args) {
 Object* list_eq(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
     
-    auto another_list = dynamic_cast<List*>(args->val[0]);
+    auto another_list = dyn<List>(args->val[0]);
     if (! another_list)
         throw NativeFuncError("TypeError", "List.eq only supports List type argument");
     
@@ -93,13 +99,13 @@ Object* list_eq(Object* self, const List* args) {
         Object* self_elem = self_list->val[i];
         Object* another_elem = another_list->val[i];
         // 调用 __eq__
-        kiz::Vm::call_method(
-            self_elem, "__eq__", {another_elem}
+        kiz::Vm::call_magic(
+            self_elem, Magic::Eq, {another_elem}
         );
         const auto eq_result = kiz::Vm::simple_get_and_pop_stack_top();
 
         // 解析比较结果
-        const auto eq_bool = dynamic_cast<Bool*>(eq_result);
+        const auto eq_bool = dyn<Bool>(eq_result);
         if (! eq_bool)
             throw NativeFuncError("TypeError", "__eq__ method must return Bool type");
         
@@ -114,7 +120,7 @@ Object* list_eq(Object* self, const List* args) {
 };
 
 Object* list_str(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = dyn<List>(self);
     std::string result = "[";
     for (size_t i = 0; i < self_list->val.size(); ++i) {
         if (self_list->val[i]) {
@@ -131,7 +137,7 @@ Object* list_str(Object* self, const List* args) {
 }
 
 Object* list_dstr(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = dyn<List>(self);
     std::string result = "[";
     for (size_t i = 0; i < self_list->val.size(); ++i) {
         if (self_list->val[i] != nullptr) {
@@ -151,16 +157,15 @@ Object* list_dstr(Object* self, const List* args) {
 Object* list_contains(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
     
     Object* target_elem = args->val[0];
 
     // 遍历列表元素，逐个判断是否与目标元素相等
     for (Object* elem : self_list->val) {
 
-        kiz::Vm::call_method(
-            elem, "__eq__", {target_elem}
+        kiz::Vm::call_magic(
+            elem, Magic::Eq, {target_elem}
         );
         const auto result = kiz::Vm::simple_get_and_pop_stack_top();
 
@@ -173,47 +178,25 @@ Object* list_contains(Object* self, const List* args) {
 };
 
 // List.append：向列表尾部添加一个元素
-Object* list_append(Object* self, const List* args) {
+Object* list_append(Object* self, const std::span<Object* const> args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
     
-    Object* elem_to_add = args->val[0];
+    Object* elem_to_add = box_value(args[0]);
 
     // 添加元素到列表尾部
     self_list->val.push_back(elem_to_add);
     elem_to_add->make_ref();
     
-    // 返回列表自身，支持链式调用
-    self->make_ref();
+    // 返回列表自身，支持链式调用(返回值由call_native持有, 这里不再计数)
     return self;
 };
 
-Object* list_next(Object* self, const List* args) {
-    auto curr_idx_it = self->attrs.find("__current_index__");
-    if(!curr_idx_it)
-        throw NativeFuncError("TypeError", "List.next cannot find attribute '__current_index__' to get current index");
-
-    auto curr_idx = curr_idx_it->value;
-
-    auto index =  cast_to_int(curr_idx) ->val.to_unsigned_long_long();
-
-    auto self_list = dynamic_cast<List*>(self);
-    if (index < self_list->val.size()) {
-        auto res = self_list->val[index];
-        self->attrs_insert("__current_index__", new Int(index+1));
-        return res;
-    }
-    self->attrs_insert("__current_index__", kiz::Vm::small_int_pool[0]);
-    return load_stop_iter_signal();
-}
-
 Object* list_foreach(Object* self, const List* args) {
     auto func_obj = builtin::get_one_arg(args);
 
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
 
     dep::BigInt idx = 0;
     for (auto e : self_list->val) {
@@ -224,48 +207,54 @@ Object* list_foreach(Object* self, const List* args) {
 }
 
 Object* list_reverse(Object* self, const List* args) {
-    const auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    const auto self_list = as<List>(self);
 
-    std::ranges::reverse(self_list->val);
+    std::ranges::reverse(self_list->val.mut());
     return load_nil();
 }
 
 Object* list_extend(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
 
     auto other_list_obj = builtin::get_one_arg(args);
-    auto other_list = dynamic_cast<List*>(other_list_obj);
+    auto other_list = dyn<List>(other_list_obj);
     if (!other_list)
         throw NativeFuncError("TypeError", "The first argument of List.extend must be List type");
 
-    for (auto e: other_list->val) {
+    // 先复制一份: other_list与self_list可能是同一个列表
+    const auto items = other_list->val;
+    for (auto e: items) {
+        e->make_ref();
         self_list->val.push_back(e);
     }
     return load_nil();
 }
 
 Object* list_pop(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
 
-    self_list->val.pop_back();
+    if (!self_list->val.empty()) {
+        auto& items = self_list->val.mut();
+        items.back()->del_ref();
+        items.pop_back();
+    }
     return load_nil();
 }
 
 Object* list_insert(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
     kiz::Vm::assert_argc(2, args);
     if (args->val.size() == 2) {
         auto value_obj = args->val[0];
-        auto idx_int = dynamic_cast<Int*>(args->val[1]);
+        auto idx_int = dyn<Int>(args->val[1]);
         if (!idx_int)
             throw NativeFuncError("TypeError", "The first argument of List.setitem must be Int type");
         auto idx = idx_int->val.to_unsigned_long_long();
         if (idx < self_list->val.size()) {
-            self_list->val[idx] = value_obj;
+            auto& items = self_list->val.mut();
+            value_obj->make_ref();
+            if (items[idx]) items[idx]->del_ref();
+            items[idx] = value_obj;
         }
     }
     return load_nil();
@@ -273,9 +262,9 @@ Object* list_insert(Object* self, const List* args) {
 
 Object* list_setitem(Object* self, const List* args) {
     kiz::Vm::assert_argc(2, args);
-    auto self_list = dynamic_cast<List*>(self);
+    auto self_list = dyn<List>(self);
 
-    auto idx_obj = dynamic_cast<Int*>(args->val[0]);
+    auto idx_obj = dyn<Int>(args->val[0]);
     if (!idx_obj)
         throw NativeFuncError("TypeError", "The first argument of List.setitem must be Int type");
 
@@ -284,15 +273,19 @@ Object* list_setitem(Object* self, const List* args) {
     auto value_obj = args->val[1];
 
     if (index < self_list->val.size()) {
-        self_list->val[index] = value_obj;
+        // 先独占存储(共享时旧值的引用归其他List), 再先持有新值后释放旧值, 新旧为同一对象时不会提前析构
+        auto& items = self_list->val.mut();
+        value_obj->make_ref();
+        if (items[index]) items[index]->del_ref();
+        items[index] = value_obj;
         return load_nil();
     }
     throw NativeFuncError("SetItemError", std::format("index {} out of range", index));
 }
 
 Object* list_getitem(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
-    auto idx_obj = dynamic_cast<Int*>(builtin::get_one_arg(args));
+    auto self_list = dyn<List>(self);
+    auto idx_obj = dyn<Int>(builtin::get_one_arg(args));
     if (!idx_obj)
         throw NativeFuncError("TypeError", "The first argument of List.getitem must be Int type");
 
@@ -309,7 +302,7 @@ Object* list_count(Object* self, const List* args) {
     auto self_list = cast_to_list(self);
 
     for (const auto& item : self_list->val) {
-        kiz::Vm::call_method(obj, "__eq__", {item});
+        kiz::Vm::call_magic(obj, Magic::Eq, {item});
         auto res = kiz::Vm::simple_get_and_pop_stack_top();
         if (res) {
             ++ count;
@@ -321,8 +314,7 @@ Object* list_count(Object* self, const List* args) {
 Object* list_find(Object* self, const List* args) {
     auto func_obj = builtin::get_one_arg(args);
 
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
 
     for (auto e : self_list->val) {
         kiz::Vm::call_function(func_obj, {e}, nullptr);
@@ -338,8 +330,7 @@ Object* list_find(Object* self, const List* args) {
 Object* list_map(Object* self, const List* args) {
     auto func_obj = builtin::get_one_arg(args);
 
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
 
     std::vector<Object*> new_vec;
 
@@ -355,8 +346,7 @@ Object* list_map(Object* self, const List* args) {
 Object* list_filter(Object* self, const List* args) {
     auto func_obj = builtin::get_one_arg(args);
 
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
 
     std::vector<Object*> new_vec;
 
@@ -370,15 +360,13 @@ Object* list_filter(Object* self, const List* args) {
     return new List(new_vec);
 }
 
-Object* list_len(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
-    return new Int(dep::BigInt(self_list->val.size()));
+Object* list_len(Object* self, std::span<Object* const> args) {
+    auto self_list = as<List>(self);
+    return make_int_value(static_cast<int64_t>(self_list->val.size()));
 }
 
 Object* list_join(Object* self, const List* args) {
-    auto self_list = dynamic_cast<List*>(self);
-    assert(self_list != nullptr);
+    auto self_list = as<List>(self);
 
     auto sep = kiz::Vm::obj_to_str(builtin::get_one_arg(args));
 
@@ -6,7 +6,7 @@ namespace model {
 Object* nil_eq(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     // Nil仅与自身相等
-    auto another_nil = dynamic_cast<Nil*>(args->val[0]);
+    auto another_nil = dyn<Nil>(args->val[0]);
     return load_bool(another_nil != nullptr);
 }
 
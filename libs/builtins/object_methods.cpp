@@ -1,3 +1,5 @@
+#include <format>
+
 #include "../../src/models/models.hpp"
 #include "include/builtin_functions.hpp"
 
@@ -16,87 +18,87 @@ Object* object_eq(Object* self, const List* args) {
 Object* object_setitem(Object* self, const List* args) {
     assert(args->val.size() == 2);
     auto attr = args->val[0];
-    auto attr_str = dynamic_cast<model::String*>(attr);
-    assert(attr_str != nullptr);
+    auto attr_str = model::as<model::String>(attr);
     self->attrs_insert(attr_str->val, args->val[1]);
     return self;
 }
 
 Object* object_getitem(Object* self, const List* args) {
     auto attr = builtin::get_one_arg(args);
-    auto attr_str = dynamic_cast<model::String*>(attr);
-    assert(attr_str != nullptr);
+    auto attr_str = model::as<model::String>(attr);
     return kiz::Vm::get_attr(self, attr_str->val);
 }
 
 
 // Range类型
+namespace {
+
+int64_t range_bound(Object* obj) {
+    int64_t v;
+    if (!int_value_of(obj, v))
+        throw NativeFuncError("TypeError", "Range() arguments must be Int within 64-bit range");
+    return v;
+}
+
+}
+
+// Range.__call__: Range(end) / Range(start, end) / Range(start, step, end)
 Object* range_call(Object* self, const List* args) {
-    auto arg_vector = args->val;
-    dep::BigInt start_int = 0;
-    dep::BigInt step_int = 1;
-    dep::BigInt end_int = 1;
-    auto r_obj = new Object();
-    r_obj->attrs_insert("__parent__", self);
+    const auto& arg_vector = args->val;
+    int64_t start = 0;
+    int64_t step = 1;
+    int64_t end = 0;
 
     if (arg_vector.size() == 1) {
-        end_int = cast_to_int(arg_vector[0])->val.to_unsigned_long_long();
+        end = range_bound(arg_vector[0]);
     }
     else if (arg_vector.size() == 2) {
-        start_int = cast_to_int(arg_vector[0])->val.to_unsigned_long_long();
-        end_int = cast_to_int(arg_vector[1])->val.to_unsigned_long_long();
+        start = range_bound(arg_vector[0]);
+        end = range_bound(arg_vector[1]);
     }
     else if (arg_vector.size() == 3) {
-        start_int = cast_to_int(arg_vector[0])->val.to_unsigned_long_long();
-        step_int = cast_to_int(arg_vector[1])->val.to_unsigned_long_long();
-        end_int = cast_to_int(arg_vector[2])->val.to_unsigned_long_long();
-
+        start = range_bound(arg_vector[0]);
+        step = range_bound(arg_vector[1]);
+        end = range_bound(arg_vector[2]);
     } else kiz::Vm::assert_argc({1,2,3}, args);
 
-    r_obj->attrs_insert("current", new Int(start_int));
-    r_obj->attrs_insert("start", new Int(start_int));
-    r_obj->attrs_insert("step", new Int(step_int));
-    r_obj->attrs_insert("end", new Int(end_int));
-    return r_obj;
-}
-
-Object* range_next(Object* self, const List* args) {
-    Int* start_obj = cast_to_int(kiz::Vm::get_attr_current(self, "start"));
-    Int* step_obj = cast_to_int(kiz::Vm::get_attr_current(self, "step"));
-    Int* end_obj = cast_to_int(kiz::Vm::get_attr_current(self, "end"));
-    Int* current_obj = cast_to_int(kiz::Vm::get_attr_current(self, "current"));
-
-    dep::BigInt& start_int = start_obj->val;
-    dep::BigInt& step_int = step_obj->val;
-    dep::BigInt& end_int = end_obj->val;
-    dep::BigInt& current = current_obj->val;
-
-    bool is_end = false;
-    if (step_int > 0) {
-        is_end = current >= end_int;
-    } else {
-        return load_stop_iter_signal();
-    }
+    if (step == 0) throw NativeFuncError("ValueError", "Range() step must not be zero");
+    return new Range(start, step, end);
+}
 
-    if (is_end) {
-        return load_stop_iter_signal();
-    }
+Object* range_str(Object* self, const List* args) {
+    return new String(as<Range>(self)->debug_string());
+}
+
+Object* range_len(Object* self, std::span<Object* const> args) {
+    return make_int_value(static_cast<int64_t>(as<Range>(self)->size()));
+}
 
-    dep::BigInt old_val = current;
-    current += step_int;
+// Range.contains: 只有整数可能在区间内
+Object* range_contains(Object* self, const List* args) {
+    int64_t v;
+    if (!int_value_of(builtin::get_one_arg(args), v)) return load_false();
+    return load_bool(as<Range>(self)->contains(v));
+}
 
-    // 返回迭代值
-    return new Int(old_val);
+Object* range_getitem(Object* self, const List* args) {
+    const auto range = as<Range>(self);
+    int64_t index;
+    if (!int_value_of(builtin::get_one_arg(args), index))
+        throw NativeFuncError("TypeError", "The first argument of Range.getitem must be Int type");
+    if (index < 0 or static_cast<uint64_t>(index) >= range->size())
+        throw NativeFuncError("GetItemError", std::format("index {} out of range", index));
+    return make_int_value(range->at(static_cast<uint64_t>(index)));
 }
 
-Object* range_str(Object* self, const List* args) {
-    dep::BigInt start_int = cast_to_int(kiz::Vm::get_attr_current(self, "start"))->val;
-    dep::BigInt step_int = cast_to_int(kiz::Vm::get_attr_current(self, "step"))->val;
-    dep::BigInt end_int = cast_to_int(kiz::Vm::get_attr_current(self, "end"))->val;
-    dep::BigInt current = cast_to_int(kiz::Vm::get_attr_current(self, "current"))->val;
+Object* range_bool(Object* self, const List* args) {
+    return load_bool(as<Range>(self)->size() > 0);
+}
 
-    return new String(std::format("Range(start={}, step={}, end={}, current={})", start_int.to_string(),
-        step_int.to_string(), end_int.to_string(), current.to_string()));
+// Iterator类型: for循环走FOR_ITER的原生路径, 这里供通用的__next__调用
+Object* iterator_next(Object* self, const List* args) {
+    if (const auto item = as<Iterator>(self)->next()) return item;
+    return load_stop_iter_signal();
 }
 
 // Error类型
@@ -119,7 +121,7 @@ Object* error_call(Object* self, const List* args) {
 
 // Function类型
 Object* function_str(Object* self, const List* args) {
-    auto self_fn = dynamic_cast<Function*>(self);
+    auto self_fn = dyn<Function>(self);
     return new String(
         "<Function: path='" + self_fn->name + "', argc=" + std::to_string(self_fn->argc) + " at " + ptr_to_string(self_fn) + ">"
     );
@@ -127,7 +129,7 @@ Object* function_str(Object* self, const List* args) {
 
 // NativeFunction类型
 Object* native_function_str(Object* self, const List* args) {
-    auto self_nfn = dynamic_cast<NativeFunction*>(self);
+    auto self_nfn = dyn<NativeFunction>(self);
     return new model::String(
      "<NativeFunction" +
          (self_nfn->name.empty()
@@ -140,7 +142,7 @@ Object* native_function_str(Object* self, const List* args) {
 
 // Module类型
 Object* module_str(Object* self, const List* args) {
-    auto self_mod = dynamic_cast<model::Module*>(self);
+    auto self_mod = model::dyn<model::Module>(self);
     return new model::String(
         "<Module: path='" + self_mod->path + "', attr=" + self_mod->attrs.to_string() + ", at " + ptr_to_string(self_mod) + ">"
     );
@@ -17,7 +17,7 @@ Object* str_call(Object* self, const List* args) {
 
 // String.__bool__
 Object* str_bool(Object* self, const List* args) {
-    const auto self_int = dynamic_cast<String*>(self);
+    const auto self_int = dyn<String>(self);
     if (self_int->val.empty()) load_false();
     return load_true();
 }
@@ -25,10 +25,9 @@ Object* str_bool(Object* self, const List* args) {
 // String.__add__：字符串拼接（self + 传入String，返回新String，不修改原对象）
 Object* str_add(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
-    auto self_str = dynamic_cast<String*>(self);
-    assert(self_str != nullptr);
+    auto self_str = as<String>(self);
     
-    auto another_str = dynamic_cast<String*>(args->val[0]);
+    auto another_str = dyn<String>(args->val[0]);
     if (!another_str)
         throw NativeFuncError("TypeError", "String.add only supports String type argument");
     
@@ -39,10 +38,9 @@ Object* str_add(Object* self, const List* args) {
 // String.__mul__：字符串重复n次（self * n，返回新String，n为非负整数）
 Object* str_mul(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
-    auto self_str = dynamic_cast<String*>(self);
-    assert(self_str != nullptr);
+    auto self_str = as<String>(self);
     
-    auto times_int = dynamic_cast<Int*>(args->val[0]);
+    auto times_int = dyn<Int>(args->val[0]);
     if (!times_int)
         throw NativeFuncError("TypeError","String.mul only supports Int type argument");
     if(times_int->val < dep::BigInt(0))
@@ -61,10 +59,9 @@ Object* str_mul(Object* self, const List* args) {
 Object* str_eq(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_str = dynamic_cast<String*>(self);
-    assert(self_str != nullptr);
+    auto self_str = as<String>(self);
     
-    auto another_str = dynamic_cast<String*>(args->val[0]);
+    auto another_str = dyn<String>(args->val[0]);
     if (! another_str)
         throw NativeFuncError("TypeError","String.eq only supports String type argument");
     
@@ -75,10 +72,9 @@ Object* str_eq(Object* self, const List* args) {
 Object* str_contains(Object* self, const List* args) {
     kiz::Vm::assert_argc(1, args);
     
-    auto self_str = dynamic_cast<String*>(self);
-    assert(self_str != nullptr);
+    auto self_str = as<String>(self);
     
-    auto sub_str = dynamic_cast<String*>(args->val[0]);
+    auto sub_str = dyn<String>(args->val[0]);
     if(! sub_str)
         throw NativeFuncError("TypeError", "String.contains only supports String type argument");
     
@@ -88,46 +84,23 @@ Object* str_contains(Object* self, const List* args) {
 
 // String.__hash__
 Object* str_hash(Object* self, const List* args) {
-    auto self_str = dynamic_cast<String*>(self);
-    assert(self_str != nullptr);
+    auto self_str = as<String>(self);
     auto hashed_str = dep::hash_string(self_str->val);
     return new Int(dep::BigInt(hashed_str));
 }
 
-Object* str_next(Object* self, const List* args) {
-    auto curr_idx_it = self->attrs.find("__current_index__");
-    assert(curr_idx_it != nullptr);
-
-    auto curr_idx = curr_idx_it->value;
-
-    auto index = cast_to_int(curr_idx) ->val.to_unsigned_long_long();
-
-    auto self_str = dynamic_cast<String*>(self);
-    assert(self_str != nullptr);
-
-    if (index < self_str->val.size()) {
-        auto res = dep::UTF8String(self_str->val)[index];
-        self->attrs_insert("__current_index__", new Int(index+1));
-        return new String(res.to_string());
-    }
-    self->attrs_insert("__current_index__", kiz::Vm::small_int_pool[0]);
-    return load_stop_iter_signal();
-}
-
 Object* str_str(Object* self, const List* args) {
-    auto self_str = dynamic_cast<String*>(self);
-    assert(self_str != nullptr);
+    auto self_str = as<String>(self);
     return new String(self_str->val);
 }
 
 Object* str_dstr(Object* self, const List* args) {
-    auto self_str = dynamic_cast<String*>(self);
-    assert(self_str != nullptr);
+    auto self_str = as<String>(self);
     return new String("\"" + self_str->val + "\"");
 }
 
 Object* str_getitem(Object* self, const List* args) {
-    auto self_str = dynamic_cast<String*>(self);
+    auto self_str = dyn<String>(self);
     auto idx_obj = cast_to_int(builtin::get_one_arg(args));
     auto index = idx_obj->val.to_unsigned_long_long();
     auto text = dep::UTF8String(self_str->val);
@@ -159,7 +132,7 @@ Object* str_count(Object* self, const List* args) {
     auto self_str = cast_to_str(self);
 
     for (const auto& c : dep::UTF8String(self_str->val)) {
-        kiz::Vm::call_method(obj, "__eq__", {
+        kiz::Vm::call_magic(obj, Magic::Eq, {
             new String(c.to_string())
         });
         auto res = kiz::Vm::get_and_pop_stack_top();
@@ -205,10 +178,10 @@ Object* str_endswith(Object* self, const List* args) {
 
 }
 
-Object* str_len(Object* self, const List* args) {
+Object* str_len(Object* self, std::span<Object* const> args) {
     auto self_str = cast_to_str(self);
 
-    return new Int(dep::UTF8String(self_str->val).size());
+    return make_int_value(static_cast<int64_t>(dep::UTF8String(self_str->val).size()));
 }
 
 Object* str_is_alpha(Object* self, const List* args) {
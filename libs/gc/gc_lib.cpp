@@ -0,0 +1,137 @@
+#include "include/gc_lib.hpp"
+
+namespace gc_lib {
+
+namespace {
+
+model::Object* int_obj(const size_t v) {
+    return model::box_value(model::make_int_value(static_cast<int64_t>(v)));
+}
+
+// 读取第i个参数的非负整数值, 其他类型抛出TypeError
+size_t size_arg(const std::span<model::Object* const> args, const size_t i, const char* func_name) {
+    int64_t val;
+    if (!model::int_value_of(args[i], val) or val < 0)
+        throw NativeFuncError("TypeError", std::format(
+            "gc.{} arg need be non-negative Int, got {}", func_name, kiz::Vm::obj_to_debug_str(args[i])));
+    return static_cast<size_t>(val);
+}
+
+void insert(model::Dictionary* dict, const std::string& key, model::Object* value) {
+    dict->insert(new model::String(key), value);
+}
+
+}
+
+model::Object* init_module(model::Object* self, const model::List* args) {
+    auto mod = new model::Module("gc");
+
+    mod->attrs_insert("collect", model::create_nfunc(collect));
+    mod->attrs_insert("stats", model::create_nfunc(stats));
+    mod->attrs_insert("pools", model::create_nfunc(pools));
+    mod->attrs_insert("enable", model::create_nfunc(enable));
+    mod->attrs_insert("disable", model::create_nfunc(disable));
+    mod->attrs_insert("is_enabled", model::create_nfunc(is_enabled));
+    mod->attrs_insert("get_threshold", model::create_nfunc(get_threshold));
+    mod->attrs_insert("set_threshold", model::create_nfunc(set_threshold));
+
+    return mod;
+}
+
+// gc.collect() 回收所有代, gc.collect(g) 回收第0..g代; 返回释放的对象数.
+// 在原生函数的回调中调用时(如List.foreach的回调)不能立即回收, 推迟到下一个安全点并返回0
+model::Object* collect(model::Object* self, const std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc({0, 1}, args);
+    const size_t generation = args.empty() ? kiz::gc_generation_count - 1 : size_arg(args, 0, "collect");
+    if (generation >= kiz::gc_generation_count)
+        throw NativeFuncError("ValueError", std::format(
+            "gc.collect generation need be less than {}", kiz::gc_generation_count));
+    if (kiz::Vm::run_depth > 1) {
+        model::gc_young_count = kiz::Vm::gc_thresholds[0] + 1;
+        return int_obj(0);
+    }
+    return int_obj(kiz::Vm::collect_cycles(generation));
+}
+
+// gc.stats() 返回回收统计: 各代回收次数与登记对象数、累计释放数和停顿时间(纳秒),
+// 以及延迟释放队列的累计入队/释放引用数、由队列析构的对象数、当前长度与峰值
+model::Object* stats(model::Object* self, const std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(0, args);
+    const auto& s = kiz::Vm::gc_stats;
+
+    std::vector<model::Object*> collections, tracked;
+    for (size_t g = 0; g < kiz::gc_generation_count; ++g) {
+        collections.push_back(int_obj(s.collections[g]));
+        tracked.push_back(int_obj(model::gc_generations[g].size));
+    }
+
+    auto dict = new model::Dictionary();
+    insert(dict, "collections", new model::List(collections));
+    insert(dict, "tracked", new model::List(tracked));
+    insert(dict, "collected", int_obj(s.collected));
+    insert(dict, "pause_total_ns", int_obj(s.total_pause_ns));
+    insert(dict, "pause_max_ns", int_obj(s.max_pause_ns));
+    insert(dict, "pause_last_ns", int_obj(s.last_pause_ns));
+    insert(dict, "free_queued", int_obj(model::free_queue.queued));
+    insert(dict, "free_released", int_obj(model::free_queue.released));
+    insert(dict, "free_freed", int_obj(model::free_queue.freed));
+    insert(dict, "free_pending", int_obj(model::free_queue.pending));
+    insert(dict, "free_max_pending", int_obj(model::free_queue.max_pending));
+    return dict;
+}
+
+// gc.pools() 返回当前线程对象池各级别的占用与命中情况(只列出分配过的级别):
+// size为该级对象大小, in_use为存活对象数, hit_rate为由空闲链表满足的分配比例
+model::Object* pools(model::Object* self, const std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(0, args);
+    std::vector<model::Object*> classes;
+    for (size_t i = 0; i < model::slab_class_count; ++i) {
+        const auto& c = model::slab_classes[i];
+        if (c.allocs == 0) continue;
+        auto dict = new model::Dictionary();
+        insert(dict, "size", int_obj((i + 1) * model::slab_granularity));
+        insert(dict, "slabs", int_obj(c.slabs));
+        insert(dict, "in_use", int_obj(c.in_use));
+        insert(dict, "allocs", int_obj(c.allocs));
+        insert(dict, "hits", int_obj(c.hits));
+        insert(dict, "hit_rate", new model::Float(static_cast<double>(c.hits) / static_cast<double>(c.allocs)));
+        classes.push_back(dict);
+    }
+    return new model::List(classes);
+}
+
+model::Object* enable(model::Object* self, const std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(0, args);
+    kiz::Vm::gc_enabled = true;
+    return model::load_nil();
+}
+
+model::Object* disable(model::Object* self, const std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(0, args);
+    kiz::Vm::gc_enabled = false;
+    return model::load_nil();
+}
+
+model::Object* is_enabled(model::Object* self, const std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(0, args);
+    return model::load_bool(kiz::Vm::gc_enabled);
+}
+
+model::Object* get_threshold(model::Object* self, const std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(0, args);
+    std::vector<model::Object*> thresholds;
+    for (const auto t : kiz::Vm::gc_thresholds) thresholds.push_back(int_obj(t));
+    return new model::List(thresholds);
+}
+
+// gc.set_threshold(t0[, t1[, t2]]): t0为第0代触发回收的净增对象数(0表示每个安全点都回收),
+// t1/t2为连带回收下一代所需的本代回收次数; 未给出的保持不变
+model::Object* set_threshold(model::Object* self, const std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc({1, 2, 3}, args);
+    for (size_t i = 0; i < args.size(); ++i) {
+        kiz::Vm::gc_thresholds[i] = size_arg(args, i, "set_threshold");
+    }
+    return model::load_nil();
+}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "models/models.hpp"
+
+namespace gc_lib {
+
+model::Object* init_module(model::Object* self, const model::List* args);
+
+model::Object* collect(model::Object* self, std::span<model::Object* const> args);
+model::Object* stats(model::Object* self, std::span<model::Object* const> args);
+model::Object* pools(model::Object* self, std::span<model::Object* const> args);
+
+model::Object* enable(model::Object* self, std::span<model::Object* const> args);
+model::Object* disable(model::Object* self, std::span<model::Object* const> args);
+model::Object* is_enabled(model::Object* self, std::span<model::Object* const> args);
+
+model::Object* get_threshold(model::Object* self, std::span<model::Object* const> args);
+model::Object* set_threshold(model::Object* self, std::span<model::Object* const> args);
+
+}
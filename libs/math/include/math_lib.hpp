@@ -0,0 +1,31 @@
+#pragma once
+#include "models/models.hpp"
+
+namespace math_lib {
+
+model::Object* init_module(model::Object* self, const model::List* args);
+
+model::Object* sqrt_(model::Object* self, std::span<model::Object* const> args);
+model::Object* exp_(model::Object* self, std::span<model::Object* const> args);
+model::Object* log_(model::Object* self, std::span<model::Object* const> args);
+model::Object* log10_(model::Object* self, std::span<model::Object* const> args);
+model::Object* pow_(model::Object* self, std::span<model::Object* const> args);
+
+model::Object* sin_(model::Object* self, std::span<model::Object* const> args);
+model::Object* cos_(model::Object* self, std::span<model::Object* const> args);
+model::Object* tan_(model::Object* self, std::span<model::Object* const> args);
+model::Object* asin_(model::Object* self, std::span<model::Object* const> args);
+model::Object* acos_(model::Object* self, std::span<model::Object* const> args);
+model::Object* atan_(model::Object* self, std::span<model::Object* const> args);
+model::Object* atan2_(model::Object* self, std::span<model::Object* const> args);
+model::Object* hypot_(model::Object* self, std::span<model::Object* const> args);
+
+model::Object* fabs_(model::Object* self, std::span<model::Object* const> args);
+model::Object* floor_(model::Object* self, std::span<model::Object* const> args);
+model::Object* ceil_(model::Object* self, std::span<model::Object* const> args);
+model::Object* trunc_(model::Object* self, std::span<model::Object* const> args);
+
+model::Object* isnan_(model::Object* self, std::span<model::Object* const> args);
+model::Object* isinf_(model::Object* self, std::span<model::Object* const> args);
+
+}
@@ -0,0 +1,152 @@
+#include "include/math_lib.hpp"
+
+#include <cmath>
+#include <numbers>
+#include "builtins/include/builtin_methods.hpp"
+
+namespace math_lib {
+
+namespace {
+
+// 读取第i个参数的double值(Float/Int/Decimal), 其他类型抛出TypeError
+double number_arg(const std::span<model::Object* const> args, const size_t i, const char* func_name) {
+    model::Object* arg = args[i];
+    double val;
+    if (model::float_value_of(arg, val)) return val;
+    if (const auto d = model::dyn<model::Decimal>(arg)) {
+        return std::strtod(d->val.to_string().c_str(), nullptr);
+    }
+    throw NativeFuncError("TypeError", std::format(
+        "math.{} arg need be Float, Int or Decimal, got {}", func_name, kiz::Vm::obj_to_debug_str(arg)));
+}
+
+model::Object* unary(const std::span<model::Object* const> args, const char* func_name, double (*func)(double)) {
+    kiz::Vm::assert_argc(1, args);
+    return new model::Float(func(number_arg(args, 0, func_name)));
+}
+
+model::Object* binary(const std::span<model::Object* const> args, const char* func_name, double (*func)(double, double)) {
+    kiz::Vm::assert_argc(2, args);
+    return new model::Float(func(number_arg(args, 0, func_name), number_arg(args, 1, func_name)));
+}
+
+}
+
+model::Object* init_module(model::Object* self, const model::List* args) {
+    auto mod = new model::Module("math");
+
+    mod->attrs_insert("pi", new model::Float(std::numbers::pi));
+    mod->attrs_insert("e", new model::Float(std::numbers::e));
+    mod->attrs_insert("inf", new model::Float(HUGE_VAL));
+    mod->attrs_insert("nan", new model::Float(std::nan("")));
+
+    mod->attrs_insert("sqrt", model::create_nfunc(sqrt_));
+    mod->attrs_insert("exp", model::create_nfunc(exp_));
+    mod->attrs_insert("log", model::create_nfunc(log_));
+    mod->attrs_insert("log10", model::create_nfunc(log10_));
+    mod->attrs_insert("pow", model::create_nfunc(pow_));
+    mod->attrs_insert("sin", model::create_nfunc(sin_));
+    mod->attrs_insert("cos", model::create_nfunc(cos_));
+    mod->attrs_insert("tan", model::create_nfunc(tan_));
+    mod->attrs_insert("asin", model::create_nfunc(asin_));
+    mod->attrs_insert("acos", model::create_nfunc(acos_));
+    mod->attrs_insert("atan", model::create_nfunc(atan_));
+    mod->attrs_insert("atan2", model::create_nfunc(atan2_));
+    mod->attrs_insert("hypot", model::create_nfunc(hypot_));
+    mod->attrs_insert("fabs", model::create_nfunc(fabs_));
+    mod->attrs_insert("floor", model::create_nfunc(floor_));
+    mod->attrs_insert("ceil", model::create_nfunc(ceil_));
+    mod->attrs_insert("trunc", model::create_nfunc(trunc_));
+    mod->attrs_insert("isnan", model::create_nfunc(isnan_));
+    mod->attrs_insert("isinf", model::create_nfunc(isinf_));
+
+    return mod;
+}
+
+model::Object* sqrt_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "sqrt", [](const double x) { return std::sqrt(x); });
+}
+
+model::Object* exp_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "exp", [](const double x) { return std::exp(x); });
+}
+
+// math.log(x) 自然对数, math.log(x, base) 以base为底
+model::Object* log_(model::Object* self, std::span<model::Object* const> args) {
+    if (args.size() == 2) {
+        return binary(args, "log", [](const double x, const double base) { return std::log(x) / std::log(base); });
+    }
+    return unary(args, "log", [](const double x) { return std::log(x); });
+}
+
+model::Object* log10_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "log10", [](const double x) { return std::log10(x); });
+}
+
+model::Object* pow_(model::Object* self, std::span<model::Object* const> args) {
+    return binary(args, "pow", [](const double x, const double y) { return std::pow(x, y); });
+}
+
+model::Object* sin_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "sin", [](const double x) { return std::sin(x); });
+}
+
+model::Object* cos_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "cos", [](const double x) { return std::cos(x); });
+}
+
+model::Object* tan_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "tan", [](const double x) { return std::tan(x); });
+}
+
+model::Object* asin_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "asin", [](const double x) { return std::asin(x); });
+}
+
+model::Object* acos_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "acos", [](const double x) { return std::acos(x); });
+}
+
+model::Object* atan_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "atan", [](const double x) { return std::atan(x); });
+}
+
+model::Object* atan2_(model::Object* self, std::span<model::Object* const> args) {
+    return binary(args, "atan2", [](const double y, const double x) { return std::atan2(y, x); });
+}
+
+model::Object* hypot_(model::Object* self, std::span<model::Object* const> args) {
+    return binary(args, "hypot", [](const double x, const double y) { return std::hypot(x, y); });
+}
+
+model::Object* fabs_(model::Object* self, std::span<model::Object* const> args) {
+    return unary(args, "fabs", [](const double x) { return std::fabs(x); });
+}
+
+// floor/ceil/trunc 返回Int
+model::Object* floor_(model::Object* self, std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(1, args);
+    return new model::Int(model::float_to_bigint(std::floor(number_arg(args, 0, "floor"))));
+}
+
+model::Object* ceil_(model::Object* self, std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(1, args);
+    return new model::Int(model::float_to_bigint(std::ceil(number_arg(args, 0, "ceil"))));
+}
+
+model::Object* trunc_(model::Object* self, std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(1, args);
+    return new model::Int(model::float_to_bigint(number_arg(args, 0, "trunc")));
+}
+
+model::Object* isnan_(model::Object* self, std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(1, args);
+    return model::load_bool(std::isnan(number_arg(args, 0, "isnan")));
+}
+
+model::Object* isinf_(model::Object* self, std::span<model::Object* const> args) {
+    kiz::Vm::assert_argc(1, args);
+    return model::load_bool(std::isinf(number_arg(args, 0, "isinf")));
+}
+
+}
@@ -45,8 +45,8 @@ model::Object* get_args(model::Object* self, const model::List* args) {
 
 model::Object* get_env(model::Object* self, const model::List* args) {
     try {
-        std::vector<std::pair<dep::BigInt, std::pair<model::Object*, model::Object*>>> elem_list;
         if (args->val.empty()) {
+            auto env_dict = new model::Dictionary();
 
 #if defined(_WIN32)
             // Windows 读取环境变量（通过_environ全局变量）
@@ -57,9 +57,7 @@ model::Object* get_env(model::Object* self, const model::List* args) {
                 if (eq_pos != std::string::npos) {
                     std::string key = env_str.substr(0, eq_pos);
                     std::string val = env_str.substr(eq_pos + 1);
-                    elem_list.emplace_back(dep::hash_string(key),
-                        std::pair {new model::String(key), new model::String(val)}
-                    );
+                    env_dict->insert(new model::String(key), new model::String(val));
                 }
                 env++;
             }
@@ -72,16 +70,13 @@ model::Object* get_env(model::Object* self, const model::List* args) {
                 if (eq_pos != std::string::npos) {
                     std::string key = env_str.substr(0, eq_pos);
                     std::string val = env_str.substr(eq_pos + 1);
-                    elem_list.emplace_back(dep::hash_string(key),
-                        std::pair {new model::String(key), new model::String(val)}
-                    );
+                    env_dict->insert(new model::String(key), new model::String(val));
                 }
                 env++;
             }
 #endif
 
-            // 返回字典类型的Object（基于你定义的make_dict）
-            return new model::Dictionary(dep::Dict(elem_list));
+            return env_dict;
         }
         kiz::Vm::assert_argc(0, args);
     } catch (const std::exception& e) {
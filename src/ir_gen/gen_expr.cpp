@@ -41,6 +41,17 @@ void IRGenerator::gen_expr(Expr* expr) {
         );
         break;
     }
+    case AstType::FloatExpr: {
+        // 生成LOAD_CONST指令（加载字面量常量）
+        auto const_obj = make_float_obj(dynamic_cast<FloatExpr*>(expr));
+        size_t const_idx = get_or_add_const(const_obj);
+        code_chunks.back().code_list.emplace_back(
+            Opcode::LOAD_CONST,
+            std::vector{const_idx},
+            expr->pos
+        );
+        break;
+    }
     case AstType::IdentifierExpr: {
         // 标识符：生成LOAD_VAR指令（加载变量值）
         const auto ident = dynamic_cast<IdentifierExpr*>(expr);
@@ -346,18 +357,11 @@ void IRGenerator::gen_fn_call(CallExpr* call_expr) {
     assert(call_expr && "gen_fn_call: 函数调用节点为空");
     size_t arg_count = call_expr->args.size();
 
-    // 生成所有参数的IR，最终打包成List（与原逻辑一致）
+    // 生成所有参数的IR: 参数按顺序留在栈上, 由CALL/CALL_METHOD直接绑定到被调用方
     for (auto& arg : call_expr->args) {
         gen_expr(arg.get());
     }
 
-    // 生成 OP_MAKE_LIST 指令：将栈顶 arg_count 个元素打包成参数列表，压回栈
-    code_chunks.back().code_list.emplace_back(
-        Opcode::MAKE_LIST,
-        std::vector<size_t>{arg_count},
-        call_expr->pos
-    );
-
     // 判断 callee 是否为 GetMemberExpr
     if (auto member_expr = dynamic_cast<GetMemberExpr*>(call_expr->callee.get())) {
         gen_expr(member_expr->father.get()); 
@@ -366,7 +370,7 @@ void IRGenerator::gen_fn_call(CallExpr* call_expr) {
         const std::string& method_name = member_expr->child->name;
         size_t method_name_idx = get_or_add_name(code_chunks.back().attr_names, method_name);
 
-        // 生成 CALL_METHOD 指令：操作数为 方法名索引 + 参数个数（用于校验）
+        // 生成 CALL_METHOD 指令：操作数为 方法名索引 + 参数个数
         code_chunks.back().code_list.emplace_back(
             Opcode::CALL_METHOD,
             std::vector{method_name_idx, arg_count},
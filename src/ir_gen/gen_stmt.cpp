@@ -53,7 +53,7 @@ void IRGenerator::gen_block(const BlockStmt* block) {
             size_t new_size = code_chunks.back().code_list.size();
             if (new_size > old_size) {
                 //正向复制指令
-                std::vector<Instruction> defer_block;
+                std::vector<IrInstruction> defer_block;
                 defer_block.reserve(new_size - old_size);
                 for (size_t i = old_size; i < new_size; ++i) {
                     defer_block.push_back(code_chunks.back().code_list[i]);
@@ -153,6 +153,15 @@ void IRGenerator::gen_block(const BlockStmt* block) {
         case AstType::ExprStmt: {
             auto expr_stmt = dynamic_cast<ExprStmt*>(stmt.get());
             gen_expr(expr_stmt->expr.get());
+            // 丢弃表达式的值, 否则循环中的表达式语句会让操作数栈无限增长并一直持有这些值;
+            // 模块最后一条表达式语句的值留在栈顶, 供REPL打印
+            if (block != ast.get() or &stmt != &block->statements.back()) {
+                code_chunks.back().code_list.emplace_back(
+                    Opcode::POP_TOP,
+                    std::vector<size_t>{},
+                    stmt->pos
+                );
+            }
             break;
         }
         case AstType::IfStmt:
@@ -532,32 +541,20 @@ void IRGenerator::gen_for(ForStmt* for_stmt) {
     // 生成循环iter IR
     gen_expr(for_stmt->iter.get());
 
-    code_chunks.back().code_list.emplace_back(
-        Opcode::CACHE_ITER,
-        std::vector<size_t>{},
-        for_stmt->pos
-    );
-
-    // 记录循环入口（条件判断开始位置）→ continue跳这里
-    size_t loop_entry_idx = code_chunks.back().code_list.size();
-
-    code_chunks.back().code_list.emplace_back(
-        Opcode::MAKE_LIST,
-        std::vector<size_t>{0},
-        for_stmt->pos
-    );
-
     code_chunks.back().code_list.emplace_back(
         Opcode::GET_ITER,
         std::vector<size_t>{},
         for_stmt->pos
     );
 
-    size_t name_idx = get_or_add_name(code_chunks.back().attr_names, "__next__");
+    // 记录循环入口（取下一个元素）→ continue跳这里
+    size_t loop_entry_idx = code_chunks.back().code_list.size();
 
+    // 生成FOR_ITER指令（迭代结束时跳到循环结束位置，先占位）
+    const size_t for_iter_idx = code_chunks.back().code_list.size();
     code_chunks.back().code_list.emplace_back(
-        Opcode::CALL_METHOD,
-        std::vector{name_idx},
+        Opcode::FOR_ITER,
+        std::vector<size_t>{0}, // 占位，后续填充为循环结束位置
         for_stmt->pos
     );
 
@@ -568,20 +565,6 @@ void IRGenerator::gen_for(ForStmt* for_stmt) {
         for_stmt->pos
     );
 
-    code_chunks.back().code_list.emplace_back(
-        Opcode::LOAD_VAR,
-        std::vector{var_name_idx},
-        for_stmt->pos
-    );
-
-    // 生成JUMP_IF_FALSE指令（目标：循环结束位置，先占位）
-    const size_t jump_if_false_idx = code_chunks.back().code_list.size();
-    code_chunks.back().code_list.emplace_back(
-        Opcode::JUMP_IF_FINISH_ITER,
-        std::vector<size_t>{0}, // 占位，后续填充为循环结束位置
-        for_stmt->pos
-    );
-
     auto loop_info = LoopInfo{{}, {}};
     code_chunks.back().loop_info_stack.emplace_back(loop_info);
 
@@ -595,9 +578,9 @@ void IRGenerator::gen_for(ForStmt* for_stmt) {
         for_stmt->pos
     );
 
-    // 填充JUMP_IF_FALSE的目标（循环结束位置 = 当前代码列表长度）
+    // 填充FOR_ITER的目标（循环结束位置 = 当前代码列表长度）
     size_t loop_exit_idx = code_chunks.back().code_list.size();
-    code_chunks.back().code_list[jump_if_false_idx].opn_list[0] = loop_exit_idx;
+    code_chunks.back().code_list[for_iter_idx].opn_list[0] = loop_exit_idx;
 
     code_chunks.back().code_list.emplace_back(
         Opcode::POP_ITER,
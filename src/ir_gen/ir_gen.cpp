@@ -29,7 +29,7 @@ size_t IRGenerator::get_or_add_name(std::vector<std::string>& names, const std::
 
 // 辅助函数：获取常量在curr_const中的索引（不存在则添加）
 size_t IRGenerator::get_or_add_const(model::Object* obj) {
-    obj->mark_as_important();
+    if (!model::is_imm_int(obj)) obj->mark_as_important();
     const auto it = std::find(Vm::const_pool.begin(), Vm::const_pool.end(), obj);
     if (it != Vm::const_pool.end()) {
         return std::distance(Vm::const_pool.begin(), it);
@@ -84,13 +84,15 @@ model::CodeObject* IRGenerator::gen(std::unique_ptr<BlockStmt> ast_into, const s
     return code_obj;
 }
 
-model::Int* IRGenerator::make_int_obj(const NumberExpr* num_expr) {
+model::Object* IRGenerator::make_int_obj(const NumberExpr* num_expr) {
     DEBUG_OUTPUT("making int object...");
     assert(num_expr);
     auto the_num = dep::BigInt(num_expr->value);
-    if (the_num >= 0 and the_num < 201) {
-        auto obj = Vm::small_int_pool[the_num.to_unsigned_long_long()];
-        return obj;
+
+    // 机器字范围内的字面量直接作为立即数放入常量池
+    int64_t small_val;
+    if (the_num.try_to_int64(small_val) and model::fits_imm_int(small_val)) {
+        return model::make_imm_int(small_val);
     }
 
     auto int_obj = new model::Int( the_num );
@@ -105,6 +107,14 @@ model::Decimal* IRGenerator::make_decimal_obj(const DecimalExpr* dec_expr) {
     return decimal_obj;
 }
 
+model::Float* IRGenerator::make_float_obj(const FloatExpr* float_expr) {
+    DEBUG_OUTPUT("making float object...");
+    // 去掉f后缀; 超出范围的字面量得到inf
+    const std::string digits = float_expr->value.substr(0, float_expr->value.size() - 1);
+    auto float_obj = new model::Float(std::strtod(digits.c_str(), nullptr));
+    return float_obj;
+}
+
 model::String* IRGenerator::make_string_obj(const StringExpr* str_expr) {
     DEBUG_OUTPUT("making string object...");
     assert(str_expr);
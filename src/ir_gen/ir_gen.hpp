@@ -28,12 +28,12 @@ struct CodeChunk {
     std::vector<std::string> attr_names;
     std::vector<std::string> free_names;
 
-    std::vector<Instruction> code_list;
+    std::vector<IrInstruction> code_list;
     std::vector<LoopInfo> loop_info_stack;
     std::vector<model::UpValue> upvalues;
 
     std::vector<model::ExceptionTable> exception_tables;
-    std::vector<Instruction> ensure_stmts;
+    std::vector<IrInstruction> ensure_stmts;
 };
 
 class IRGenerator {
@@ -65,8 +65,9 @@ private:
     void gen_object_stmt(ObjectStmt* stmt);
     void gen_while(WhileStmt* while_stmt);
 
-    static model::Int* make_int_obj(const NumberExpr* num_expr);
+    static model::Object* make_int_obj(const NumberExpr* num_expr);
     static model::Decimal* make_decimal_obj(const DecimalExpr* dec_expr);
+    static model::Float* make_float_obj(const FloatExpr* float_expr);
     static model::String* make_string_obj(const StringExpr* str_expr);
 };
 
@@ -38,6 +38,11 @@ public:
         : std::runtime_error(msg) {}
 };
 
+///| 异常处理位置在外层分派循环的栈帧中时, 内层run_frames弹出自己的栈帧后抛出,
+///| 穿过调用它的原生代码(各自释放临时值)到达外层run_frames, 由其继续展开.
+///| 不继承std::exception, 以免被原生库的通用catch拦截
+class KizUnwindSignal final {};
+
 class NativeFuncError final : public std::runtime_error {
 public:
     std::string name;
@@ -25,7 +25,7 @@ enum class TokenType {
     // 赋值运算符
     Assign,
     // 字面量
-    Number, Decimal, String,
+    Number, Decimal, Float, String,
 
     // F-String
     FStringStart,    // f-string 起始标记
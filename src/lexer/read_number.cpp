@@ -60,8 +60,13 @@ void Lexer::read_num() {
         }
     }
 
-    // 判定类型
+    // 判定类型: 后缀f表示二进制浮点数(Float), 如 1.5f, 2f, 1e-3f
     TokenType type = (has_sci || has_dot) ? TokenType::Decimal : TokenType::Number;
+    if (char_pos_ < src_.size() && src_[char_pos_] == 'f'
+        && !(char_pos_ + 1 < src_.size() && (src_[char_pos_ + 1].is_alnum() || src_[char_pos_ + 1] == '_'))) {
+        type = TokenType::Float;
+        next();
+    }
     emit_token(type, start_char, char_pos_, start_lno, start_col, lineno_, col_ - 1);
     curr_state_ = LexState::Start;
 }
@@ -13,6 +13,8 @@
 #include <winnls.h>
 #endif
 
+#include <charconv>
+#include <cstdlib>
 #include <iostream>
 
 #include "kiz.hpp"
@@ -119,7 +121,7 @@ extern "C" void handle_sigint(int sig) {
  * @param argv 命令行参数数组（来自main函数）
  * @return void
  */
-void args_parser(const int argc, char* argv[]) {
+void args_parser(int argc, char* argv[]) {
     // 程序名称
     enable_ansi_escape();
     // 注册平台特定的信号处理函数
@@ -143,6 +145,32 @@ void args_parser(const int argc, char* argv[]) {
     }
     const char* prog_name = argv[0];
 
+    // 前置选项, 只能出现在命令或路径之前:
+    //   --stats        退出时输出自适应特化统计
+    //   --max-depth=N  设置最大调用深度(1到Vm::max_call_depth_limit), 超出时抛出RecursionError
+    while (argc >= 2) {
+        const std::string opt = argv[1];
+        if (opt == "--stats") {
+            std::atexit([] { kiz::Vm::dump_quicken_stats(std::cerr); });
+        } else if (opt.starts_with("--max-depth=")) {
+            const std::string value = opt.substr(std::string("--max-depth=").size());
+            size_t depth = 0;
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), depth);
+            if (ec != std::errc() or ptr != value.data() + value.size()
+                or depth == 0 or depth > kiz::Vm::max_call_depth_limit) {
+                std::cerr << "invalid value for --max-depth: '" << value << "' (expect 1 to "
+                          << kiz::Vm::max_call_depth_limit << ")" << std::endl;
+                std::exit(1);
+            }
+            kiz::Vm::max_call_depth = depth;
+        } else {
+            break;
+        }
+        argv[1] = argv[0];
+        --argc;
+        ++argv;
+    }
+
     // 无参数：默认启动REPL
     if (argc == 1) {
         ui::Repl repl;
@@ -258,6 +286,20 @@ the kiz cmd help
   | > kiz demo.kiz    |
   ----------------------
 
+- --stats
+  print specialization (quickening) hit/miss statistics on exit
+  like this
+  ------------------------------
+  | > kiz --stats demo.kiz    |
+  ------------------------------
+
+- --max-depth=N
+  set the maximum call depth (default 1000, at most 4000000), deeper calls raise RecursionError
+  like this
+  ------------------------------------
+  | > kiz --max-depth=5000 demo.kiz |
+  ------------------------------------
+
 - version
   show the version of kiz
   Type version to see the version of kiz
@@ -7,21 +7,38 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
 #include <format>
 #include <fstream>
 #include <functional>
 #include <iomanip>
+#include <memory>
+#include <new>
 #include <ranges>
+#include <span>
 #include <utility>
 
 #include "../kiz.hpp"
 #include "../vm/vm.hpp"
+#include "shape.hpp"
+#include "slab.hpp"
 #include "../../depends/hashmap.hpp"
 #include "../../depends/bigint.hpp"
 #include "../../depends/decimal.hpp"
 #include "../../depends/dict.hpp"
+#include "../../depends/cow.hpp"
 
+// 引用计数默认为普通整数: VM全部状态为静态成员, 只在一个线程上运行, 增减计数不需要lock前缀.
+// 定义KIZ_ATOMIC_REFCOUNT=1时改用原子计数, 但只有引用计数的增减是原子的: slab空闲链表、分代GC链表、
+// 延迟释放队列、proto_epoch、内置魔术方法守卫、decimal上下文等全局状态都没有同步,
+// 因此仍不能在多个线程间并发使用对象或VM, 跨线程共享需要嵌入方自行加锁串行化
+#if !defined(KIZ_ATOMIC_REFCOUNT)
+#define KIZ_ATOMIC_REFCOUNT 0
+#endif
 
 namespace model {
 
@@ -77,26 +94,153 @@ struct ExceptionTable {
     size_t mismatch_pc;
 };
 
+// 原型版本号: 任何原型对象(曾被用作__parent__的对象)的属性表发生变化或原型被销毁时递增,
+// 属性内联缓存记录填充时的版本号, 不一致即失效
+inline uint64_t proto_epoch = 0;
+
+class Object;
+
+// ========================= 循环垃圾回收登记表 =========================
+// 可能参与引用环的对象(普通对象/List/Dictionary/Function, 以及被添加了属性的其他对象)
+// 按代登记在这里, 由vm/gc.cpp中的回收器对年轻代做试删除, 存活者晋升到下一代
+constexpr uint8_t gc_untracked = UINT8_MAX;
+
+struct GcGeneration {
+    // 不使用std::vector: 登记表不能在静态析构阶段先于对象被销毁
+    Object** items = nullptr;
+    uint32_t size = 0;
+    uint32_t capacity = 0;
+
+    inline void push(Object* o, uint8_t gen);
+    inline void remove(Object* o);
+};
+
+inline GcGeneration gc_generations[kiz::gc_generation_count];
+inline size_t gc_young_count = 0;  // 上次回收后第0代的净增对象数, 超过阈值时在安全点触发回收
+
+// ========================= 魔术方法槽位 =========================
+///| 由运算符/VM内部调用的方法, 顺序与magic_names一致
+enum class Magic : uint8_t {
+    Add, Sub, Mul, Div, Pow, Mod, Neg,
+    Eq, Gt, Lt,
+    Str, Dstr, Bool, GetItem, SetItem, Contains, Next, Hash,
+    Count
+};
+
+constexpr size_t magic_count = static_cast<size_t>(Magic::Count);
+
+inline constexpr std::array<std::string_view, magic_count> magic_names = {
+    "__add__", "__sub__", "__mul__", "__div__", "__pow__", "__mod__", "__neg__",
+    "__eq__", "__gt__", "__lt__",
+    "__str__", "__dstr__", "__bool__", "__getitem__", "__setitem__", "contains", "__next__", "__hash__"
+};
+
+///| 按方法名查槽位, 不是魔术方法返回Magic::Count
+inline Magic magic_from_name(const std::string_view name) {
+    for (size_t i = 0; i < magic_count; ++i) {
+        if (magic_names[i] == name) return static_cast<Magic>(i);
+    }
+    return Magic::Count;
+}
+
+///| 原型对象的魔术方法槽位表: 缓存从原型自身起沿原型链解析到的方法(借用, 不持有引用).
+///| 链上任何原型的属性变化都会递增proto_epoch, 版本号不一致时整表作废并按需重新解析
+struct MagicSlots {
+    std::array<Object*, magic_count> methods {};
+    uint32_t resolved = 0;  // 第i位为1表示methods[i]已解析(nullptr表示链上没有该方法)
+    uint64_t epoch = 0;
+};
+static_assert(magic_count <= 32);
+
+constexpr uint32_t magic_bit(const Magic magic) {
+    return 1u << static_cast<uint32_t>(magic);
+}
+
+// ========================= 内置类型的快速路径守卫 =========================
+// 运算符快速路径与特化指令(见vm/execute_unit.cpp)对内置类型直接按内置语义计算, 不查找方法.
+// 安装内置方法后记录每个内置原型沿原型链解析到的魔术方法; 常驻对象或原型对象的魔术方法或__parent__
+// 被setattr/delattr修改时builtin_magic_epoch递增, 下次检查时重新解析并与记录比较,
+// 只有方法被替换的类型的对应快速路径退回方法分派
+enum class BuiltinKind : uint8_t { Int, Float, Str, List, Count };
+constexpr size_t builtin_kind_count = static_cast<size_t>(BuiltinKind::Count);
+
+struct BuiltinMagicGuard {
+    uint64_t epoch = 0;
+    std::array<uint32_t, builtin_kind_count> intact {};  // 第i位为1: Magic i仍是安装时的方法
+    std::array<std::array<Object*, magic_count>, builtin_kind_count> installed {};
+};
+
+inline uint64_t builtin_magic_epoch = 0;
+inline BuiltinMagicGuard builtin_magic_guard;
+
 class Object {
-    std::atomic<size_t> refc_ = 0;
-    bool is_important = false; // 重要对象不参与make_refc/del_refc
 public:
-    dep::HashMap<Object*> attrs;
-
     // 对象类型枚举
-    enum class ObjectType {
-        Object, Nil, Bool, Int, String, Decimal,
+    enum class ObjectType : uint8_t {
+        Object, Nil, Bool, Int, String, Decimal, Float,
         List, Dictionary, CodeObject, Function,
-        NativeFunction, Module, Error
+        NativeFunction, Module, Error, FileHandle, Iterator, Range
     };
 
+private:
+#if KIZ_ATOMIC_REFCOUNT
+    std::atomic<size_t> refc_ = 0;
+#else
+    size_t refc_ = 0;
+#endif
+    const ObjectType type_ = ObjectType::Object;  // 构造时确定, 类型判断无需虚调用或RTTI
+    bool is_important = false; // 重要对象不参与make_refc/del_refc
+    bool is_proto = false;     // 曾被用作其他对象的__parent__
+    uint8_t gc_gen_ = gc_untracked;  // 所在代, 与gc_index_一起填充在类型标签后的空隙中
+    uint32_t gc_index_ = 0;          // 在所在代items中的下标
+
+    friend struct GcGeneration;
+
+    static void note_magic_patch(const std::string& name) {
+        if (name == "__parent__" or magic_from_name(name) != Magic::Count) ++builtin_magic_epoch;
+    }
+
+    static constexpr bool gc_tracked_type(const ObjectType type) {
+        return type == ObjectType::Object or type == ObjectType::List
+            or type == ObjectType::Dictionary or type == ObjectType::Function;
+    }
+public:
+    AttrTable attrs;
+    std::unique_ptr<MagicSlots> magic_slots;  // 仅在作为原型分派魔术方法时分配
+
     void mark_as_important() {
         is_important = true;
+        gc_untrack();
     }
 
-    // 获取实际类型的虚函数
-    [[nodiscard]] virtual ObjectType get_type() const {
-        return ObjectType::Object;
+    [[nodiscard]] bool important() const {
+        return is_important;
+    }
+
+    // 登记到第0代, 之后由回收器负责晋升
+    void gc_track() {
+        if (gc_gen_ != gc_untracked) return;
+        gc_generations[0].push(this, 0);
+        ++gc_young_count;
+    }
+
+    void gc_untrack() {
+        if (gc_gen_ == gc_untracked) return;
+        if (gc_gen_ == 0 and gc_young_count > 0) --gc_young_count;
+        gc_generations[gc_gen_].remove(this);
+    }
+
+    [[nodiscard]] uint8_t gc_generation() const {
+        return gc_gen_;
+    }
+
+    [[nodiscard]] uint32_t gc_index() const {
+        return gc_index_;
+    }
+
+    // 获取实际类型(读取对象头中的类型标签)
+    [[nodiscard]] ObjectType get_type() const {
+        return type_;
     }
 
     [[nodiscard]] size_t get_refc_() const {
@@ -105,37 +249,163 @@ public:
     
     void make_ref() {
         if (is_important) return;
+#if KIZ_ATOMIC_REFCOUNT
         refc_.fetch_add(1, std::memory_order_relaxed);
+#else
+        ++refc_;
+#endif
     }
     void del_ref() {
         if (is_important) return;
+#if KIZ_ATOMIC_REFCOUNT
         const size_t old_ref = refc_.fetch_sub(1, std::memory_order_acq_rel);
+#else
+        const size_t old_ref = refc_--;
+#endif
         if (old_ref == 1) {
             // std::cout << "deling object " << this->debug_string() << std::endl;
-            delete this;
+            destroy();
         }
     }
 
+    ///| 引用计数归零时销毁对象: 通常直接析构; 子对象很多或析构嵌套过深时,
+    ///| 先把子对象的引用移入延迟释放队列(见free_queue)再析构, 避免长停顿和栈溢出
+    inline void destroy();
+
     void attrs_insert(const std::string& name, Object* o) {
         assert(o != nullptr);
         o->make_ref();
+        if (is_proto) ++proto_epoch;
+        if (is_important or is_proto) [[unlikely]] note_magic_patch(name);
+        if (name == "__parent__") o->is_proto = true;
+        // 持有非常驻对象后可能成为引用环的一部分
+        if (!o->is_important and !is_important) gc_track();
         attrs.insert(name, o);
     }
 
+    bool attrs_del(const std::string& name) {
+        if (is_proto) ++proto_epoch;
+        if (is_important or is_proto) [[unlikely]] note_magic_patch(name);
+        return attrs.del(name);
+    }
+
     [[nodiscard]] virtual std::string debug_string() const {
         return "<Object at " + ptr_to_string(this) + ">";
     }
 
-    Object () = default;
+    // 所有对象类型都从按大小分级的对象池分配. 虚析构保证delete时传入的是实际类型的大小
+    static void* operator new(const size_t size) {
+        return slab_alloc(size);
+    }
+
+    static void operator delete(void* p, const size_t size) {
+        slab_free(p, size);
+    }
+
+    Object () {
+        gc_track();
+    }
+
+    explicit Object(const ObjectType type) : type_(type) {
+        if (gc_tracked_type(type)) gc_track();
+    }
 
     virtual ~Object() {
-        auto kv_list = attrs.to_vector();
-        for (const auto& obj : kv_list | std::views::values) {
+        gc_untrack();
+        if (is_proto) ++proto_epoch;
+        attrs.for_each([](const std::string&, Object* obj) {
             if (obj) obj->del_ref();
-        }
+        });
     }
 };
 
+inline void GcGeneration::push(Object* o, const uint8_t gen) {
+    if (size == capacity) {
+        const uint32_t new_capacity = capacity ? capacity * 2 : 256;
+        const auto grown = static_cast<Object**>(std::realloc(items, new_capacity * sizeof(Object*)));
+        if (!grown) throw std::bad_alloc();  // 失败时原登记表保持不变
+        items = grown;
+        capacity = new_capacity;
+    }
+    o->gc_gen_ = gen;
+    o->gc_index_ = size;
+    items[size++] = o;
+}
+
+///| 与末尾元素交换后弹出
+inline void GcGeneration::remove(Object* o) {
+    const auto last = items[--size];
+    items[o->gc_index_] = last;
+    last->gc_index_ = o->gc_index_;
+    o->gc_gen_ = gc_untracked;
+}
+
+// ========================= 立即数小整数 =========================
+// 最低位为1的Object*不指向堆对象, 高63位直接保存一个有符号整数.
+// 立即数只会出现在VM操作数栈(包括局部变量槽)和常量池中,
+// 离开操作数栈前(作为参数/属性/容器元素等)必须先用box_value装箱.
+constexpr int64_t imm_int_max = (static_cast<int64_t>(1) << 62) - 1;
+constexpr int64_t imm_int_min = -(static_cast<int64_t>(1) << 62);
+
+inline bool is_imm_int(const Object* o) {
+    return (reinterpret_cast<uintptr_t>(o) & 1) != 0;
+}
+
+inline bool fits_imm_int(const int64_t v) {
+    return v >= imm_int_min and v <= imm_int_max;
+}
+
+inline Object* make_imm_int(const int64_t v) {
+    assert(fits_imm_int(v));
+    return reinterpret_cast<Object*>((static_cast<uintptr_t>(v) << 1) | 1);
+}
+
+inline int64_t imm_int_value(const Object* o) {
+    return static_cast<int64_t>(reinterpret_cast<intptr_t>(o)) >> 1;
+}
+
+// 对可能是立即数(或空槽)的值增减引用计数
+inline void ref_value(Object* o) {
+    if (o and !is_imm_int(o)) o->make_ref();
+}
+
+inline void unref_value(Object* o) {
+    if (o and !is_imm_int(o)) o->del_ref();
+}
+
+// ========================= 类型标签转换 =========================
+// 按对象头中的类型标签判断与转换, 取代dynamic_cast. T需有静态成员TYPE
+
+///| 是否为T类型的堆对象, 空指针与立即数返回false
+template <typename T>
+bool is_type(const Object* o) {
+    return o and !is_imm_int(o) and o->get_type() == T::TYPE;
+}
+
+///| 检查的转换: 类型不符返回nullptr
+template <typename T>
+T* dyn(Object* o) {
+    return is_type<T>(o) ? static_cast<T*>(o) : nullptr;
+}
+
+template <typename T>
+const T* dyn(const Object* o) {
+    return is_type<T>(o) ? static_cast<const T*>(o) : nullptr;
+}
+
+///| 不检查的转换: 调用方已确认类型, 仅在调试构建中断言
+template <typename T>
+T* as(Object* o) {
+    assert(is_type<T>(o));
+    return static_cast<T*>(o);
+}
+
+template <typename T>
+const T* as(const Object* o) {
+    assert(is_type<T>(o));
+    return static_cast<const T*>(o);
+}
+
 inline auto based_based_obj = new Object();
 inline auto based_obj = new Object();
 inline auto based_list = new Object();
@@ -147,10 +417,12 @@ inline auto based_str = new Object();
 inline auto based_native_function = new Object();
 inline auto based_error = new Object();
 inline auto based_decimal = new Object();
+inline auto based_float = new Object();
 inline auto based_module = new Object();
 inline auto based_code_object = new Object();
 inline auto based_file_handle = new Object();
 inline auto based_range = new Object();
+inline auto based_iterator = new Object();
 inline auto stop_iter_signal = new Object();
 
 class List;
@@ -158,6 +430,7 @@ class List;
 class CodeObject : public Object {
 public:
     std::vector<kiz::Instruction> code;
+    kiz::PositionTable positions;
 
     std::vector<std::string> var_names;
     std::vector<std::string> attr_names;
@@ -168,20 +441,47 @@ public:
 
     std::vector<ExceptionTable> exception_tables;
     std::vector<kiz::Instruction> ensure_stmts;
+    kiz::PositionTable ensure_positions;
+
+    // 属性名的预计算哈希, 与attr_names一一对应
+    std::vector<size_t> attr_hashes;
+    // 按pc索引的属性内联缓存(仅GET_ATTR/CALL_METHOD使用), ensure代码另有一份
+    std::vector<kiz::AttrCache> attr_caches;
+    std::vector<kiz::AttrCache> ensure_attr_caches;
 
     static constexpr ObjectType TYPE = ObjectType::CodeObject;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit CodeObject(const std::vector<kiz::Instruction>& c,
+    explicit CodeObject(const std::vector<kiz::IrInstruction>& c,
         const std::vector<std::string>& v_n,
         const std::vector<std::string>& a_n,
         const std::vector<std::string>& f_n,
         const std::vector<UpValue>& u_v,
         const size_t l_c,
         std::vector<ExceptionTable> et,
-        std::vector<kiz::Instruction> e_s)
-            : code(c), var_names(v_n), attr_names(a_n), free_names(f_n), upvalues(u_v), locals_count(l_c),
-                 exception_tables(std::move(et)), ensure_stmts(std::move(e_s)) {}
+        const std::vector<kiz::IrInstruction>& e_s)
+            : Object(TYPE), var_names(v_n), attr_names(a_n), free_names(f_n), upvalues(u_v), locals_count(l_c),
+                 exception_tables(std::move(et)) {
+        kiz::assemble(c, code, positions);
+        kiz::assemble(e_s, ensure_stmts, ensure_positions);
+
+        // 异常处理代码的入口不是跳转指令的目标, 需单独告知借用标记
+        std::vector<size_t> handler_pcs;
+        for (const auto& table : exception_tables) {
+            table.handle_pc.for_each([&handler_pcs](const std::string&, const size_t pc) {
+                handler_pcs.push_back(pc);
+            });
+            handler_pcs.push_back(table.try_part_end_pc);
+            handler_pcs.push_back(table.mismatch_pc);
+        }
+        kiz::mark_borrowed_operands(code, handler_pcs);
+        kiz::mark_borrowed_operands(ensure_stmts, {});
+        attr_hashes.reserve(attr_names.size());
+        for (const auto& name : attr_names) {
+            attr_hashes.push_back(dep::hash_string(name));
+        }
+        attr_caches.resize(code.size());
+        ensure_attr_caches.resize(ensure_stmts.size());
+    }
 
     [[nodiscard]] std::string debug_string() const override {
         return "<CodeObject at " + ptr_to_string(this) + ">";
@@ -194,14 +494,13 @@ public:
     CodeObject* code = nullptr;
 
     static constexpr ObjectType TYPE = ObjectType::Module;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Module(std::string name, CodeObject *code) : path(std::move(name)), code(code) {
+    explicit Module(std::string name, CodeObject *code) : Object(TYPE), path(std::move(name)), code(code) {
         attrs_insert("__parent__", based_module);
         code->make_ref();
     }
 
-    explicit Module(std::string name) : path(std::move(name)) {
+    explicit Module(std::string name) : Object(TYPE), path(std::move(name)) {
         attrs_insert("__parent__", based_module);
     }
 
@@ -223,10 +522,9 @@ public:
     std::vector<Object*> free_vars;
 
     static constexpr ObjectType TYPE = ObjectType::Function;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
     explicit Function(std::string name, CodeObject *code, const size_t argc
-    ) : name(std::move(name)), code(code), argc(argc) {
+    ) : Object(TYPE), name(std::move(name)), code(code), argc(argc) {
         code->make_ref();
         attrs_insert("__parent__", based_function);
     }
@@ -243,17 +541,22 @@ public:
     }
 };
 
+///| 原生函数的快速调用约定: 参数是调用方操作数栈上的一段值的拷贝, 不构造参数列表.
+///| 参数中可能出现立即数小整数(用int_value_of/float_value_of等读取), 需要保存时先用box_value装箱
+using NativeFastFunc = Object* (*)(Object* self, std::span<Object* const> args);
+
 class NativeFunction : public Object {
 public:
     std::string name;
     std::function<Object*(Object*, List*)> func;
+    NativeFastFunc fast = nullptr;  // 非空时VM按快速约定调用, func仅为其List适配
 
     static constexpr ObjectType TYPE = ObjectType::NativeFunction;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit NativeFunction(std::function<Object*(Object*, List*)> func) : func(std::move(func)) {
+    explicit NativeFunction(std::function<Object*(Object*, List*)> func) : Object(TYPE), func(std::move(func)) {
         attrs_insert("__parent__", based_native_function);
     }
+    explicit NativeFunction(NativeFastFunc fast_func);
     [[nodiscard]] std::string debug_string() const override {
     return "<NativeFunction" +
            (name.empty() 
@@ -269,12 +572,11 @@ public:
     dep::BigInt val;
 
     static constexpr ObjectType TYPE = ObjectType::Int;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Int(dep::BigInt val) : val(std::move(val)) {
+    explicit Int(dep::BigInt val) : Object(TYPE), val(std::move(val)) {
         attrs_insert("__parent__", based_int);
     }
-    explicit Int() : val(dep::BigInt(0)) {
+    explicit Int() : Object(TYPE), val(dep::BigInt(0)) {
         attrs_insert("__parent__", based_int);
     }
     [[nodiscard]] std::string debug_string() const override {
@@ -282,21 +584,128 @@ public:
     }
 };
 
+// 立即数装箱为Int对象(0..200取自小整数池), 其他值原样返回; 不改变引用计数
+inline Object* box_value(Object* o) {
+    if (!is_imm_int(o)) return o;
+    const int64_t v = imm_int_value(o);
+    if (v >= 0 and v <= 200) return kiz::Vm::small_int_pool[v];
+    return new Int(dep::BigInt::from_int64(v));
+}
+
+// 由机器字整数构造整数值: 在立即数范围内不分配对象, 否则提升为BigInt
+inline Object* make_int_value(const int64_t v) {
+    if (fits_imm_int(v)) return make_imm_int(v);
+    return new Int(dep::BigInt::from_int64(v));
+}
+
+// 能放入立即数的Int对象转为立即数(用于参数进入局部变量), 其他值原样返回; 不改变引用计数
+inline Object* unbox_value(Object* o) {
+    int64_t v;
+    if (is_imm_int(o) or o->get_type() != Object::ObjectType::Int) return o;
+    if (!static_cast<Int*>(o)->val.try_to_int64(v) or !fits_imm_int(v)) return o;
+    return make_imm_int(v);
+}
+
+// 读取立即数或Int对象的机器字值, 非整数或超出int64_t范围返回false
+inline bool int_value_of(Object* o, int64_t& out) {
+    if (is_imm_int(o)) {
+        out = imm_int_value(o);
+        return true;
+    }
+    if (o->get_type() != Object::ObjectType::Int) return false;
+    return static_cast<Int*>(o)->val.try_to_int64(out);
+}
+
+///| 元素中是否有List或Dictionary(复制时需要逐个复制的可变容器)
+inline bool is_container(const Object* o) {
+    if (!o or is_imm_int(o)) return false;
+    const auto type = o->get_type();
+    return type == Object::ObjectType::List or type == Object::ObjectType::Dictionary;
+}
+
+///| 写时复制的存储与对象一样从按大小分级的对象池分配
+struct CowSlabAlloc {
+    static void* allocate(const size_t size) { return slab_alloc(size); }
+    static void deallocate(void* p, const size_t size) { slab_free(p, size); }
+};
+
+///| List的元素数组, 写时复制: 复制ListItems只共享存储, 第一次修改时才复制出独占的一份.
+///| 存储持有元素的引用(一份存储一次, 与共享它的List个数无关);
+///| 只读接口同std::vector, 修改必须经过mut()或下面的便捷方法, 元素的引用计数仍由调用方维护
+class ListItems {
+    dep::Cow<std::vector<Object*>, CowSlabAlloc> cow_;
+
+public:
+    using const_iterator = Object* const*;
+
+    ListItems() = default;
+    ListItems(const ListItems&) = default;
+    ListItems& operator=(const ListItems&) = delete;
+
+    [[nodiscard]] size_t size() const { return cow_.get().size(); }
+    [[nodiscard]] bool empty() const { return cow_.get().empty(); }
+    [[nodiscard]] Object* operator[](const size_t i) const { return cow_.get()[i]; }
+    [[nodiscard]] Object* front() const { return cow_.get().front(); }
+    [[nodiscard]] Object* back() const { return cow_.get().back(); }
+    [[nodiscard]] Object* const* data() const { return cow_.get().data(); }
+    [[nodiscard]] const_iterator begin() const { return data(); }
+    [[nodiscard]] const_iterator end() const { return data() + size(); }
+    [[nodiscard]] const std::vector<Object*>& vec() const { return cow_.get(); }
+
+    ///| 存储是否被多个List共享
+    [[nodiscard]] bool shared() const { return cow_.shared(); }
+    [[nodiscard]] const void* storage() const { return cow_.id(); }
+    [[nodiscard]] size_t owners() const { return cow_.owners(); }
+
+    ///| 独占存储后返回可修改的数组; 复制出的一份为每个元素增加引用
+    std::vector<Object*>& mut() {
+        return cow_.mut([](const std::vector<Object*>& items) {
+            for (const auto e : items) ref_value(e);
+        });
+    }
+
+    void push_back(Object* v) { mut().push_back(v); }
+    void pop_back() { mut().pop_back(); }
+    void reserve(const size_t n) {
+        if (n > 0) mut().reserve(n);
+    }
+    void clear() {
+        if (!empty()) mut().clear();
+    }
+
+    ///| 是否含有嵌套容器, 结果缓存在存储上直到下一次修改
+    [[nodiscard]] bool has_containers() const {
+        auto& hint = cow_.hint();
+        if (hint < 0) hint = std::ranges::any_of(cow_.get(), is_container) ? 1 : 0;
+        return hint == 1;
+    }
+
+    ///| 清空元素但不释放引用: 独占时元素的引用转交调用方, 共享时引用仍归其他List所有
+    void forget() { cow_.reset(); }
+};
+
 class List : public Object {
 public:
-    std::vector<Object*> val;
+    ListItems val;
 
     static constexpr ObjectType TYPE = ObjectType::List;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit List(const std::vector<Object*>& val_){
-        for (auto v: val_) {
-            v->make_ref();
-            val.push_back(v);
+    explicit List(const std::vector<Object*>& val_) : Object(TYPE) {
+        if (!val_.empty()) {
+            // 空List使用常驻的空存储, 不分配
+            auto& items = val.mut();
+            items.reserve(val_.size());
+            for (auto v: val_) {
+                v->make_ref();
+                items.push_back(v);
+            }
         }
         attrs_insert("__parent__", based_list);
-        auto zero = kiz::Vm::small_int_pool[0];
-        attrs_insert("__current_index__", zero);
+    }
+
+    ///| 与另一个List共享元素存储(写时复制), O(1); 属性不复制
+    explicit List(const List& other) : Object(TYPE), val(other.val) {
+        attrs_insert("__parent__", based_list);
     }
     [[nodiscard]] std::string debug_string() const override {
         std::string result = "[";
@@ -315,18 +724,23 @@ public:
     }
 
     ~List() override {
+        if (val.shared()) return;  // 共享的存储及其元素的引用由最后一个List释放
         for (auto elem : val) {
             if (elem) elem->del_ref();
         }
     }
 };
 
+inline NativeFunction::NativeFunction(const NativeFastFunc fast_func)
+    : Object(TYPE), func([fast_func](Object* self, List* args) { return fast_func(self, args->val); }), fast(fast_func) {
+    attrs_insert("__parent__", based_native_function);
+}
+
 class Decimal : public Object {
 public:
     dep::Decimal val;
     static constexpr ObjectType TYPE = ObjectType::Decimal;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
-    explicit Decimal(dep::Decimal val) : val(std::move(val)) {
+    explicit Decimal(dep::Decimal val) : Object(TYPE), val(std::move(val)) {
         attrs_insert("__parent__", based_decimal);
     }
     [[nodiscard]] std::string debug_string() const override {
@@ -334,65 +748,351 @@ public:
     }
 };
 
+// 浮点数的最短往返表示; 整数值补".0"以区别于Int
+inline std::string float_to_string(const double val) {
+    if (std::isnan(val)) return "nan";
+    if (std::isinf(val)) return val < 0 ? "-inf" : "inf";
+    char buf[32];
+    const auto res = std::to_chars(buf, buf + sizeof(buf), val);
+    std::string str(buf, res.ptr);
+    if (str.find_first_of(".e") == std::string::npos) str += ".0";
+    return str;
+}
+
+class Float : public Object {
+public:
+    double val;
+    static constexpr ObjectType TYPE = ObjectType::Float;
+    explicit Float(const double val) : Object(TYPE), val(val) {
+        attrs_insert("__parent__", based_float);
+    }
+    [[nodiscard]] std::string debug_string() const override {
+        return float_to_string(val);
+    }
+};
+
+// 读取Float或整数(立即数/Int)的double值, 其他类型返回false
+inline bool float_value_of(Object* o, double& out) {
+    if (is_imm_int(o)) {
+        out = static_cast<double>(imm_int_value(o));
+        return true;
+    }
+    switch (o->get_type()) {
+        case Object::ObjectType::Float:
+            out = static_cast<Float*>(o)->val;
+            return true;
+        case Object::ObjectType::Int:
+            out = static_cast<Int*>(o)->val.to_double();
+            return true;
+        default:
+            return false;
+    }
+}
+
 class String : public Object {
 public:
     std::string val;
 
     static constexpr ObjectType TYPE = ObjectType::String;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit String(std::string val) : val(std::move(val)) {
+    explicit String(std::string val) : Object(TYPE), val(std::move(val)) {
         attrs_insert("__parent__", based_str);
-        auto zero = kiz::Vm::small_int_pool[0];
-        attrs_insert("__current_index__", zero);
     }
     [[nodiscard]] std::string debug_string() const override {
         return '"'+val+'"';
     }
 };
 
+// 字典键的机器字哈希与相等性(定义在dict_methods.cpp):
+// String和Int键走快速路径, 其他类型调用__hash__/__eq__
+size_t hash_key(Object* key);
+bool key_equal(Object* a, Object* b);
+
+///| Dictionary的条目表, 写时复制(同ListItems): 存储持有每个键和值的引用,
+///| 只读接口同dep::Dict, 修改必须经过mut()
+class DictItems {
+public:
+    using KeyValue = std::pair<Object*, Object*>;
+    using Table = dep::Dict<KeyValue>;
+
+private:
+    dep::Cow<Table, CowSlabAlloc> cow_;
+
+public:
+    DictItems() = default;
+    DictItems(const DictItems&) = default;
+    DictItems& operator=(const DictItems&) = delete;
+
+    [[nodiscard]] size_t size() const { return cow_.get().size(); }
+    [[nodiscard]] size_t entry_count() const { return cow_.get().entry_count(); }
+    [[nodiscard]] const Table::Entry* entry_at(const size_t pos) const { return cow_.get().entry_at(pos); }
+    [[nodiscard]] std::vector<std::pair<size_t, KeyValue>> to_vector() const { return cow_.get().to_vector(); }
+
+    template <typename Eq>
+    [[nodiscard]] const Table::Entry* find(const size_t hash, Eq&& eq) const {
+        return cow_.get().find(hash, std::forward<Eq>(eq));
+    }
+    [[nodiscard]] size_t position(const Table::Entry* entry) const { return cow_.get().position(entry); }
+
+    template <typename F>
+    void for_each(F&& f) const { cow_.get().for_each(std::forward<F>(f)); }
+
+    [[nodiscard]] bool shared() const { return cow_.shared(); }
+    [[nodiscard]] const void* storage() const { return cow_.id(); }
+    [[nodiscard]] size_t owners() const { return cow_.owners(); }
+
+    void reserve(const size_t n) {
+        if (n > 0) mut().reserve(n);
+    }
+
+    ///| 独占存储后返回可修改的条目表; 复制出的一份为每个键和值增加引用
+    Table& mut() {
+        return cow_.mut([](const Table& table) {
+            table.for_each([](size_t, const KeyValue& kv) {
+                ref_value(kv.first);
+                ref_value(kv.second);
+            });
+        });
+    }
+
+    ///| 值中是否含有嵌套容器, 结果缓存在存储上直到下一次修改
+    [[nodiscard]] bool has_containers() const {
+        auto& hint = cow_.hint();
+        if (hint < 0) {
+            hint = 0;
+            cow_.get().for_each([&hint](size_t, const KeyValue& kv) {
+                if (is_container(kv.second)) hint = 1;
+            });
+        }
+        return hint == 1;
+    }
+
+    ///| 清空条目但不释放引用, 语义同ListItems::forget
+    void forget() { cow_.reset(); }
+
+    ///| 固定一份存储: 持有期间对原DictItems的修改都会复制出新的一份, 固定的存储保持不变.
+    ///| 用于在调用用户代码(键的__eq__等)期间读取条目; 固定者是最后一个共享者时代为释放其中的引用
+    class Pin {
+        dep::Cow<Table, CowSlabAlloc> cow_;
+
+    public:
+        explicit Pin(const DictItems& items) : cow_(items.cow_) {}
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+
+        ~Pin() {
+            if (cow_.shared()) return;
+            cow_.get().for_each([](size_t, const KeyValue& kv) {
+                unref_value(kv.first);
+                unref_value(kv.second);
+            });
+        }
+
+        [[nodiscard]] const Table& get() const { return cow_.get(); }
+        [[nodiscard]] const void* storage() const { return cow_.id(); }
+    };
+};
+
 class Dictionary : public Object {
 public:
-    dep::Dict<std::pair<Object*, Object*>> val;
+    using KeyValue = DictItems::KeyValue;
+    using Entry = DictItems::Table::Entry;
+
+    DictItems val;
     static constexpr ObjectType TYPE = ObjectType::Dictionary;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Dictionary(dep::Dict<std::pair<Object*, Object*>> val_) : val(std::move(val_)) {
-        for (auto& kv_pair : val_.to_vector() | std::views::values) {
-            if (kv_pair.first) kv_pair.first->make_ref();
-            if (kv_pair.second) kv_pair.second->make_ref();
-        }
+    explicit Dictionary() : Object(TYPE) {
         attrs_insert("__parent__", based_dict);
-        auto zero = kiz::Vm::small_int_pool[0];
-        attrs_insert("__current_index__", zero);
     }
-    explicit Dictionary() {
+
+    ///| 与另一个Dictionary共享条目存储(写时复制), O(1); 属性不复制
+    explicit Dictionary(const Dictionary& other) : Object(TYPE), val(other.val) {
         attrs_insert("__parent__", based_dict);
-        auto zero = kiz::Vm::small_int_pool[0];
-        attrs_insert("__current_index__", zero);
+    }
+
+    static constexpr size_t npos = SIZE_MAX;
+
+    ///| 查找键, 不存在返回nullptr; 返回的条目在下一次插入前有效
+    [[nodiscard]] const Entry* find(Object* key) const {
+        return find_hashed(key, hash_key(key));
+    }
+
+    [[nodiscard]] const Entry* find_hashed(Object* key, const size_t hash) const {
+        const size_t pos = locate(key, hash);
+        return pos == npos ? nullptr : val.entry_at(pos);
+    }
+
+    ///| 键所在条目在条目数组中的位置, 不存在返回npos.
+    ///| 键的__eq__可以执行任意代码, 包括修改本字典: 探测在固定的存储上进行(修改只会复制出新的一份).
+    ///| 结束后若本字典已换成另一份存储, 按键对象的身份在新存储上重新定位(不再调用__eq__):
+    ///| 找到的键已被删除时视为不存在
+    [[nodiscard]] size_t locate(Object* key, const size_t hash) const {
+        const DictItems::Pin pinned(val);
+        const auto& table = pinned.get();
+        const auto entry = table.find(hash, [key](const KeyValue& kv) { return key_equal(kv.first, key); });
+        if (pinned.storage() == val.storage()) [[likely]] return entry ? table.position(entry) : npos;
+
+        Object* const same = entry ? entry->value.first : key;
+        const auto current = val.find(hash, [same](const KeyValue& kv) { return kv.first == same; });
+        return current ? val.position(current) : npos;
+    }
+
+    ///| 插入或更新键值对, 键已存在时保留原键对象和原有位置
+    void insert(Object* key, Object* value) {
+        insert_hashed(key, value, hash_key(key));
+    }
+
+    void insert_hashed(Object* key, Object* value, const size_t hash) {
+        // 查找可能调用用户代码(并抛出异常), 结束后才取得可修改的条目表和引用; 此后不再调用用户代码, 位置保持有效
+        const size_t pos = locate(key, hash);
+        auto& table = val.mut();
+        value->make_ref();
+        if (pos != npos) {
+            // 先持有新值再释放旧值, 两者相同时不会被提前释放
+            auto& entry = table.entry_ref(pos);
+            entry.value.second->del_ref();
+            entry.value.second = value;
+            return;
+        }
+        key->make_ref();
+        table.append(hash, KeyValue{key, value});
     }
 
     [[nodiscard]] std::string debug_string() const override {
         std::string result = "{";
-        auto kv_list = val.to_vector();
-        size_t i = 0;
-        for (auto& kv_pair : kv_list | std::views::values) {
-            result += kv_pair.first->debug_string() + ": " + kv_pair.second->debug_string();
-            if (i != kv_list.size() - 1) {
-                result += ", ";
-            }
-            ++i;
-        }
+        bool first = true;
+        val.for_each([&](size_t, const KeyValue& kv) {
+            if (!first) result += ", ";
+            result += kv.first->debug_string() + ": " + kv.second->debug_string();
+            first = false;
+        });
         result += "}";
         return result;
     }
 
     ~Dictionary() override {
-        auto kv_list = val.to_vector();
-        for (auto& kv_pair : kv_list | std::views::values) {
-            if (kv_pair.first) kv_pair.first->del_ref();
-            if (kv_pair.second) kv_pair.second->del_ref();
+        if (val.shared()) return;  // 共享的存储由最后一个Dictionary释放
+        val.for_each([](size_t, const KeyValue& kv) {
+            kv.first->del_ref();
+            kv.second->del_ref();
+        });
+    }
+};
+
+///| 惰性整数区间[start, stop), 步长step(非0): 不保存元素, 长度、包含判断与下标访问都是O(1)
+class Range : public Object {
+public:
+    int64_t start;
+    int64_t step;
+    int64_t stop;
+
+    static constexpr ObjectType TYPE = ObjectType::Range;
+
+    Range(const int64_t start, const int64_t step, const int64_t stop)
+        : Object(TYPE), start(start), step(step), stop(stop) {
+        attrs_insert("__parent__", based_range);
+    }
+
+    [[nodiscard]] uint64_t size() const {
+        // 差值用无符号数计算, 端点接近int64_t边界时也不溢出
+        if (step > 0) {
+            if (start >= stop) return 0;
+            return (static_cast<uint64_t>(stop) - static_cast<uint64_t>(start) - 1) / static_cast<uint64_t>(step) + 1;
+        }
+        if (start <= stop) return 0;
+        return (static_cast<uint64_t>(start) - static_cast<uint64_t>(stop) - 1) / (0 - static_cast<uint64_t>(step)) + 1;
+    }
+
+    ///| 第i个元素, 调用方保证i < size()
+    [[nodiscard]] int64_t at(const uint64_t i) const {
+        return static_cast<int64_t>(static_cast<uint64_t>(start) + i * static_cast<uint64_t>(step));
+    }
+
+    [[nodiscard]] bool contains(const int64_t v) const {
+        if (step > 0 ? (v < start or v >= stop) : (v > start or v <= stop)) return false;
+        const uint64_t offset = step > 0 ? static_cast<uint64_t>(v) - static_cast<uint64_t>(start)
+                                         : static_cast<uint64_t>(start) - static_cast<uint64_t>(v);
+        const uint64_t abs_step = step > 0 ? static_cast<uint64_t>(step) : 0 - static_cast<uint64_t>(step);
+        return offset % abs_step == 0;
+    }
+
+    [[nodiscard]] std::string debug_string() const override {
+        return std::format("Range(start={}, step={}, end={})", start, step, stop);
+    }
+};
+
+///| 内置容器(List/Dictionary/String)与Range的原生迭代器, 由for循环的GET_ITER创建.
+///| 游标保存在迭代器自身, 同一容器上的多个循环互不干扰; 迭代器持有容器的引用,
+///| 每一步都重新检查边界, 循环体修改容器是安全的
+class Iterator : public Object {
+public:
+    Object* source;
+    size_t pos = 0;  // List/Range下标 / Dictionary条目数组位置 / String字节偏移
+
+    static constexpr ObjectType TYPE = ObjectType::Iterator;
+
+    explicit Iterator(Object* source) : Object(TYPE), source(source) {
+        source->make_ref();
+        attrs_insert("__parent__", based_iterator);
+    }
+
+    ///| 是否有对应的原生迭代器
+    static bool supports(const Object* obj) {
+        if (is_imm_int(obj)) return false;
+        const auto type = obj->get_type();
+        return type == ObjectType::List or type == ObjectType::Dictionary or type == ObjectType::String
+            or type == ObjectType::Range;
+    }
+
+    ///| Range的下一个整数, 结束返回false; 由FOR_ITER的计数循环快速路径直接使用
+    bool next_int(int64_t& out) {
+        const auto range = static_cast<Range*>(source);
+        if (pos >= range->size()) return false;
+        out = range->at(pos++);
+        return true;
+    }
+
+    ///| 下一个元素, 结束返回nullptr. List元素和Dictionary的值归容器所有, String每次返回新的单字符String,
+    ///| Range返回立即数(超出立即数范围时为新的Int)
+    Object* next() {
+        switch (source->get_type()) {
+        case ObjectType::List: {
+            const auto& items = static_cast<List*>(source)->val;
+            return pos < items.size() ? items[pos++] : nullptr;
+        }
+        case ObjectType::Dictionary: {
+            // 跳过删除留下的空洞
+            const auto& entries = static_cast<Dictionary*>(source)->val;
+            while (pos < entries.entry_count()) {
+                if (const auto entry = entries.entry_at(pos++)) return entry->value.second;
+            }
+            return nullptr;
+        }
+        case ObjectType::String: {
+            // 按UTF-8字符前进
+            const auto& str = static_cast<String*>(source)->val;
+            if (pos >= str.size()) return nullptr;
+            const auto lead = static_cast<unsigned char>(str[pos]);
+            const size_t len = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : 4;
+            const auto ch = new String(str.substr(pos, len));
+            pos += len;
+            return ch;
         }
+        case ObjectType::Range: {
+            int64_t v;
+            return next_int(v) ? make_int_value(v) : nullptr;
+        }
+        default:
+            return nullptr;
+        }
+    }
+
+    [[nodiscard]] std::string debug_string() const override {
+        return "<Iterator>";
+    }
+
+    ~Iterator() override {
+        if (source) source->del_ref();
     }
 };
 
@@ -401,9 +1101,8 @@ public:
     bool val;
 
     static constexpr ObjectType TYPE = ObjectType::Bool;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Bool(const bool val) : val(val) {
+    explicit Bool(const bool val) : Object(TYPE), val(val) {
         attrs_insert("__parent__", based_bool);
     }
     [[nodiscard]] std::string debug_string() const override {
@@ -415,9 +1114,8 @@ class Nil : public Object {
 public:
 
     static constexpr ObjectType TYPE = ObjectType::Nil;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Nil() : Object() {}
+    explicit Nil() : Object(TYPE) {}
     [[nodiscard]] std::string debug_string() const override {
         return "Nil";
     }
@@ -427,14 +1125,13 @@ class Error : public Object {
 public:
     std::vector<std::pair<std::string, err::PositionInfo>> positions;
     static constexpr ObjectType TYPE = ObjectType::Error;
-    [[nodiscard]] ObjectType get_type() const override { return TYPE; }
 
-    explicit Error(std::vector<std::pair<std::string, err::PositionInfo>> p) {
+    explicit Error(std::vector<std::pair<std::string, err::PositionInfo>> p) : Object(TYPE) {
         positions = std::move(p);
         attrs_insert("__parent__", based_error);
     }
 
-    explicit Error() {
+    explicit Error() : Object(TYPE) {
         attrs_insert("__parent__", based_error);
     }
 
@@ -447,7 +1144,8 @@ class FileHandle : public Object {
 public:
     std::fstream* file_handle = nullptr;
     bool is_closed = false;
-    explicit FileHandle() {
+    static constexpr ObjectType TYPE = ObjectType::FileHandle;
+    explicit FileHandle() : Object(TYPE) {
         attrs_insert("__parent__", based_file_handle);
     }
     ~FileHandle() override {
@@ -463,6 +1161,203 @@ public:
 
 };
 
+// ========================= 引用遍历 =========================
+
+///| 被多个List/Dictionary共享的元素存储(写时复制): 存储本身持有元素的引用, 一份存储一次
+struct SharedStorage {
+    const void* id = nullptr;  // 未共享时为nullptr
+    size_t owners = 0;         // 共享该存储的ListItems/DictItems个数
+};
+
+inline SharedStorage shared_storage(const Object* obj) {
+    if (is_imm_int(obj)) return {};
+    switch (obj->get_type()) {
+    case Object::ObjectType::List: {
+        const auto& items = static_cast<const List*>(obj)->val;
+        if (items.shared()) return {items.storage(), items.owners()};
+        break;
+    }
+    case Object::ObjectType::Dictionary: {
+        const auto& items = static_cast<const Dictionary*>(obj)->val;
+        if (items.shared()) return {items.storage(), items.owners()};
+        break;
+    }
+    default:
+        break;
+    }
+    return {};
+}
+
+///| 访问List元素或Dictionary键值, 不论存储是否共享
+template <typename F>
+void for_each_stored(Object* obj, F&& f) {
+    auto visit = [&f](Object* v) {
+        if (v and !is_imm_int(v)) f(v);
+    };
+    switch (obj->get_type()) {
+    case Object::ObjectType::List:
+        for (const auto e : static_cast<List*>(obj)->val) visit(e);
+        break;
+    case Object::ObjectType::Dictionary:
+        static_cast<Dictionary*>(obj)->val.for_each([&visit](size_t, const Dictionary::KeyValue& kv) {
+            visit(kv.first);
+            visit(kv.second);
+        });
+        break;
+    default:
+        break;
+    }
+}
+
+///| 访问对象持有(计入引用计数)的全部引用: 属性、List元素、Dictionary键值与闭包捕获变量.
+///| 共享存储中的元素不归任何一个容器单独所有, 这里不访问(见shared_storage)
+template <typename F>
+void for_each_referent(Object* obj, F&& f) {
+    auto visit = [&f](Object* v) {
+        if (v and !is_imm_int(v)) f(v);
+    };
+    obj->attrs.for_each([&visit](const std::string&, Object* v) { visit(v); });
+    switch (obj->get_type()) {
+    case Object::ObjectType::List:
+    case Object::ObjectType::Dictionary:
+        if (!shared_storage(obj).id) for_each_stored(obj, f);
+        break;
+    case Object::ObjectType::Function:
+        for (const auto fv : static_cast<Function*>(obj)->free_vars) visit(fv);
+        break;
+    case Object::ObjectType::Iterator:
+        visit(static_cast<Iterator*>(obj)->source);
+        break;
+    default:
+        break;
+    }
+}
+
+///| 清空对象持有的全部引用但不释放它们, 调用方需先用for_each_referent取出并负责释放
+inline void clear_referents(Object* obj) {
+    obj->attrs.clear();
+    switch (obj->get_type()) {
+    case Object::ObjectType::List:
+        static_cast<List*>(obj)->val.forget();
+        break;
+    case Object::ObjectType::Dictionary:
+        static_cast<Dictionary*>(obj)->val.forget();
+        break;
+    case Object::ObjectType::Function:
+        static_cast<Function*>(obj)->free_vars.clear();
+        break;
+    case Object::ObjectType::Iterator:
+        static_cast<Iterator*>(obj)->source = nullptr;
+        break;
+    default:
+        break;
+    }
+}
+
+///| 对象直接持有的引用数(上界), 用于判断析构的代价
+inline size_t referent_count(const Object* obj) {
+    size_t n = obj->attrs.size();
+    switch (obj->get_type()) {
+    case Object::ObjectType::List:
+        if (!static_cast<const List*>(obj)->val.shared()) n += static_cast<const List*>(obj)->val.size();
+        break;
+    case Object::ObjectType::Dictionary:
+        if (!static_cast<const Dictionary*>(obj)->val.shared()) n += 2 * static_cast<const Dictionary*>(obj)->val.size();
+        break;
+    case Object::ObjectType::Function:
+        n += static_cast<const Function*>(obj)->free_vars.size();
+        break;
+    case Object::ObjectType::Iterator:
+        n += 1;
+        break;
+    default:
+        break;
+    }
+    return n;
+}
+
+// ========================= 延迟释放队列 =========================
+// 析构会递归释放子对象: 拆除千万元素的容器会长时间阻塞解释器, 很深的对象链会耗尽C++栈.
+// 这两种情况下对象的子对象引用被整块移入队列, 对象本身立即析构; 队列在指令边界的安全点
+// 按预算分片释放(见execute_unit.cpp的GC_SAFE_POINT), 程序退出前全部释放
+constexpr size_t destroy_defer_children = 1024;  // 直接持有的引用达到该数量的对象延迟释放子对象
+constexpr size_t destroy_depth_limit = 64;        // 析构嵌套达到该深度时延迟释放子对象
+constexpr size_t free_slice_budget = 4096;        // 每个安全点的工作量上限: 释放的引用数加析构的对象数
+
+struct FreeQueue {
+    // 每个被拆除的对象贡献一块, 后进先出地释放; 首次使用时分配且不释放(理由同GcGeneration)
+    std::vector<std::vector<Object*>>* chunks = nullptr;
+    size_t pending = 0;      // 队列中尚未释放的引用数
+    size_t depth = 0;        // 当前析构嵌套深度
+    size_t queued = 0;       // 累计移入队列的引用数
+    size_t released = 0;     // 累计从队列释放的引用数
+    size_t freed = 0;        // 累计在释放队列时析构的对象数
+    size_t destroyed = 0;    // 累计析构的对象数(包括直接析构的)
+    size_t max_pending = 0;  // 队列长度的峰值
+};
+
+inline FreeQueue free_queue;
+
+///| 把对象持有的引用整块移入队列; 独占的List元素数组直接转移, 不逐个复制
+inline void defer_referents(Object* obj) {
+    std::vector<Object*> chunk;
+    if (obj->get_type() == Object::ObjectType::List and !static_cast<List*>(obj)->val.shared()) {
+        chunk = std::move(static_cast<List*>(obj)->val.mut());
+        std::erase_if(chunk, [](const Object* v) { return !v or is_imm_int(v); });
+        obj->attrs.for_each([&chunk](const std::string&, Object* v) {
+            if (v and !is_imm_int(v)) chunk.push_back(v);
+        });
+    } else {
+        chunk.reserve(referent_count(obj));
+        for_each_referent(obj, [&chunk](Object* v) { chunk.push_back(v); });
+    }
+    clear_referents(obj);
+    if (chunk.empty()) return;
+
+    if (!free_queue.chunks) free_queue.chunks = new std::vector<std::vector<Object*>>();
+    free_queue.pending += chunk.size();
+    free_queue.queued += chunk.size();
+    free_queue.max_pending = std::max(free_queue.max_pending, free_queue.pending);
+    free_queue.chunks->push_back(std::move(chunk));
+}
+
+///| 从队列释放引用, 直到工作量达到budget或队列为空. 每释放一个引用计1, 由此析构的每个对象再计1:
+///| 只减少计数的引用也要计入, 否则指向存活对象的长队列会在一个分片内全部处理.
+///| 释放时新产生的延迟块排在最后, 先于更早的块处理
+inline void drain_free_queue(const size_t budget) {
+    const size_t start = free_queue.destroyed;
+    size_t spent = 0;
+    while (spent < budget and free_queue.pending > 0) {
+        auto& chunk = free_queue.chunks->back();
+        Object* obj = chunk.back();
+        chunk.pop_back();
+        // 先移除空块再释放: 释放可能追加新块, 使chunk失效
+        if (chunk.empty()) free_queue.chunks->pop_back();
+        --free_queue.pending;
+        ++free_queue.released;
+        const size_t destroyed = free_queue.destroyed;
+        obj->del_ref();
+        spent += 1 + (free_queue.destroyed - destroyed);
+    }
+    free_queue.freed += free_queue.destroyed - start;
+}
+
+inline void flush_free_queue() {
+    drain_free_queue(SIZE_MAX);
+}
+
+inline void Object::destroy() {
+    ++free_queue.destroyed;
+    if (free_queue.depth >= destroy_depth_limit or referent_count(this) >= destroy_defer_children) [[unlikely]] {
+        defer_referents(this);
+        delete this;
+        return;
+    }
+    ++free_queue.depth;
+    delete this;
+    --free_queue.depth;
+}
+
 inline auto unique_nil = new Nil();
 inline auto unique_false = new Bool(false);
 inline auto unique_true = new Bool(true);
@@ -493,9 +1388,15 @@ inline auto create_nfunc(const std::function<Object*(Object*, List*)>& func, con
     return o;
 }
 
+inline auto create_nfunc(const NativeFastFunc func, const std::string& name="<unnamed>") {
+    auto o = new NativeFunction(func);
+    o->name = name;
+    return o;
+}
+
 
 inline auto cast_to_int(Object* o) {
-    auto obj = dynamic_cast<Int*>(o);
+    auto obj = dyn<Int>(o);
     if (!obj)
         throw NativeFuncError("TypeError", std::format(
             "fail to cast {} to Int", kiz::Vm::obj_to_debug_str(o)));
@@ -503,7 +1404,7 @@ inline auto cast_to_int(Object* o) {
 }
 
 inline auto cast_to_str(Object* o) {
-    auto obj = dynamic_cast<String*>(o);
+    auto obj = dyn<String>(o);
     if (!obj)
         throw NativeFuncError("TypeError", std::format(
             "fail to cast {} to Str", kiz::Vm::obj_to_debug_str(o)));
@@ -511,44 +1412,49 @@ inline auto cast_to_str(Object* o) {
 }
 
 inline auto cast_to_bool(Object* o) {
-    auto obj = dynamic_cast<Bool*>(o);
+    auto obj = dyn<Bool>(o);
     if (!obj)
         throw NativeFuncError("TypeError", std::format(
             "fail to cast {} to Bool", kiz::Vm::obj_to_debug_str(o)));    return obj;
 }
 
 inline auto cast_to_list(Object* o) {
-    auto obj = dynamic_cast<List*>(o);
+    auto obj = dyn<List>(o);
     if (!obj)
         throw NativeFuncError("TypeError", std::format(
             "fail to cast {} to List", kiz::Vm::obj_to_debug_str(o)));
     return obj;
 }
 
+///| 赋值时的值语义复制. 不含嵌套容器的List/Dictionary共享存储(写时复制), O(1);
+///| 含嵌套容器时逐个复制元素, 嵌套的容器同样尽量共享存储
 inline auto copy_if_mutable(Object* obj) -> Object* {
     switch (obj->get_type()) {
 
     case Object::ObjectType::List: {
+        const auto list = cast_to_list(obj);
+        if (!list->val.has_containers()) return new List(*list);
         std::vector<Object*> new_val;
-        for (auto val : cast_to_list(obj)->val) {
+        new_val.reserve(list->val.size());
+        for (auto val : list->val) {
             new_val.push_back(copy_if_mutable(val));
         }
         return new List(std::move(new_val));
     }
 
     case Object::ObjectType::Dictionary: {
-        std::vector<std::pair<
-            dep::BigInt, std::pair< Object*, Object* >
-        >> elem_list;
-        auto dict_obj = dynamic_cast<Dictionary*>(obj);
-        assert(dict_obj != nullptr);
-        for (auto& [_, kv_pair] : dict_obj->val.to_vector()) {
+        auto dict_obj = as<Dictionary>(obj);
+        if (!dict_obj->val.has_containers()) return new Dictionary(*dict_obj);
+        auto new_dict_obj = new Dictionary();
+        auto& table = new_dict_obj->val.mut();
+        table.reserve(dict_obj->val.size());
+        dict_obj->val.for_each([&](const size_t hash, const Dictionary::KeyValue& kv) {
             // key是hashable value, 也就是不可变对象, 可以引用传递, 应该没有神人为可变对象重载__hash__方法的
-            elem_list.emplace_back(_, std::pair{
-                kv_pair.first, copy_if_mutable(kv_pair.second)
-            });
-        }
-        auto new_dict_obj = new Dictionary(dep::Dict(elem_list));
+            auto value = copy_if_mutable(kv.second);
+            value->make_ref();
+            kv.first->make_ref();
+            table.append(hash, {kv.first, value});
+        });
         return new_dict_obj;
     }
 
@@ -559,4 +1465,10 @@ inline auto copy_if_mutable(Object* obj) -> Object* {
     }
 }
 
-};
\ No newline at end of file
+///| 内置类型kind的魔术方法(mask中的各位)是否都仍是安装时的方法
+inline bool magic_intact(const BuiltinKind kind, const uint32_t mask) {
+    if (builtin_magic_guard.epoch != builtin_magic_epoch) [[unlikely]] kiz::Vm::refresh_builtin_magic();
+    return (builtin_magic_guard.intact[static_cast<size_t>(kind)] & mask) == mask;
+}
+
+};
@@ -0,0 +1,218 @@
+/**
+ * @file shape.hpp
+ * @brief 隐藏类(Shape)与对象属性表(AttrTable)
+ *
+ * 属性插入顺序相同的对象共享同一个Shape, Shape记录属性名到槽位的映射,
+ * 属性值按槽位存放在对象自身的数组中(少量属性时直接内联在对象里);
+ * 删除属性、属性过多或同一Shape分支过多时, 该对象退化为字典模式
+ */
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../depends/hashmap.hpp"
+
+namespace model {
+
+class Object;
+
+///| 属性槽位: find返回指向槽位的指针, 通过->value读写
+struct AttrSlot {
+    Object* value;
+};
+
+class Shape {
+    std::vector<std::string> names_;   // 槽位 -> 属性名
+    std::vector<size_t> hashes_;       // 槽位 -> 属性名哈希
+    std::vector<Shape*> transitions_;  // 追加一个属性后得到的子Shape
+
+    Shape() = default;
+    Shape(const Shape& parent, const std::string& name, const size_t hash)
+        : names_(parent.names_), hashes_(parent.hashes_) {
+        names_.push_back(name);
+        hashes_.push_back(hash);
+    }
+
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+    // 超过上限的对象改用字典模式, 避免Shape树无限增长
+    static constexpr size_t max_slots = 32;
+    static constexpr size_t max_transitions = 64;
+
+    Shape(const Shape&) = delete;
+    Shape& operator=(const Shape&) = delete;
+
+    ///| 空Shape, 所有对象的初始Shape; Shape树常驻内存, 不释放
+    static Shape* root() {
+        static Shape root_shape;
+        return &root_shape;
+    }
+
+    [[nodiscard]] uint32_t slot_count() const {
+        return static_cast<uint32_t>(names_.size());
+    }
+
+    [[nodiscard]] const std::string& name_at(const uint32_t slot) const {
+        return names_[slot];
+    }
+
+    ///| 查找属性所在槽位, 不存在返回npos
+    [[nodiscard]] uint32_t find(const std::string& name, const size_t hash) const {
+        for (uint32_t i = 0; i < hashes_.size(); ++i) {
+            if (hashes_[i] == hash and names_[i] == name) return i;
+        }
+        return npos;
+    }
+
+    ///| 追加属性后的Shape, 超过上限返回nullptr
+    Shape* transition(const std::string& name, const size_t hash) {
+        for (const auto child : transitions_) {
+            if (child->hashes_.back() == hash and child->names_.back() == name) return child;
+        }
+        if (names_.size() >= max_slots or transitions_.size() >= max_transitions) return nullptr;
+        auto child = new Shape(*this, name, hash);
+        transitions_.push_back(child);
+        return child;
+    }
+};
+
+class AttrTable {
+    static constexpr uint32_t inline_capacity = 2;
+
+    Shape* shape_ = Shape::root();  // 字典模式下为nullptr
+    uint32_t count_ = 0;
+    uint32_t capacity_ = inline_capacity;
+    union {
+        AttrSlot inline_[inline_capacity];
+        AttrSlot* heap_;
+    };
+    dep::HashMap<AttrSlot>* dict_ = nullptr;
+
+    [[nodiscard]] AttrSlot* data() { return capacity_ == inline_capacity ? inline_ : heap_; }
+    [[nodiscard]] const AttrSlot* data() const { return capacity_ == inline_capacity ? inline_ : heap_; }
+
+    void reserve(const uint32_t n) {
+        if (n <= capacity_) return;
+        uint32_t new_capacity = capacity_ * 2;
+        while (new_capacity < n) new_capacity *= 2;
+        auto new_data = new AttrSlot[new_capacity];
+        std::copy_n(data(), count_, new_data);
+        if (capacity_ != inline_capacity) delete[] heap_;
+        heap_ = new_data;
+        capacity_ = new_capacity;
+    }
+
+    void to_dict() {
+        dict_ = new dep::HashMap<AttrSlot>();
+        for (uint32_t i = 0; i < count_; ++i) {
+            dict_->insert(shape_->name_at(i), data()[i]);
+        }
+        if (capacity_ != inline_capacity) delete[] heap_;
+        capacity_ = inline_capacity;
+        count_ = 0;
+        shape_ = nullptr;
+    }
+
+public:
+    AttrTable() : inline_{} {}
+    AttrTable(const AttrTable&) = delete;
+    AttrTable& operator=(const AttrTable&) = delete;
+
+    ~AttrTable() {
+        if (capacity_ != inline_capacity) delete[] heap_;
+        delete dict_;
+    }
+
+    [[nodiscard]] const Shape* shape() const { return shape_; }
+
+    ///| 仅Shape模式可用, 槽位由shape()->find得到
+    [[nodiscard]] AttrSlot& slot(const uint32_t idx) { return data()[idx]; }
+
+    [[nodiscard]] size_t size() const {
+        return dict_ ? dict_->size() : count_;
+    }
+
+    [[nodiscard]] AttrSlot* find(const std::string& name) {
+        return find_hashed(name, dep::hash_string(name));
+    }
+
+    [[nodiscard]] AttrSlot* find_hashed(const std::string& name, const size_t hash) {
+        if (dict_) {
+            const auto node = dict_->find_hashed(name, hash);
+            return node ? &node->value : nullptr;
+        }
+        const uint32_t idx = shape_->find(name, hash);
+        return idx == Shape::npos ? nullptr : &data()[idx];
+    }
+
+    void insert(const std::string& name, Object* value) {
+        const size_t hash = dep::hash_string(name);
+        if (!dict_) {
+            if (const uint32_t idx = shape_->find(name, hash); idx != Shape::npos) {
+                data()[idx].value = value;
+                return;
+            }
+            if (const auto next = shape_->transition(name, hash)) {
+                reserve(count_ + 1);
+                data()[count_++].value = value;
+                shape_ = next;
+                return;
+            }
+            to_dict();
+        }
+        dict_->insert(name, AttrSlot{value});
+    }
+
+    bool del(const std::string& name) {
+        if (!dict_) {
+            // Shape只支持追加, 删除属性的对象退化为字典模式
+            if (shape_->find(name, dep::hash_string(name)) == Shape::npos) return false;
+            to_dict();
+        }
+        return dict_->del(name);
+    }
+
+    ///| 清空所有属性并回到根Shape, 不释放属性值的引用(由调用方负责)
+    void clear() {
+        if (capacity_ != inline_capacity) delete[] heap_;
+        delete dict_;
+        dict_ = nullptr;
+        shape_ = Shape::root();
+        count_ = 0;
+        capacity_ = inline_capacity;
+    }
+
+    template <typename F>
+    void for_each(F&& f) const {
+        if (dict_) {
+            dict_->for_each([&f](const std::string& name, const AttrSlot& slot) { f(name, slot.value); });
+            return;
+        }
+        for (uint32_t i = 0; i < count_; ++i) f(shape_->name_at(i), data()[i].value);
+    }
+
+    [[nodiscard]] std::vector<std::pair<std::string, Object*>> to_vector() const {
+        std::vector<std::pair<std::string, Object*>> vec;
+        for_each([&vec](const std::string& name, Object* value) { vec.emplace_back(name, value); });
+        return vec;
+    }
+
+    [[nodiscard]] std::string to_string() const {
+        std::stringstream ss;
+        ss << "{ ";
+        bool first = true;
+        for_each([&](const std::string& name, Object* value) {
+            if (!first) ss << ", ";
+            ss << name << ": " << static_cast<void*>(value);
+            first = false;
+        });
+        ss << " }";
+        return ss.str();
+    }
+};
+
+} // namespace model
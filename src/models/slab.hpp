@@ -0,0 +1,99 @@
+/**
+ * @file slab.hpp
+ * @brief 对象内存池: 按大小分级的slab分配器
+ *
+ * 运行时对象(Int/Float/String/List/...)体积小、生命周期短, 每次都走全局分配器代价很高.
+ * 对象大小按16字节向上取整分级, 每级从64KB的slab中顺序切分, 释放的对象挂到本级的空闲链表上,
+ * 下次同级分配优先复用. 空闲链表与slab都是线程局部的; slab不归还给系统.
+ * 超过最大级别的对象(如CodeObject)直接使用全局分配器.
+ * 定义KIZ_NO_SLAB=1(AddressSanitizer下自动打开)时全部对象都走全局分配器,
+ * 释放的对象不再被复用, ASan才能发现运行时对象的释放后使用
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if !defined(KIZ_NO_SLAB)
+#if defined(__SANITIZE_ADDRESS__)
+#define KIZ_NO_SLAB 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define KIZ_NO_SLAB 1
+#endif
+#endif
+#endif
+#if !defined(KIZ_NO_SLAB)
+#define KIZ_NO_SLAB 0
+#endif
+
+namespace model {
+
+constexpr size_t slab_granularity = 16;
+constexpr size_t slab_class_count = 16;  // 最大级别: 256字节
+constexpr size_t slab_max_size = slab_granularity * slab_class_count;
+constexpr size_t slab_bytes = 64 * 1024;
+
+struct SlabClass {
+    void* free_list = nullptr;  // 空闲对象链表, 每个空闲对象的开头保存下一个空闲对象的地址
+    char* bump = nullptr;       // 当前slab中尚未切分部分的起点
+    char* bump_end = nullptr;
+
+    size_t slabs = 0;    // 已申请的slab数
+    size_t allocs = 0;   // 分配次数
+    size_t hits = 0;     // 其中由空闲链表满足的次数
+    size_t in_use = 0;   // 当前存活的对象数
+};
+
+inline thread_local SlabClass slab_classes[slab_class_count];
+
+///| 大小为size的对象所在级别, 超出最大级别时返回slab_class_count
+constexpr size_t slab_class_of(const size_t size) {
+    return size == 0 ? 0 : (size - 1) / slab_granularity;
+}
+
+inline void* slab_alloc(const size_t size) {
+    const size_t cls = slab_class_of(size);
+    if (cls >= slab_class_count) return ::operator new(size);
+
+    auto& c = slab_classes[cls];
+    ++c.allocs;
+    ++c.in_use;
+#if KIZ_NO_SLAB
+    return ::operator new(size);
+#endif
+    if (c.free_list) [[likely]] {
+        ++c.hits;
+        void* p = c.free_list;
+        c.free_list = *static_cast<void**>(p);
+        return p;
+    }
+    const size_t obj_size = (cls + 1) * slab_granularity;
+    if (c.bump + obj_size > c.bump_end) {
+        // 上一个slab剩余不足一个对象的部分直接放弃
+        c.bump = static_cast<char*>(::operator new(slab_bytes));
+        c.bump_end = c.bump + slab_bytes;
+        ++c.slabs;
+    }
+    void* p = c.bump;
+    c.bump += obj_size;
+    return p;
+}
+
+inline void slab_free(void* p, const size_t size) {
+    const size_t cls = slab_class_of(size);
+    if (cls >= slab_class_count) {
+        ::operator delete(p);
+        return;
+    }
+    auto& c = slab_classes[cls];
+    --c.in_use;
+#if KIZ_NO_SLAB
+    ::operator delete(p);
+    return;
+#endif
+    *static_cast<void**>(p) = c.free_list;
+    c.free_list = p;
+}
+
+} // namespace model
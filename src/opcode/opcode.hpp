@@ -29,12 +29,29 @@ enum class Opcode : uint8_t {
     MAKE_LIST, MAKE_DICT,
     IMPORT,
     LOAD_ERROR,
-    CACHE_ITER, GET_ITER, POP_ITER, JUMP_IF_FINISH_ITER,
+    GET_ITER, FOR_ITER, POP_ITER,
 
     IS_CHILD, CREATE_OBJECT, COPY_TOP,
-    STOP, LOAD_FREE_VAR, LOAD_BUILTINS
+    STOP, LOAD_FREE_VAR, LOAD_BUILTINS,
+
+    // 自适应特化指令: 不由代码生成器产生, 只在运行时由通用指令原地改写而来
+    // 守卫失败时改写回对应的通用指令
+    OP_ADD_INT_INT, OP_SUB_INT_INT, OP_MUL_INT_INT,
+    OP_EQ_INT_INT, OP_GT_INT_INT, OP_LT_INT_INT,
+    OP_GE_INT_INT, OP_LE_INT_INT, OP_NE_INT_INT,
+    OP_ADD_STR_STR, OP_EQ_STR_STR,
+    GET_ITEM_LIST_INT,
+
+    // 借用加载: 不由代码生成器产生, 由mark_borrowed_operands在汇编后改写LOAD_VAR/LOAD_CONST而来,
+    // 压栈时不增加引用计数, 消费它的下一条指令按opn_b中的标记跳过对应的减引用
+    LOAD_VAR_BORROW, LOAD_CONST_BORROW,
+
+    POP_TOP
 };
 
+// 指令总数, 新增指令需追加在枚举末尾并同步更新此处(直接线程化分派表依赖该值)
+constexpr size_t opcode_count = static_cast<size_t>(Opcode::POP_TOP) + 1;
+
 inline std::string opcode_to_string(Opcode opc) {
     switch (opc) {
     // 算术运算
@@ -88,10 +105,9 @@ inline std::string opcode_to_string(Opcode opc) {
     case Opcode::MAKE_LIST:   return "MAKE_LIST";
     case Opcode::MAKE_DICT:   return "MAKE_DICT";
 
-    case Opcode::CACHE_ITER: return "CACHE_ITER";
     case Opcode::GET_ITER:    return "GET_ITER";
-    case Opcode::POP_ITER:     return "POP_ITER";
-    case Opcode::JUMP_IF_FINISH_ITER:  return "JUMP_IF_FINISH_ITER";
+    case Opcode::FOR_ITER:    return "FOR_ITER";
+    case Opcode::POP_ITER:    return "POP_ITER";
 
     // 其他
     case Opcode::IMPORT:      return "IMPORT";
@@ -101,6 +117,23 @@ inline std::string opcode_to_string(Opcode opc) {
     case Opcode::STOP:        return "STOP";
     case Opcode::COPY_TOP:    return "COPY_TOP";
 
+    // 自适应特化指令
+    case Opcode::OP_ADD_INT_INT: return "OP_ADD_INT_INT";
+    case Opcode::OP_SUB_INT_INT: return "OP_SUB_INT_INT";
+    case Opcode::OP_MUL_INT_INT: return "OP_MUL_INT_INT";
+    case Opcode::OP_EQ_INT_INT:  return "OP_EQ_INT_INT";
+    case Opcode::OP_GT_INT_INT:  return "OP_GT_INT_INT";
+    case Opcode::OP_LT_INT_INT:  return "OP_LT_INT_INT";
+    case Opcode::OP_GE_INT_INT:  return "OP_GE_INT_INT";
+    case Opcode::OP_LE_INT_INT:  return "OP_LE_INT_INT";
+    case Opcode::OP_NE_INT_INT:  return "OP_NE_INT_INT";
+    case Opcode::OP_ADD_STR_STR: return "OP_ADD_STR_STR";
+    case Opcode::OP_EQ_STR_STR:  return "OP_EQ_STR_STR";
+    case Opcode::GET_ITEM_LIST_INT: return "GET_ITEM_LIST_INT";
+    case Opcode::LOAD_VAR_BORROW:   return "LOAD_VAR_BORROW";
+    case Opcode::LOAD_CONST_BORROW: return "LOAD_CONST_BORROW";
+    case Opcode::POP_TOP:           return "POP_TOP";
+
     // 兜底
     default:                  return "UNKNOWN_OPCODE(" + std::to_string(static_cast<int>(opc)) + ")";
     }
@@ -18,7 +18,7 @@ namespace kiz {
 enum class AstType {
     // 表达式类型（对应 Expr 子类）
     NilExpr, BoolExpr,
-    StringExpr, NumberExpr, DecimalExpr, ListExpr, IdentifierExpr,
+    StringExpr, NumberExpr, DecimalExpr, FloatExpr, ListExpr, IdentifierExpr,
     BinaryExpr, UnaryExpr,
     CallExpr,
     GetMemberExpr, GetItemExpr,
@@ -76,6 +76,16 @@ struct DecimalExpr final :  Expr {
     }
 };
 
+// 浮点数字面量(带f后缀, value含后缀)
+struct FloatExpr final :  Expr {
+    std::string value;
+    explicit FloatExpr(const err::PositionInfo& pos, std::string v)
+        : value(std::move(v)) {
+        this->pos = pos;
+        this->ast_type = AstType::FloatExpr;
+    }
+};
+
 // 空值字面量
 struct NilExpr final : Expr {
     explicit NilExpr(const err::PositionInfo& pos) {
@@ -247,6 +247,9 @@ std::unique_ptr<Expr> Parser::parse_primary() {
     if (tok.type == TokenType::Decimal) {
         return std::make_unique<DecimalExpr>(tok.pos, tok.text);
     }
+    if (tok.type == TokenType::Float) {
+        return std::make_unique<FloatExpr>(tok.pos, tok.text);
+    }
     if (tok.type == TokenType::String) {
         return std::make_unique<StringExpr>(tok.pos, tok.text);
     }
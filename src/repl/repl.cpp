@@ -218,7 +218,7 @@ void Repl::eval_and_print(const std::string& cmd, const size_t startline) {
     }
     auto stack_top = kiz::Vm::op_stack.back();
     if (stack_top != nullptr) {
-        if (not dynamic_cast<model::Nil*>(stack_top) and should_print) {
+        if ((model::is_imm_int(stack_top) or not model::dyn<model::Nil>(stack_top)) and should_print) {
             std::cout << kiz::Vm::obj_to_debug_str(stack_top) << std::endl;
         }
     }
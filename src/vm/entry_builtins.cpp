@@ -13,6 +13,7 @@ void Vm::entry_builtins() {
     model::unique_nil->attrs_insert("__parent__", model::based_obj);
     model::based_function->attrs_insert("__parent__", model::based_obj);
     model::based_decimal->attrs_insert("__parent__", model::based_obj);
+    model::based_float->attrs_insert("__parent__", model::based_obj);
     model::based_module->attrs_insert("__parent__", model::based_obj);
     model::based_dict->attrs_insert("__parent__", model::based_obj);
     model::based_list->attrs_insert("__parent__", model::based_obj);
@@ -23,6 +24,7 @@ void Vm::entry_builtins() {
     model::based_code_object->attrs_insert("__parent__", model::based_obj);
     model::based_file_handle->attrs_insert("__parent__", model::based_obj);
     model::based_range->attrs_insert("__parent__", model::based_obj);
+    model::based_iterator->attrs_insert("__parent__", model::based_obj);
 
     // Object 基类 方法
     model::based_obj->attrs_insert("__parent__", model::based_based_obj);
@@ -75,15 +77,33 @@ void Vm::entry_builtins() {
     model::based_decimal->attrs_insert("limit_div", model::create_nfunc(model::decimal_limit_div));
     model::based_decimal->attrs_insert("round_div", model::create_nfunc(model::decimal_round_div));
     model::based_decimal->attrs_insert("approx", model::create_nfunc(model::decimal_approx));
+    model::based_decimal->attrs_insert("round", model::create_nfunc(model::decimal_round));
+    model::based_decimal->attrs_insert("set_context", model::create_nfunc(model::decimal_set_context));
+    model::based_decimal->attrs_insert("get_context", model::create_nfunc(model::decimal_get_context));
+
+    // Float类型魔术方法
+    model::based_float->attrs_insert("__add__", model::create_nfunc(model::float_add));
+    model::based_float->attrs_insert("__sub__", model::create_nfunc(model::float_sub));
+    model::based_float->attrs_insert("__mul__", model::create_nfunc(model::float_mul));
+    model::based_float->attrs_insert("__div__", model::create_nfunc(model::float_div));
+    model::based_float->attrs_insert("__pow__", model::create_nfunc(model::float_pow));
+    model::based_float->attrs_insert("__mod__", model::create_nfunc(model::float_mod));
+    model::based_float->attrs_insert("__neg__", model::create_nfunc(model::float_neg));
+    model::based_float->attrs_insert("__gt__", model::create_nfunc(model::float_gt));
+    model::based_float->attrs_insert("__lt__", model::create_nfunc(model::float_lt));
+    model::based_float->attrs_insert("__eq__", model::create_nfunc(model::float_eq));
+    model::based_float->attrs_insert("__call__", model::create_nfunc(model::float_call));
+    model::based_float->attrs_insert("__bool__", model::create_nfunc(model::float_bool));
+    model::based_float->attrs_insert("__hash__", model::create_nfunc(model::float_hash));
+    model::based_float->attrs_insert("__str__", model::create_nfunc(model::float_str));
 
     // Dictionary 类型魔法方法
     model::based_dict->attrs_insert("__add__", model::create_nfunc(model::dict_add));
-    model::based_dict->attrs_insert("__contains__", model::create_nfunc(model::dict_contains));
+    model::based_dict->attrs_insert("contains", model::create_nfunc(model::dict_contains));
     model::based_dict->attrs_insert("__getitem__", model::create_nfunc(model::dict_getitem));
     model::based_dict->attrs_insert("__str__", model::create_nfunc(model::dict_str));
     model::based_dict->attrs_insert("__dstr__", model::create_nfunc(model::dict_dstr));
     model::based_dict->attrs_insert("__setitem__", model::create_nfunc(model::dict_setitem));
-    model::based_dict->attrs_insert("__next__", model::create_nfunc(model::dict_next));
     model::based_dict->attrs_insert("foreach", model::create_nfunc(model::dict_foreach));
     model::based_dict->attrs_insert("len", model::create_nfunc(model::dict_len));
 
@@ -93,7 +113,6 @@ void Vm::entry_builtins() {
     model::based_list->attrs_insert("__eq__", model::create_nfunc(model::list_eq));
     model::based_list->attrs_insert("__call__", model::create_nfunc(model::list_call));
     model::based_list->attrs_insert("__bool__", model::create_nfunc(model::list_bool));
-    model::based_list->attrs_insert("__next__", model::create_nfunc(model::list_next));
     model::based_list->attrs_insert("__getitem__", model::create_nfunc(model::list_getitem));
     model::based_list->attrs_insert("__setitem__", model::create_nfunc(model::list_setitem));
     model::based_list->attrs_insert("__str__", model::create_nfunc(model::list_str));
@@ -123,7 +142,6 @@ void Vm::entry_builtins() {
     model::based_str->attrs_insert("__getitem__", model::create_nfunc(model::str_getitem));
     model::based_str->attrs_insert("__str__", model::create_nfunc(model::str_str));
     model::based_str->attrs_insert("__dstr__", model::create_nfunc(model::str_dstr));
-    model::based_str->attrs_insert("__next__", model::create_nfunc(model::str_next));
 
     model::based_str->attrs_insert("contains", model::create_nfunc(model::str_contains));
     model::based_str->attrs_insert("count", model::create_nfunc(model::str_count));
@@ -148,7 +166,13 @@ void Vm::entry_builtins() {
     // Range类型
     model::based_range->attrs_insert("__call__", model::create_nfunc(model::range_call));
     model::based_range->attrs_insert("__str__", model::create_nfunc(model::range_str));
-    model::based_range->attrs_insert("__next__", model::create_nfunc(model::range_next));
+    model::based_range->attrs_insert("__getitem__", model::create_nfunc(model::range_getitem));
+    model::based_range->attrs_insert("__bool__", model::create_nfunc(model::range_bool));
+    model::based_range->attrs_insert("contains", model::create_nfunc(model::range_contains));
+    model::based_range->attrs_insert("len", model::create_nfunc(model::range_len));
+
+    // Iterator类型(内置容器的原生迭代器)
+    model::based_iterator->attrs_insert("__next__", model::create_nfunc(model::iterator_next));
 
     // Error类型
     model::based_error->attrs_insert("__call__", model::create_nfunc(model::error_call));
@@ -193,6 +217,7 @@ void Vm::entry_builtins() {
     builtin_insert("Int", model::based_int);
     builtin_insert("Bool", model::based_bool);
     builtin_insert("Decimal", model::based_decimal);
+    builtin_insert("Float", model::based_float);
     builtin_insert("List", model::based_list);
     builtin_insert("Dict", model::based_dict);
     builtin_insert("Str", model::based_str);
@@ -204,5 +229,18 @@ void Vm::entry_builtins() {
     builtin_insert("Range", model::based_range);
     builtin_insert("__CodeObject", model::based_code_object);
     builtin_insert("__StopIterSignal__", model::stop_iter_signal);
+
+    // 预先解析内置类型的魔术方法槽, 运算符首次分派时无需再查找原型链
+    for (model::Object* proto : std::initializer_list<model::Object*>{
+        model::based_obj, model::based_int, model::based_bool, model::based_decimal, model::based_float,
+        model::based_list, model::based_dict, model::based_str, model::unique_nil, model::based_range,
+        model::based_iterator
+    }) {
+        for (size_t i = 0; i < model::magic_count; ++i) {
+            get_magic(proto, static_cast<model::Magic>(i));
+        }
+    }
+    // 上面安装内置方法时的修改不算覆盖
+    record_builtin_magic();
 }
 }
@@ -1,89 +1,379 @@
 #include "vm.hpp"
 #include "../../libs/builtins/include/builtin_functions.hpp"
+#include "../../libs/builtins/include/builtin_methods.hpp"
 #include "../opcode/opcode.hpp"
 
+#include <bit>
+
 ///| 核心执行单元
+///| 每个指令处理器自行维护pc并直接跳转到下一条指令的处理器:
+///|   NEXT()        pc前移, 不重新读取调用栈(处理器内不会执行任何kiz代码)
+///|   NEXT_RELOAD() pc前移, 并重新读取栈顶帧(处理器内可能调用函数、压入或弹出帧)
+///|   RELOAD()      pc已由处理器设置好(跳转/返回/抛出), 重新读取栈顶帧
+///|   JUMP_TO(pc)   帧内跳转
+#if KIZ_COMPUTED_GOTO
+#define TARGET(op) op_##op:
+#define DISPATCH() goto *dispatch_table[static_cast<uint8_t>(inst->opc)]
+#else
+#define TARGET(op) case Opcode::op:
+#define DISPATCH() goto dispatch_switch
+#endif
+
+#define NEXT() do { ++curr_frame->pc; goto fetch; } while (0)
+#define NEXT_RELOAD() do { ++curr_frame->pc; goto reload; } while (0)
+#define RELOAD() goto reload
+#define JUMP_TO(target) do { curr_frame->pc = (target); goto fetch; } while (0)
+
+///| 内存管理安全点(跳转与调用指令的开头):
+///|   延迟释放队列非空时释放一个预算分片, 释放只运行析构函数, 任何嵌套层次都可以进行;
+///|   循环垃圾回收只在最外层分派循环中进行, 此时操作数栈上的值都已计数,
+///|   也没有原生函数持有未计数的临时对象
+#define GC_SAFE_POINT() \
+    do { \
+        if (model::free_queue.pending > 0) [[unlikely]] \
+            model::drain_free_queue(model::free_slice_budget); \
+        if (model::gc_young_count > gc_thresholds[0] and base_depth == 0) [[unlikely]] \
+            collect_cycles_if_needed(); \
+    } while (0)
+
+///| 整数快速路径: 两个操作数都是整数(立即数或能放入机器字的Int)时直接计算,
+///| 不经过方法查找, 结果在立即数范围内时不分配对象; Int的magic_mask中的魔术方法被覆盖后不再使用
+#define INT_BINARY_FAST_PATH(magic_mask, result_expr) \
+    do { \
+        int64_t lhs, rhs; \
+        if (model::int_value_of(op_stack[op_stack.size() - 2], lhs) \
+            and model::magic_intact(model::BuiltinKind::Int, (magic_mask)) \
+            and model::int_value_of(op_stack.back(), rhs)) { \
+            model::Object* result = (result_expr); \
+            model::ref_value(result); \
+            release_operand(op_stack.back(), inst->opn_b & 1); \
+            op_stack.pop_back(); \
+            release_operand(op_stack.back(), inst->opn_b & 2); \
+            op_stack.back() = result; \
+            NEXT(); \
+        } \
+    } while (0)
+
+///| 浮点快速路径: 至少一个操作数是Float、另一个是Float或整数时按double直接计算,
+///| 语义与Float/Int的运算符方法一致(整数先转换为最接近的double);
+///| 左操作数类型(Float或Int)的magic_mask中的魔术方法被覆盖后不再使用
+#define FLOAT_BINARY_FAST_PATH(magic_mask, result_expr) \
+    do { \
+        model::Object* const a_num = op_stack[op_stack.size() - 2]; \
+        model::Object* const b_num = op_stack.back(); \
+        double lhs, rhs; \
+        if ((is_float(a_num) or is_float(b_num)) \
+            and model::float_value_of(a_num, lhs) and model::float_value_of(b_num, rhs) \
+            and model::magic_intact(is_float(a_num) ? model::BuiltinKind::Float : model::BuiltinKind::Int, \
+                (magic_mask))) { \
+            model::Object* result = (result_expr); \
+            model::ref_value(result); \
+            release_operand(b_num, inst->opn_b & 1); \
+            op_stack.pop_back(); \
+            release_operand(a_num, inst->opn_b & 2); \
+            op_stack.back() = result; \
+            NEXT(); \
+        } \
+    } while (0)
+
+///| 自适应特化(quickening):
+///|   通用指令观察栈顶操作数的类型, 连续quicken_warmup次观察到同一可特化组合后原地改写为特化指令;
+///|   特化指令只做廉价的类型守卫, 守卫失败时改写回通用指令并重新分派(去优化)
+///| 与上面的快速路径一样, 特化指令代替的魔术方法(magic_mask)被覆盖后不再特化为该类型,
+///| 已特化的指令在下次执行时去优化
+#define OBSERVE_BINARY(magic_mask, generic, int_int, str_str) \
+    quicken_observe(inst, pick_binary(op_stack[op_stack.size() - 2], op_stack.back(), (magic_mask), \
+        Opcode::generic, Opcode::int_int, Opcode::str_str))
+
+#define DEOPT(generic) do { deoptimize(inst, Opcode::generic); DISPATCH(); } while (0)
+#define RECORD_HIT() ++quicken_stats.hits[static_cast<uint8_t>(inst->opc)]
+
+#define INT_INT_SPECIALIZED(spec, generic, magic_mask, result_expr) \
+    TARGET(spec) { \
+        model::Object* const b_val = op_stack.back(); \
+        model::Object* const a_val = op_stack[op_stack.size() - 2]; \
+        if (!(model::is_imm_int(a_val) and model::is_imm_int(b_val)) \
+            or !model::magic_intact(model::BuiltinKind::Int, (magic_mask))) DEOPT(generic); \
+        RECORD_HIT(); \
+        const int64_t lhs = model::imm_int_value(a_val); \
+        const int64_t rhs = model::imm_int_value(b_val); \
+        model::Object* result = (result_expr); \
+        model::ref_value(result); \
+        forget_borrowed(inst); \
+        op_stack.pop_back(); \
+        op_stack.back() = result; \
+        NEXT(); \
+    }
+
 namespace kiz {
-void Vm::execute_unit(const Instruction& instruction) {
-    switch (instruction.opc) {
-    case Opcode::OP_ADD: {
-        auto b = get_and_pop_stack_top();
-        auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__add__", {b.get()});
-        break;
+namespace {
+
+// GE/LE的通用路径分别调用__gt__/__lt__与__eq__
+constexpr uint32_t ge_magics = model::magic_bit(model::Magic::Gt) | model::magic_bit(model::Magic::Eq);
+constexpr uint32_t le_magics = model::magic_bit(model::Magic::Lt) | model::magic_bit(model::Magic::Eq);
+
+bool is_str(model::Object* obj) {
+    return model::is_type<model::String>(obj);
+}
+
+bool is_float(model::Object* obj) {
+    return model::is_type<model::Float>(obj);
+}
+
+bool is_list(model::Object* obj) {
+    return model::is_type<model::List>(obj);
+}
+
+///| 根据两个操作数的类型选出候选特化指令, 没有可用的特化时返回通用指令本身
+Opcode pick_binary(model::Object* a, model::Object* b, const uint32_t magic_mask,
+                   const Opcode generic, const Opcode int_int, const Opcode str_str) {
+    if (model::is_imm_int(a) and model::is_imm_int(b)) {
+        return model::magic_intact(model::BuiltinKind::Int, magic_mask) ? int_int : generic;
+    }
+    if (str_str != generic and is_str(a) and is_str(b)) {
+        return model::magic_intact(model::BuiltinKind::Str, magic_mask) ? str_str : generic;
+    }
+    return generic;
+}
+
+///| 释放出栈的操作数, 借用的操作数(见mark_borrowed_operands)不持有引用
+void release_operand(model::Object* obj, const bool borrowed) {
+    if (!borrowed) model::unref_value(obj);
+#ifndef NDEBUG
+    else --Vm::borrowed_on_stack;
+#endif
+}
+
+///| 借用的操作数不经release_operand离开操作数栈(或补上引用)时, 更新调试用的借用计数
+void forget_borrowed(const Instruction* inst) {
+#ifndef NDEBUG
+    Vm::borrowed_on_stack -= std::popcount(static_cast<unsigned>(inst->opn_b & 3));
+#else
+    (void)inst;
+#endif
+}
+
+///| 进入慢速路径(可能执行kiz代码或抛出异常)前为借用的操作数补上引用, 此后按持有引用处理
+void own_borrowed(const Instruction* inst) {
+    if (inst->opn_b & 1) model::ref_value(Vm::op_stack.back());
+    if (inst->opn_b & 2) model::ref_value(Vm::op_stack[Vm::op_stack.size() - 2]);
+    forget_borrowed(inst);
+}
+
+void quicken_observe(Instruction* inst, const Opcode specialized) {
+    if (specialized == inst->opc) {
+        inst->ext = 0;
+        return;
     }
+    if (++inst->ext < quicken_warmup) return;
+    inst->opc = specialized;
+    inst->ext = 0;
+    ++Vm::quicken_stats.specialized[static_cast<uint8_t>(specialized)];
+}
+
+void deoptimize(Instruction* inst, const Opcode generic) {
+    ++Vm::quicken_stats.misses[static_cast<uint8_t>(inst->opc)];
+    inst->opc = generic;
+    inst->ext = 0;
+}
 
-    case Opcode::OP_SUB: {
+} // namespace
+
+void Vm::execute_unit(const size_t base_depth) {
+#if KIZ_COMPUTED_GOTO
+    // 顺序必须与Opcode枚举保持一致
+    static void* const dispatch_table[] = {
+        &&op_OP_ADD, &&op_OP_SUB, &&op_OP_MUL, &&op_OP_DIV,
+        &&op_OP_MOD, &&op_OP_POW, &&op_OP_NEG,
+        &&op_OP_EQ, &&op_OP_GT, &&op_OP_LT,
+        &&op_OP_GE, &&op_OP_LE, &&op_OP_NE,
+        &&op_OP_NOT,
+        &&op_OP_IS, &&op_OP_IN,
+
+        &&op_CALL, &&op_RET, &&op_CREATE_CLOSURE,
+        &&op_GET_ATTR, &&op_SET_ATTR, &&op_CALL_METHOD,
+        &&op_GET_ITEM, &&op_SET_ITEM,
+
+        &&op_LOAD_VAR, &&op_LOAD_CONST,
+        &&op_SET_GLOBAL, &&op_SET_LOCAL, &&op_SET_NONLOCAL,
+
+        &&op_JUMP, &&op_JUMP_IF_FALSE, &&op_THROW,
+        &&op_MAKE_LIST, &&op_MAKE_DICT,
+        &&op_IMPORT,
+        &&op_LOAD_ERROR,
+        &&op_GET_ITER, &&op_FOR_ITER, &&op_POP_ITER,
+
+        &&op_IS_CHILD, &&op_CREATE_OBJECT, &&op_COPY_TOP,
+        &&op_STOP, &&op_LOAD_FREE_VAR, &&op_LOAD_BUILTINS,
+
+        &&op_OP_ADD_INT_INT, &&op_OP_SUB_INT_INT, &&op_OP_MUL_INT_INT,
+        &&op_OP_EQ_INT_INT, &&op_OP_GT_INT_INT, &&op_OP_LT_INT_INT,
+        &&op_OP_GE_INT_INT, &&op_OP_LE_INT_INT, &&op_OP_NE_INT_INT,
+        &&op_OP_ADD_STR_STR, &&op_OP_EQ_STR_STR,
+        &&op_GET_ITEM_LIST_INT,
+        &&op_LOAD_VAR_BORROW, &&op_LOAD_CONST_BORROW,
+        &&op_POP_TOP
+    };
+    static_assert(std::size(dispatch_table) == opcode_count);
+#endif
+
+    CallFrame* curr_frame;
+    Instruction* code;   // 非const: 自适应特化会原地改写指令
+    size_t code_size;
+    Instruction* inst;
+
+reload:
+    if (!running or call_stack.size() <= base_depth) return;
+    curr_frame = call_stack.back();
+    code = curr_frame->code_object->code.data();
+    code_size = curr_frame->code_object->code.size();
+
+fetch:
+    // 检查当前帧是否执行完毕: 最底层帧执行完毕则返回, 其余帧弹出
+    if (curr_frame->pc >= code_size) {
+        if (call_stack.size() == base_depth + 1) return;
+        pop_frame();
+        RELOAD();
+    }
+    inst = code + curr_frame->pc;
+    DISPATCH();
+
+#if !KIZ_COMPUTED_GOTO
+dispatch_switch:
+    switch (inst->opc) {
+#endif
+    TARGET(OP_ADD) {
+        OBSERVE_BINARY(model::magic_bit(model::Magic::Add), OP_ADD, OP_ADD_INT_INT, OP_ADD_STR_STR);
+        INT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Add), model::small_int_add(lhs, rhs));
+        FLOAT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Add), new model::Float(lhs + rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__sub__", {b.get()});
-        break;
+        call_magic(a.get(), model::Magic::Add, {b.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_MUL: {
+    TARGET(OP_SUB) {
+        OBSERVE_BINARY(model::magic_bit(model::Magic::Sub), OP_SUB, OP_SUB_INT_INT, OP_SUB);
+        INT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Sub), model::small_int_sub(lhs, rhs));
+        FLOAT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Sub), new model::Float(lhs - rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__mul__", {b.get()});
-        break;
+        call_magic(a.get(), model::Magic::Sub, {b.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_DIV: {
+    TARGET(OP_MUL) {
+        OBSERVE_BINARY(model::magic_bit(model::Magic::Mul), OP_MUL, OP_MUL_INT_INT, OP_MUL);
+        INT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Mul), model::small_int_mul(lhs, rhs));
+        FLOAT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Mul), new model::Float(lhs * rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__div__", {b.get()});
-        break;
+        call_magic(a.get(), model::Magic::Mul, {b.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_MOD: {
+    TARGET(OP_DIV) {
+        FLOAT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Div), new model::Float(lhs / rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__mod__", {b.get()});
-        break;
+        call_magic(a.get(), model::Magic::Div, {b.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_POW: {
+    TARGET(OP_MOD) {
+        // 除数为0时由慢速路径抛出异常: 快速路径不能在操作数仍是借用时抛出
+        if (int64_t divisor; !model::int_value_of(op_stack.back(), divisor) or divisor != 0) {
+            INT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Mod), model::small_int_mod(lhs, rhs));
+        }
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__pow__", {b.get()});
-        break;
+        call_magic(a.get(), model::Magic::Mod, {b.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_NEG: {
+    TARGET(OP_POW) {
+        own_borrowed(inst);
+        auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
-        call_method(a.get(), "__neg__", {});
-        break;
+        call_magic(a.get(), model::Magic::Pow, {b.get()});
+        NEXT_RELOAD();
+    }
+
+    TARGET(OP_NEG) {
+        int64_t val;
+        if (model::int_value_of(op_stack.back(), val)
+            and model::magic_intact(model::BuiltinKind::Int, model::magic_bit(model::Magic::Neg))) {
+            model::Object* result = model::small_int_neg(val);
+            model::ref_value(result);
+            release_operand(op_stack.back(), inst->opn_b & 1);
+            op_stack.back() = result;
+            NEXT();
+        }
+        if (is_float(op_stack.back())
+            and model::magic_intact(model::BuiltinKind::Float, model::magic_bit(model::Magic::Neg))) {
+            model::Object* result = new model::Float(-static_cast<model::Float*>(op_stack.back())->val);
+            result->make_ref();
+            release_operand(op_stack.back(), inst->opn_b & 1);
+            op_stack.back() = result;
+            NEXT();
+        }
+        own_borrowed(inst);
+        auto a = get_and_pop_stack_top();
+        call_magic(a.get(), model::Magic::Neg, {});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_EQ: {
+    TARGET(OP_EQ) {
+        OBSERVE_BINARY(model::magic_bit(model::Magic::Eq), OP_EQ, OP_EQ_INT_INT, OP_EQ_STR_STR);
+        INT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Eq), model::load_bool(lhs == rhs));
+        FLOAT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Eq), model::load_bool(lhs == rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
-        call_method(a.get(), "__eq__", {b.get()});
-        break;
+        call_magic(a.get(), model::Magic::Eq, {b.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_GT: {
+    TARGET(OP_GT) {
+        OBSERVE_BINARY(model::magic_bit(model::Magic::Gt), OP_GT, OP_GT_INT_INT, OP_GT);
+        INT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Gt), model::load_bool(lhs > rhs));
+        FLOAT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Gt), model::load_bool(lhs > rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
-        call_method(a.get(), "__gt__", {b.get()});
-        break;
+        call_magic(a.get(), model::Magic::Gt, {b.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_LT: {
+    TARGET(OP_LT) {
+        OBSERVE_BINARY(model::magic_bit(model::Magic::Lt), OP_LT, OP_LT_INT_INT, OP_LT);
+        INT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Lt), model::load_bool(lhs < rhs));
+        FLOAT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Lt), model::load_bool(lhs < rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
-        call_method(a.get(), "__lt__", {b.get()});
-        break;
+        call_magic(a.get(), model::Magic::Lt, {b.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_GE: {
+    TARGET(OP_GE) {
+        OBSERVE_BINARY(ge_magics, OP_GE, OP_GE_INT_INT, OP_GE);
+        INT_BINARY_FAST_PATH(ge_magics, model::load_bool(lhs >= rhs));
+        FLOAT_BINARY_FAST_PATH(ge_magics, model::load_bool(lhs >= rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
-        call_method(a.get(), "__eq__", {b.get()});
-        call_method(a.get(), "__gt__", {b.get()});
+        call_magic(a.get(), model::Magic::Eq, {b.get()});
+        call_magic(a.get(), model::Magic::Gt, {b.get()});
 
         // 统一使用封装的栈操作获取结果
         auto gt_result = get_and_pop_stack_top();
@@ -95,18 +385,22 @@ void Vm::execute_unit(const Instruction& instruction) {
         } else {
             push_to_stack(model::load_false());
         }
-        break;
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_LE: {
+    TARGET(OP_LE) {
+        OBSERVE_BINARY(le_magics, OP_LE, OP_LE_INT_INT, OP_LE);
+        INT_BINARY_FAST_PATH(le_magics, model::load_bool(lhs <= rhs));
+        FLOAT_BINARY_FAST_PATH(le_magics, model::load_bool(lhs <= rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
         // 调用__eq__方法
-        call_method(a.get(), "__eq__", {b.get()});
+        call_magic(a.get(), model::Magic::Eq, {b.get()});
 
         // 调用__lt__方法
-        call_method(a.get(), "__lt__", {b.get()});
+        call_magic(a.get(), model::Magic::Lt, {b.get()});
 
         // 获取结果
         auto lt_result = get_and_pop_stack_top();
@@ -118,16 +412,20 @@ void Vm::execute_unit(const Instruction& instruction) {
         } else {
             push_to_stack(model::load_false());
         }
-        break;
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_NE: {
+    TARGET(OP_NE) {
+        OBSERVE_BINARY(model::magic_bit(model::Magic::Eq), OP_NE, OP_NE_INT_INT, OP_NE);
+        INT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Eq), model::load_bool(lhs != rhs));
+        FLOAT_BINARY_FAST_PATH(model::magic_bit(model::Magic::Eq), model::load_bool(lhs != rhs));
+        own_borrowed(inst);
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
 
 
         // 调用__eq__方法
-        call_method(a.get(), "__eq__", {b.get()});
+        call_magic(a.get(), model::Magic::Eq, {b.get()});
 
         // 获取比较结果
         auto eq_result = get_and_pop_stack_top();
@@ -136,44 +434,57 @@ void Vm::execute_unit(const Instruction& instruction) {
         push_to_stack(model::load_bool(
             ! is_true(eq_result.get())
         ));
-        break;
+        NEXT_RELOAD();
     }
 
-    case Opcode::OP_NOT: {
-        auto a = get_and_pop_stack_top();
-        bool result = !is_true(a.get());
+    TARGET(OP_NOT) {
+        auto a = pop_stack_raw();
+        bool result = !is_true(a);
+        model::unref_value(a);
         push_to_stack(model::load_bool(result));
-        break;
-    }
-
-    case Opcode::OP_IS: {
-        auto b = get_and_pop_stack_top();
-        auto a = get_and_pop_stack_top();
-        push_to_stack(model::load_bool(a.get() == b.get()));
-        break;
+        NEXT_RELOAD();
+    }
+
+    TARGET(OP_IS) {
+        // 立即数范围内的整数没有独立的对象身份, 值相等即视为同一对象;
+        // 装箱的(如取自列表元素)同样按值比较, 结果不取决于值是否被装箱
+        // 操作数可能是借用的, 直接出栈, 由release_operand按借用标记释放
+        auto b = op_stack.back();
+        op_stack.pop_back();
+        auto a = op_stack.back();
+        op_stack.pop_back();
+        bool same = a == b;
+        int64_t a_int, b_int;
+        if (!same and model::int_value_of(a, a_int) and model::int_value_of(b, b_int)) {
+            same = a_int == b_int and model::fits_imm_int(a_int);
+        }
+        push_to_stack(model::load_bool(same));
+        release_operand(a, inst->opn_b & 2);
+        release_operand(b, inst->opn_b & 1);
+        NEXT();
     }
 
-    case Opcode::OP_IN: {
+    TARGET(OP_IN) {
         auto for_check = get_and_pop_stack_top();
         auto item = get_and_pop_stack_top();
 
         // 调用contains方法，参数为item
-        call_method(for_check.get(), "contains", {item.get()});
-        break;
+        call_magic(for_check.get(), model::Magic::Contains, {item.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::MAKE_LIST: {
-        make_list(instruction.opn_list[0]);
-        break;
+    TARGET(MAKE_LIST) {
+        make_list(inst->opn);
+        NEXT();
     }
 
-    case Opcode::MAKE_DICT: {
-        make_dict(instruction.opn_list[0]);
-        break;
+    TARGET(MAKE_DICT) {
+        make_dict(inst->opn);
+        NEXT_RELOAD();
     }
 
-    case Opcode::CREATE_CLOSURE: {
-        auto func_obj = dynamic_cast<model::Function*>(op_stack.back());
+    TARGET(CREATE_CLOSURE) {
+        auto func_obj = model::as<model::Function>(op_stack.back());
 
         auto& upvalues = func_obj->code->upvalues;
         std::vector<model::Object*> free_vars {};
@@ -182,171 +493,208 @@ void Vm::execute_unit(const Instruction& instruction) {
             auto frame = call_stack[ call_stack.size() - distance_from_curr];
             size_t loc_based = frame->bp;
 
-            auto var = op_stack[loc_based + idx];
+            auto& slot = op_stack[loc_based + idx];
+            if (model::is_imm_int(slot)) {
+                // 闭包捕获的值会离开操作数栈, 立即数需装箱
+                slot = model::box_value(slot);
+                slot->make_ref();
+            }
+            auto var = slot;
             var->make_ref();
             free_vars.push_back( var );
         }
 
         func_obj->free_vars = free_vars;
-        break;
+        NEXT();
     }
 
 
-    case Opcode::CALL: {
+    TARGET(CALL) {
+        GC_SAFE_POINT();
+        // 栈顶为函数对象, 其下为inst->opn个参数(按求值顺序排列), 参数留在栈上由handle_call绑定
         auto func_obj = get_and_pop_stack_top();
-        // 弹出栈顶-1元素 : 参数列表
-        auto args_obj = get_and_pop_stack_top();
-        handle_call(func_obj.get(), args_obj.get(), nullptr);
-        break;
+        handle_call(func_obj.get(), inst->opn, nullptr);
+        // 调用方的pc在新帧压入后立即前移, 新帧返回后从下一条指令继续
+        NEXT_RELOAD();
     }
 
-    case Opcode::RET: {
+    TARGET(RET) {
         // 执行ensure确保资源被释放
         handle_ensure();
 
-        auto frame = call_stack.back();
-        call_stack.pop_back();
-        call_stack.back()->bp = frame->last_bp;
-        call_stack.back()->pc = frame->return_to_pc;
-
-        auto return_val = get_and_pop_stack_top();
-        assert(return_val.get());
-
-        while (frame->bp < op_stack.size()) {
-            op_stack.back()->del_ref();
-            op_stack.pop_back();
-        }
-
-        push_to_stack(return_val.get());
-
-        frame->owner->del_ref();
-        frame->code_object->del_ref();
-        for (auto it: frame->iters) {
-            if (it) it->del_ref();
-        }
-
-        delete frame;
-        break;
+        // 返回值直接转移到调用方的操作数栈, 立即数不装箱
+        auto return_val = pop_stack_raw();
+        pop_frame();
+        op_stack.push_back(return_val);
+        RELOAD();
     }
 
-    case Opcode::CALL_METHOD: {
+    TARGET(CALL_METHOD) {
+        GC_SAFE_POINT();
+        // 栈顶为接收者, 其下为inst->opn_b个参数
         auto obj = get_and_pop_stack_top();
 
-        // 弹出栈顶-1元素 : 参数列表
-        auto args_obj = get_and_pop_stack_top();
-
-        std::string attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
-
-        auto func_obj = get_attr(obj.get(), attr_name);
+        auto func_obj = get_attr_cached(obj.get(), inst->opn,
+            curr_frame->code_object->attr_caches[curr_frame->pc]);
 
         func_obj->make_ref();
-        handle_call(func_obj, args_obj.get(), obj.get());
-        break;
+        handle_call(func_obj, inst->opn_b, obj.get());
+        NEXT_RELOAD();
     }
 
-    case Opcode::GET_ATTR: {
+    TARGET(GET_ATTR) {
+        if ((inst->opn_b & 1) and !model::is_imm_int(op_stack.back())) {
+            // 借用的接收者: 属性查找不执行kiz代码, 查找失败抛出异常时也无需释放
+            auto obj = op_stack.back();
+            op_stack.pop_back();
+            forget_borrowed(inst);
+            push_to_stack(get_attr_cached(obj, inst->opn,
+                curr_frame->code_object->attr_caches[curr_frame->pc]));
+            NEXT();
+        }
+        own_borrowed(inst);
         auto obj = get_and_pop_stack_top();
-         std::string attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
 
-        model::Object* attr_val = get_attr(obj.get(), attr_name);
+        model::Object* attr_val = get_attr_cached(obj.get(), inst->opn,
+            curr_frame->code_object->attr_caches[curr_frame->pc]);
         push_to_stack(attr_val);
-        break;
+        NEXT();
     }
 
-    case Opcode::SET_ATTR: {
+    TARGET(SET_ATTR) {
         auto attr_val = get_and_pop_stack_top();
         auto obj = get_and_pop_stack_top();
-        std::string attr_name = get_attr_name_by_idx(instruction.opn_list[0]);
+        const std::string& attr_name = get_attr_name_by_idx(inst->opn);
 
         if (std::ranges::find(builtins, obj.get()) != std::ranges::end(builtins)) {
             throw NativeFuncError("SetattrError", "Cannot reset or add attribute for builtin object");
         }
 
         auto new_val = model::copy_if_mutable(attr_val.get());
-        auto old_it = obj.get()->attrs.find(attr_name);   // 获取旧值（若有）
-        obj.get()->attrs_insert(attr_name, new_val);      // 插入新值，内部 make_ref
-
-        if (old_it) old_it->value->del_ref();       // 释放旧值
-        break;
-    }
-
-    case Opcode::GET_ITEM: {
+        // 获取旧值（若有）: 插入会原地覆盖同一节点, 必须先取出旧值指针
+        const auto old_it = obj.get()->attrs.find_hashed(attr_name,
+            curr_frame->code_object->attr_hashes[inst->opn]);
+        model::Object* old_val = old_it ? old_it->value : nullptr;
+        obj.get()->attrs_insert(attr_name, new_val);      // 插入新值，内部 make_ref; 修改原型时使内联缓存失效
+
+        if (old_val) old_val->del_ref();       // 释放旧值
+        NEXT();
+    }
+
+    TARGET(GET_ITEM) {
+        {
+            auto args_val = op_stack[op_stack.size() - 2];
+            const bool list_int = is_list(op_stack.back())
+                and static_cast<model::List*>(args_val)->val.size() == 1
+                and model::is_type<model::Int>(static_cast<model::List*>(args_val)->val[0])
+                and model::magic_intact(model::BuiltinKind::List, model::magic_bit(model::Magic::GetItem));
+            quicken_observe(inst, list_int ? Opcode::GET_ITEM_LIST_INT : Opcode::GET_ITEM);
+        }
+        own_borrowed(inst);
         auto obj = get_and_pop_stack_top();
         auto args_list = get_and_pop_stack_top();
 
-        call_method(obj.get(), "__getitem__", model::cast_to_list(
+        call_magic(obj.get(), model::Magic::GetItem, model::cast_to_list(
             args_list.get()
         ) -> val);
-        break;
+        NEXT_RELOAD();
     }
 
-    case Opcode::SET_ITEM: {
+    TARGET(SET_ITEM) {
         auto value = get_and_pop_stack_top();
         auto arg = get_and_pop_stack_top();
         auto obj = get_and_pop_stack_top();
 
         // 获取对象自身的 __setitem__
-        call_method(obj.get(), "__setitem__", {arg.get(), value.get()});
-        break;
+        call_magic(obj.get(), model::Magic::SetItem, {arg.get(), value.get()});
+        NEXT_RELOAD();
     }
 
-    case Opcode::LOAD_VAR: {
-        auto val = op_stack[call_stack.back()->bp + instruction.opn_list[0]];
+    TARGET(LOAD_VAR) {
+        auto val = op_stack[call_stack.back()->bp + inst->opn];
         push_to_stack(val);
-        break;
+        NEXT();
     }
 
-    case Opcode::LOAD_CONST: {
-        size_t const_idx = instruction.opn_list[0];
+    TARGET(LOAD_CONST) {
+        size_t const_idx = inst->opn;
         model::Object* const_val = const_pool[const_idx];
         push_to_stack(const_val);
-        break;
+        NEXT();
     }
 
-    case Opcode::LOAD_BUILTINS: {
-        auto obj = builtins[ instruction.opn_list[0] ];
-        push_to_stack(obj);
-        break;
+    TARGET(LOAD_VAR_BORROW) {
+        // 借用加载: 不增加引用计数, 由紧随的消费者指令负责(见mark_borrowed_operands)
+        auto val = op_stack[call_stack.back()->bp + inst->opn];
+        if (val) {
+            op_stack.push_back(val);
+#ifndef NDEBUG
+            ++Vm::borrowed_on_stack;
+#endif
+        }
+        NEXT();
     }
 
-    case Opcode::LOAD_FREE_VAR: {
-        auto func = dynamic_cast<model::Function*>(call_stack.back()->owner);
-        assert(func != nullptr);
-        push_to_stack(func->free_vars[ instruction.opn_list[0] ]);
-        break;
+    TARGET(LOAD_CONST_BORROW) {
+        op_stack.push_back(const_pool[inst->opn]);
+#ifndef NDEBUG
+        ++Vm::borrowed_on_stack;
+#endif
+        NEXT();
     }
 
-    case Opcode::SET_LOCAL: {
-        auto value = get_and_pop_stack_top();
+    TARGET(POP_TOP) {
+        model::unref_value(pop_stack_raw());
+        NEXT();
+    }
 
-        size_t offset = call_stack.back()->bp + instruction.opn_list[0];
-        auto new_val = model::copy_if_mutable(value.get());
-        new_val->make_ref();
+    TARGET(LOAD_BUILTINS) {
+        auto obj = builtins[ inst->opn ];
+        push_to_stack(obj);
+        NEXT();
+    }
 
-        if (op_stack[offset]) {
-            op_stack[offset]->del_ref();
+    TARGET(LOAD_FREE_VAR) {
+        auto func = model::as<model::Function>(call_stack.back()->owner);
+        push_to_stack(func->free_vars[ inst->opn ]);
+        NEXT();
+    }
+
+    TARGET(SET_LOCAL) {
+        auto value = pop_stack_raw();
+
+        size_t offset = call_stack.back()->bp + inst->opn;
+        auto new_val = value;
+        if (!model::is_imm_int(value)) {
+            new_val = model::copy_if_mutable(value);
+            new_val->make_ref();
+            value->del_ref();
         }
+
+        model::unref_value(op_stack[offset]);
         op_stack[offset] = new_val;
-        break;
+        NEXT();
     }
 
 
-    case Opcode::SET_GLOBAL: {
-        auto offset = instruction.opn_list[0];
-        auto value = get_and_pop_stack_top();
+    TARGET(SET_GLOBAL) {
+        auto offset = inst->opn;
+        auto value = pop_stack_raw();
 
-        auto new_val = model::copy_if_mutable(value.get());
-        new_val->make_ref();
-        if (op_stack[offset]) {
-            op_stack[offset]->del_ref();
+        auto new_val = value;
+        if (!model::is_imm_int(value)) {
+            new_val = model::copy_if_mutable(value);
+            new_val->make_ref();
+            value->del_ref();
         }
 
+        model::unref_value(op_stack[offset]);
         op_stack[offset] = new_val;
-        break;
+        NEXT();
     }
 
-    case Opcode::SET_NONLOCAL: {
-        auto idx_of_upvalue = instruction.opn_list[0];
+    TARGET(SET_NONLOCAL) {
+        auto idx_of_upvalue = inst->opn;
         auto upvalue = call_stack.back()->code_object->upvalues[ idx_of_upvalue ];
         auto frame = call_stack[ call_stack.size() - upvalue.distance_from_curr - 1]; // 区别于CREATE_CLOSURE指令, 这里在函数中要多减一
         size_t loc_based = frame->bp;
@@ -356,123 +704,211 @@ void Vm::execute_unit(const Instruction& instruction) {
         auto new_val = model::copy_if_mutable(value.get());
         new_val->make_ref();
 
-        if (op_stack[loc_based + upvalue.idx]) {
-            op_stack[loc_based + upvalue.idx]->del_ref();
-        }
+        model::unref_value(op_stack[loc_based + upvalue.idx]);
 
         op_stack[loc_based + upvalue.idx] = new_val;
 
-        // 更新闭包
-        if (auto f = dynamic_cast<model::Function*>(call_stack.back()->owner)) {
+        // 更新闭包: 捕获变量各自持有一份引用
+        if (auto f = model::dyn<model::Function>(call_stack.back()->owner)) {
+            new_val->make_ref();
+            model::unref_value(f->free_vars[idx_of_upvalue]);
             f->free_vars[idx_of_upvalue] = new_val;
         }
-        break;
+        NEXT();
     }
 
 
-    case Opcode::THROW: {
+    TARGET(THROW) {
         auto top = get_and_pop_stack_top();
         if (call_stack.back()->curr_error) call_stack.back()->curr_error->del_ref();
         call_stack.back()->curr_error = top.get();
         top.get()->make_ref();     // 使 curr_error 持有引用
         handle_throw();
-        break;
+        RELOAD();
     }
 
-    case Opcode::LOAD_ERROR: {
+    TARGET(LOAD_ERROR) {
         if (!call_stack.back()->curr_error) {
             throw KizStopRunningSignal("Unable to load error");
         }
         call_stack.back()->curr_error->make_ref();
         push_to_stack(call_stack.back()->curr_error);
-        break;
+        NEXT();
     }
 
-    case Opcode::JUMP: {
-        size_t target_pc = instruction.opn_list[0];
-        call_stack.back()->pc = target_pc;
-        break;
+    TARGET(JUMP) {
+        GC_SAFE_POINT();
+        JUMP_TO(inst->opn);
     }
 
-    case Opcode::JUMP_IF_FALSE: {
-        auto cond = get_and_pop_stack_top();
-        if (! is_true(cond.get())) {
+    TARGET(JUMP_IF_FALSE) {
+        auto cond = pop_stack_raw();
+        const bool cond_true = is_true(cond);
+        model::unref_value(cond);
+        if (! cond_true) {
             // 跳转逻辑
-            call_stack.back()->pc = instruction.opn_list[0];
+            curr_frame->pc = inst->opn;
         } else {
-            call_stack.back()->pc++;
+            curr_frame->pc++;
         }
-        break;
+        RELOAD();
     }
 
-    case Opcode::IS_CHILD: {
+    TARGET(IS_CHILD) {
         auto b = get_and_pop_stack_top();
         auto a = get_and_pop_stack_top();
         push_to_stack(builtin::check_based_object(a.get(), b.get()));
-        break;
+        NEXT();
     }
 
-    case Opcode::CREATE_OBJECT: {
+    TARGET(CREATE_OBJECT) {
         auto obj = new model::Object();
         obj->attrs_insert("__parent__", model::based_obj);
         push_to_stack(obj);
-        break;
+        NEXT();
     }
 
-    case Opcode::IMPORT: {
-        std::string module_path = get_attr_name_by_idx(instruction.opn_list[0]);
+    TARGET(IMPORT) {
+        std::string module_path = get_attr_name_by_idx(inst->opn);
         handle_import(module_path);
-        break;
+        NEXT_RELOAD();
     }
 
-    case Opcode::CACHE_ITER: {
-        auto iter = op_stack.back();
+    TARGET(GET_ITER) {
+        // 内置容器换成原生迭代器, 其他对象自身作为迭代器(每一步调用其__next__)
+        auto obj = get_and_pop_stack_top();
+        model::Object* iter = model::Iterator::supports(obj.get())
+            ? new model::Iterator(obj.get())
+            : model::box_value(obj.get());
         iter->make_ref();
-
         call_stack.back()->iters.push_back(iter);
-        break;
-    }
-
-    case Opcode::GET_ITER: {
-        push_to_stack(
-            call_stack.back()->iters.back()
-        );
-        break;
+        NEXT();
+    }
+
+    TARGET(FOR_ITER) {
+        // 取出下一个元素压栈, 迭代结束时跳转到inst->opn
+        auto iter = call_stack.back()->iters.back();
+        if (iter->get_type() == model::Object::ObjectType::Iterator) {
+            const auto it = static_cast<model::Iterator*>(iter);
+            if (it->source->get_type() == model::Object::ObjectType::Range) {
+                // 计数循环: 循环变量以立即数直接写入随后SET_LOCAL的槽位, 不分配对象也不经过操作数栈
+                int64_t v;
+                if (!it->next_int(v)) JUMP_TO(inst->opn);
+                const Instruction& store = code[curr_frame->pc + 1];
+                if (model::fits_imm_int(v) and store.opc == Opcode::SET_LOCAL) {
+                    auto& slot = op_stack[curr_frame->bp + store.opn];
+                    model::unref_value(slot);
+                    slot = model::make_imm_int(v);
+                    curr_frame->pc += 2;
+                    goto fetch;
+                }
+                push_to_stack(model::make_int_value(v));
+                NEXT();
+            }
+            const auto item = it->next();
+            if (!item) JUMP_TO(inst->opn);
+            push_to_stack(item);
+            NEXT();
+        }
+        call_magic(iter, model::Magic::Next, {});
+        auto item = get_and_pop_stack_top();
+        if (item.get() == model::stop_iter_signal) {
+            curr_frame->pc = inst->opn;
+            RELOAD();
+        }
+        push_to_stack(item.get());
+        NEXT_RELOAD();
     }
 
-    case Opcode::POP_ITER: {
+    TARGET(POP_ITER) {
         auto iter_obj = call_stack.back()->iters.back();
         iter_obj->del_ref();
         call_stack.back()->iters.pop_back();
-        break;
-
-    }
-
-    case Opcode::JUMP_IF_FINISH_ITER: {
-        auto obj = get_and_pop_stack_top();
-        size_t target_pc = instruction.opn_list[0];
-        if (obj.get() == model::stop_iter_signal) {
-            call_stack.back()->pc = target_pc;
-            return;
-        }
-        call_stack.back()->pc ++;
-        break;
+        NEXT();
     }
 
-    case Opcode::COPY_TOP: {
-        auto obj = get_and_pop_stack_top();
-        push_to_stack(obj.get());
-        push_to_stack(obj.get());
-        break;
+    TARGET(COPY_TOP) {
+        push_to_stack(op_stack.back());
+        NEXT();
     }
 
-    case Opcode::STOP: {
+    TARGET(STOP) {
         running = false;
-        break;
+        return;
+    }
+
+    INT_INT_SPECIALIZED(OP_ADD_INT_INT, OP_ADD, model::magic_bit(model::Magic::Add), model::small_int_add(lhs, rhs))
+    INT_INT_SPECIALIZED(OP_SUB_INT_INT, OP_SUB, model::magic_bit(model::Magic::Sub), model::small_int_sub(lhs, rhs))
+    INT_INT_SPECIALIZED(OP_MUL_INT_INT, OP_MUL, model::magic_bit(model::Magic::Mul), model::small_int_mul(lhs, rhs))
+    INT_INT_SPECIALIZED(OP_EQ_INT_INT, OP_EQ, model::magic_bit(model::Magic::Eq), model::load_bool(lhs == rhs))
+    INT_INT_SPECIALIZED(OP_GT_INT_INT, OP_GT, model::magic_bit(model::Magic::Gt), model::load_bool(lhs > rhs))
+    INT_INT_SPECIALIZED(OP_LT_INT_INT, OP_LT, model::magic_bit(model::Magic::Lt), model::load_bool(lhs < rhs))
+    INT_INT_SPECIALIZED(OP_GE_INT_INT, OP_GE, ge_magics, model::load_bool(lhs >= rhs))
+    INT_INT_SPECIALIZED(OP_LE_INT_INT, OP_LE, le_magics, model::load_bool(lhs <= rhs))
+    INT_INT_SPECIALIZED(OP_NE_INT_INT, OP_NE, model::magic_bit(model::Magic::Eq), model::load_bool(lhs != rhs))
+
+    TARGET(OP_ADD_STR_STR) {
+        auto b_val = op_stack.back();
+        auto a_val = op_stack[op_stack.size() - 2];
+        if (!(is_str(a_val) and is_str(b_val))
+            or !model::magic_intact(model::BuiltinKind::Str, model::magic_bit(model::Magic::Add))) DEOPT(OP_ADD);
+        RECORD_HIT();
+        auto result = new model::String(
+            static_cast<model::String*>(a_val)->val + static_cast<model::String*>(b_val)->val
+        );
+        result->make_ref();
+        op_stack.pop_back();
+        op_stack.back() = result;
+        release_operand(b_val, inst->opn_b & 1);
+        release_operand(a_val, inst->opn_b & 2);
+        NEXT();
+    }
+
+    TARGET(OP_EQ_STR_STR) {
+        auto b_val = op_stack.back();
+        auto a_val = op_stack[op_stack.size() - 2];
+        if (!(is_str(a_val) and is_str(b_val))
+            or !model::magic_intact(model::BuiltinKind::Str, model::magic_bit(model::Magic::Eq))) DEOPT(OP_EQ);
+        RECORD_HIT();
+        auto result = model::load_bool(
+            static_cast<model::String*>(a_val)->val == static_cast<model::String*>(b_val)->val
+        );
+        result->make_ref();
+        op_stack.pop_back();
+        op_stack.back() = result;
+        release_operand(b_val, inst->opn_b & 1);
+        release_operand(a_val, inst->opn_b & 2);
+        NEXT();
+    }
+
+    TARGET(GET_ITEM_LIST_INT) {
+        // 栈顶为被索引的对象, 其下为参数列表(由MAKE_LIST生成)
+        auto obj = op_stack.back();
+        auto args_val = op_stack[op_stack.size() - 2];
+        if (!is_list(obj)
+            or !model::magic_intact(model::BuiltinKind::List, model::magic_bit(model::Magic::GetItem))) DEOPT(GET_ITEM);
+        const auto& args = static_cast<model::List*>(args_val)->val;
+        const auto& items = static_cast<model::List*>(obj)->val;
+        int64_t index;
+        if (args.size() != 1 or !model::int_value_of(args[0], index)
+            or index < 0 or static_cast<uint64_t>(index) >= items.size()
+            or items[index] == nullptr) {
+            // 越界等情况交给通用路径报错
+            DEOPT(GET_ITEM);
+        }
+        RECORD_HIT();
+        auto item = items[index];
+        item->make_ref();
+        op_stack.pop_back();
+        op_stack.back() = item;
+        release_operand(obj, inst->opn_b & 1);
+        args_val->del_ref();
+        NEXT();
     }
 
+#if !KIZ_COMPUTED_GOTO
     default: throw NativeFuncError("FutureError", "execute_instruction meet unknown opcode");
     }
-
+#endif
 }
 }
@@ -0,0 +1,155 @@
+/**
+ * @file gc.cpp
+ * @brief 循环垃圾回收: 在引用计数之上用试删除算法回收引用环
+ *
+ * 引用计数无法释放互相引用的对象(原型链上的__parent__、闭包捕获的free_vars、
+ * 用户用List/Dictionary构造的图). 回收器对登记表中第0..g代的对象:
+ *   1. 以引用计数为初值, 减去来自同一集合内对象的引用, 剩余部分即来自集合外(操作数栈、
+ *      调用帧、常量池、更老的代等)的引用;
+ *   2. 从仍有外部引用的对象出发标记可达对象;
+ *   3. 其余对象只被环内引用持有, 先临时持有它们, 清空它们持有的引用(打断环), 再释放.
+ * 存活者晋升到下一代. 回收只在安全点进行, 此时所有活对象都已被计数.
+ */
+#include <chrono>
+#include <unordered_map>
+
+#include "vm.hpp"
+#include "../models/models.hpp"
+
+namespace kiz {
+
+namespace {
+
+// 自上次回收第i代以来, 第i-1代被回收的次数
+size_t collections_since[gc_generation_count] {};
+
+} // namespace
+
+size_t Vm::collect_cycles(size_t generation) {
+    const auto start = std::chrono::steady_clock::now();
+    generation = std::min(generation, gc_generation_count - 1);
+    auto& gen = model::gc_generations[generation];
+
+    // 较年轻的代并入被回收的代, 统一处理
+    for (size_t g = 0; g < generation; ++g) {
+        auto& young = model::gc_generations[g];
+        while (young.size > 0) {
+            const auto o = young.items[young.size - 1];
+            young.remove(o);
+            gen.push(o, static_cast<uint8_t>(generation));
+        }
+    }
+    model::gc_young_count = 0;
+
+    // 1. 外部引用数 = 引用计数 - 集合内引用数. 集合内对象的下标即gc_index()
+    const std::vector<model::Object*> objects(gen.items, gen.items + gen.size);
+    std::vector<int64_t> external(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        external[i] = static_cast<int64_t>(objects[i]->get_refc_());
+    }
+    auto in_set = [generation](const model::Object* o) {
+        return o->gc_generation() <= generation;
+    };
+    auto subtract_internal = [&](model::Object* v) {
+        if (in_set(v)) --external[v->gc_index()];
+    };
+    // 共享存储(写时复制)持有元素的引用一次; 共享它的容器全部在集合内时, 这些引用才是集合内引用.
+    // 共享者也可能在集合外(更老的代)或是原生函数中的临时副本, 此时元素视为被外部引用
+    std::unordered_map<const void*, std::pair<model::Object*, size_t>> shared;  // 存储 -> (任一共享者, 集合内共享者数)
+    for (const auto obj : objects) {
+        model::for_each_referent(obj, subtract_internal);
+        if (const auto storage = model::shared_storage(obj); storage.id) {
+            auto& [owner, count] = shared[storage.id];
+            owner = obj;
+            ++count;
+        }
+    }
+    for (const auto& [id, entry] : shared) {
+        const auto& [owner, count] = entry;
+        if (count == model::shared_storage(owner).owners) model::for_each_stored(owner, subtract_internal);
+    }
+
+    // 2. 从有外部引用的对象出发标记可达对象
+    std::vector<uint8_t> reachable(objects.size(), 0);
+    std::vector<model::Object*> worklist;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (external[i] > 0) {
+            reachable[i] = 1;
+            worklist.push_back(objects[i]);
+        }
+    }
+    auto mark = [&](model::Object* v) {
+        if (in_set(v) and !reachable[v->gc_index()]) {
+            reachable[v->gc_index()] = 1;
+            worklist.push_back(v);
+        }
+    };
+    while (!worklist.empty()) {
+        const auto obj = worklist.back();
+        worklist.pop_back();
+        model::for_each_referent(obj, mark);
+        if (model::shared_storage(obj).id) model::for_each_stored(obj, mark);
+    }
+
+    // 存活者晋升, 垃圾从登记表移除
+    const auto next = static_cast<uint8_t>(std::min(generation + 1, gc_generation_count - 1));
+    std::vector<model::Object*> garbage;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (reachable[i]) {
+            if (next != generation) {
+                gen.remove(objects[i]);
+                model::gc_generations[next].push(objects[i], next);
+            }
+        } else {
+            gen.remove(objects[i]);
+            garbage.push_back(objects[i]);
+        }
+    }
+
+    // 3. 临时持有全部垃圾, 打断环后再释放; 环外只被垃圾引用的对象随之正常析构
+    size_t freed = 0;
+    if (!garbage.empty()) {
+        for (const auto obj : garbage) obj->make_ref();
+        std::vector<model::Object*> referents;
+        for (const auto obj : garbage) {
+            model::for_each_referent(obj, [&referents](model::Object* v) { referents.push_back(v); });
+            model::clear_referents(obj);
+        }
+        ++model::proto_epoch;  // 垃圾中可能有原型, 使属性缓存与魔术方法槽位失效
+        for (const auto v : referents) v->del_ref();
+        for (const auto obj : garbage) {
+            if (obj->get_refc_() == 1) ++freed;
+            obj->del_ref();
+        }
+    }
+
+    const auto pause = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    ++gc_stats.collections[generation];
+    gc_stats.collected += freed;
+    gc_stats.total_pause_ns += pause;
+    gc_stats.max_pause_ns = std::max(gc_stats.max_pause_ns, pause);
+    gc_stats.last_pause_ns = pause;
+
+    for (size_t g = 0; g <= generation; ++g) collections_since[g] = 0;
+    if (generation + 1 < gc_generation_count) ++collections_since[generation + 1];
+    return freed;
+}
+
+void Vm::collect_cycles_if_needed() {
+    if (!gc_enabled) {
+        model::gc_young_count = 0;
+        return;
+    }
+    // 选择计数超过阈值的最老一代, 与它之下的各代一起回收
+    size_t generation = 0;
+    for (size_t g = gc_generation_count - 1; g > 0; --g) {
+        if (collections_since[g] >= gc_thresholds[g]) {
+            generation = g;
+            break;
+        }
+    }
+    collect_cycles(generation);
+}
+
+} // namespace kiz
@@ -3,35 +3,72 @@
 #include "vm.hpp"
 #include "../models/models.hpp"
 #include "opcode/opcode.hpp"
-#include <unordered_set>
+#include <array>
+#include <optional>
 
 namespace kiz {
 
 bool Vm::is_true(model::Object* obj) {
-    if (const auto bool_obj = dynamic_cast<const model::Bool*>(obj)) {
-        return bool_obj->val==true;
-    }
-    if (dynamic_cast<const model::Nil*>(obj)) {
-        return false;
+    if (model::is_imm_int(obj)) {
+        if (model::magic_intact(model::BuiltinKind::Int, model::magic_bit(model::Magic::Bool))) {
+            return model::imm_int_value(obj) != 0;
+        }
+    } else {
+        switch (obj->get_type()) {
+            case model::Object::ObjectType::Bool: return model::as<model::Bool>(obj)->val;
+            case model::Object::ObjectType::Nil: return false;
+            default: break;
+        }
     }
 
-    call_method(obj, "__bool__", {});
+    call_magic(obj, model::Magic::Bool, {});
     auto result = simple_get_and_pop_stack_top();
     bool ret = is_true(result);
 
     return ret;
 }
 
-model::Object* Vm::get_attr(model::Object* obj, const std::string& attr_name) {
+namespace {
+const size_t parent_name_hash = dep::hash_string("__parent__");
+
+const auto magic_name_strings = [] {
+    std::array<std::string, model::magic_count> names;
+    for (size_t i = 0; i < model::magic_count; ++i) names[i] = std::string(model::magic_names[i]);
+    return names;
+}();
+
+const auto magic_name_hashes = [] {
+    std::array<size_t, model::magic_count> hashes {};
+    for (size_t i = 0; i < model::magic_count; ++i) hashes[i] = dep::hash_string(std::string(model::magic_names[i]));
+    return hashes;
+}();
+
+///| 沿原型链查找属性, 找不到返回nullptr
+model::Object* lookup_attr_chain(model::Object* obj, const std::string& attr_name, const size_t hash) {
+    while (obj) {
+        if (const auto attr_it = obj->attrs.find_hashed(attr_name, hash)) {
+            return attr_it->value;
+        }
+        const auto parent_it = obj->attrs.find_hashed("__parent__", parent_name_hash);
+        obj = parent_it ? parent_it->value : nullptr;
+    }
+    return nullptr;
+}
+} // namespace
+
+model::Object* Vm::try_get_attr(model::Object* obj, const std::string& attr_name) {
     assert(obj != nullptr);
-    const auto attr_it = obj->attrs.find(attr_name);
-    auto parent_it = obj->attrs.find("__parent__");
-    if (attr_it) {
-        return attr_it->value;
+    if (model::is_imm_int(obj)) {
+        // 立即数没有自身属性, 直接从Int的原型开始查找
+        if (attr_name == "__parent__") return model::based_int;
+        obj = model::based_int;
     }
+    return lookup_attr_chain(obj, attr_name, dep::hash_string(attr_name));
+}
 
-    if (parent_it) {
-        return get_attr(parent_it->value, attr_name);
+model::Object* Vm::get_attr(model::Object* obj, const std::string& attr_name) {
+    if (const auto attr_val = try_get_attr(obj, attr_name)) {
+        return attr_val;
     }
 
     throw NativeFuncError("NameError",
@@ -39,208 +76,390 @@ model::Object* Vm::get_attr(model::Object* obj, const std::string& attr_name) {
     );
 }
 
-model::Object* Vm::get_attr_current(model::Object* obj, const std::string& attr) {
+model::Object* Vm::get_attr_cached(model::Object* obj, const size_t name_idx, AttrCache& cache) {
+    const auto code_object = call_stack.back()->code_object;
+    const std::string& attr_name = code_object->attr_names[name_idx];
+    const size_t hash = code_object->attr_hashes[name_idx];
+
+    model::Object* parent;
+    if (model::is_imm_int(obj)) {
+        if (hash == parent_name_hash and attr_name == "__parent__") return model::based_int;
+        parent = model::based_int;
+    } else if (const auto shape = obj->attrs.shape(); shape and shape == cache.shape) {
+        // Shape命中: 属性或__parent__的槽位已知, 不需要查找
+        const auto slot_val = obj->attrs.slot(cache.slot).value;
+        if (cache.own) return slot_val;
+        parent = slot_val;
+    } else if (shape) {
+        if (const uint32_t idx = shape->find(attr_name, hash); idx != model::Shape::npos) {
+            cache.shape = shape;
+            cache.slot = idx;
+            cache.own = true;
+            return obj->attrs.slot(idx).value;
+        }
+        const uint32_t parent_idx = shape->find("__parent__", parent_name_hash);
+        if (parent_idx == model::Shape::npos) {
+            throw NativeFuncError("NameError",
+                "Undefined attribute '" + attr_name + "'"
+            );
+        }
+        cache.shape = shape;
+        cache.slot = parent_idx;
+        cache.own = false;
+        parent = obj->attrs.slot(parent_idx).value;
+    } else {
+        // 字典模式的对象只缓存原型链部分
+        if (const auto attr_it = obj->attrs.find_hashed(attr_name, hash)) {
+            return attr_it->value;
+        }
+        const auto parent_it = obj->attrs.find_hashed("__parent__", parent_name_hash);
+        if (!parent_it) {
+            throw NativeFuncError("NameError",
+                "Undefined attribute '" + attr_name + "'"
+            );
+        }
+        parent = parent_it->value;
+    }
+
+    if (cache.parent == parent and cache.epoch == model::proto_epoch) {
+        return cache.value;
+    }
+
+    const auto attr_val = lookup_attr_chain(parent, attr_name, hash);
+    if (!attr_val) {
+        throw NativeFuncError("NameError",
+            "Undefined attribute '" + attr_name + "'"
+        );
+    }
+    cache.parent = parent;
+    cache.value = attr_val;
+    cache.epoch = model::proto_epoch;
+    return attr_val;
+}
+
+model::Object* Vm::try_get_attr_current(model::Object* obj, const std::string& attr) {
+    if (model::is_imm_int(obj)) return nullptr;  // 立即数没有自身属性
     const auto attr_it = obj->attrs.find(attr);
-    if (attr_it) {
-        return attr_it->value;
+    return attr_it ? attr_it->value : nullptr;
+}
+
+model::Object* Vm::get_attr_current(model::Object* obj, const std::string& attr) {
+    if (const auto attr_val = try_get_attr_current(obj, attr)) {
+        return attr_val;
     }
     throw NativeFuncError("NameError",
         "Undefined attribute '" + attr + "'" + " of current attributes table"
     );
 }
 
-void Vm::handle_call(model::Object* func_obj, model::Object* args_obj, model::Object* self){
-    assert(func_obj != nullptr);
-    assert(args_obj != nullptr);
-    auto args_list = dynamic_cast<model::List*>(args_obj);
+namespace {
+///| 复用的原生函数参数列表: 只有走List约定的原生函数需要参数列表.
+///| 调用结束后若列表没有被原生函数保存(引用计数只剩池自身), 清空后放回池中
+std::vector<model::List*> free_args_lists;
+
+model::List* acquire_args_list() {
+    if (free_args_lists.empty()) {
+        const auto list = new model::List({});
+        list->make_ref();
+        return list;
+    }
+    const auto list = free_args_lists.back();
+    free_args_lists.pop_back();
+    return list;
+}
+
+void release_args_list(model::List* list) {
+    if (list->get_refc_() != 1) {
+        // 被原生函数保存了, 交给新的持有者
+        list->del_ref();
+        return;
+    }
+    if (list->val.shared()) {
+        // 元素存储被复制走了, 元素的引用归共享它的其他List
+        list->val.forget();
+    } else {
+        for (const auto elem : list->val) elem->del_ref();
+        list->val.clear();
+    }
+    free_args_lists.push_back(list);
+}
+
+///| 弹出并释放操作数栈上base及以上的值(调用异常退出时使用)
+void drop_stack_from(const size_t base) {
+    while (Vm::op_stack.size() > base) {
+        model::unref_value(Vm::op_stack.back());
+        Vm::op_stack.pop_back();
+    }
+}
+} // namespace
 
-    assert(args_list && "CALL: 栈顶-1元素非List类型（参数必须封装为列表）");
+void Vm::handle_call(model::Object* func_obj, const size_t argc, model::Object* self){
+    assert(func_obj != nullptr);
+    assert(op_stack.size() >= argc);
     DEBUG_OUTPUT("start to call function");
+    const size_t args_base = op_stack.size() - argc;
 
     // 分类型处理函数调用（Function / NativeFunction）
-    if (const auto cpp_func = dynamic_cast<model::NativeFunction*>(func_obj)) {
+    if (func_obj->get_type() == model::Object::ObjectType::NativeFunction) {
         // -------------------------- 处理 NativeFunction 调用 --------------------------
-        model::Object* return_val = cpp_func->func(self, args_list);
-
-        // 管理返回值引用计数：返回值压栈前必须 make_ref
-        if (!return_val){
-            // 若返回空，默认压入 Nil（避免栈异常）
-            return_val = model::unique_nil;
+        const auto cpp_func = static_cast<model::NativeFunction*>(func_obj);
+
+        // 参数拷贝到本地缓冲区再传入, 原生函数回调kiz代码时操作数栈可能重新分配
+        model::Object* small_buf[8];
+        std::vector<model::Object*> large_buf;
+        model::Object** args = small_buf;
+        if (argc > std::size(small_buf)) {
+            large_buf.resize(argc);
+            args = large_buf.data();
         }
+        std::copy_n(op_stack.begin() + static_cast<std::ptrdiff_t>(args_base), argc, args);
 
-        // 返回值压入操作数栈
-        push_to_stack(return_val);
-    } else if (auto func = dynamic_cast<model::Function*>(func_obj)) {
+        model::Object* return_val;
+        try {
+            return_val = call_native(cpp_func, self, std::span<model::Object* const>(args, argc));
+        } catch (...) {
+            drop_stack_from(args_base);
+            throw;
+        }
+        // 返回值已被持有, 它可能就是某个参数, 因此在弹出参数之前取得
+        drop_stack_from(args_base);
+        op_stack.push_back(return_val);
+    } else if (func_obj->get_type() == model::Object::ObjectType::Function) {
         // -------------------------- 处理 Function 调用 --------------------------
+        const auto func = static_cast<model::Function*>(func_obj);
         DEBUG_OUTPUT("call Function: " + func->name);
 
         // 校验参数数量
+        const bool bind_self = self and self->get_type() != model::Object::ObjectType::Module;
         const size_t required_argc = func->argc;
-        size_t actual_argc;
-        if (self and self->get_type() != model::Object::ObjectType::Module) {
-            actual_argc = args_list->val.size() + 1;
-        } else {
-            actual_argc = args_list->val.size();
-        }
-        if (actual_argc != required_argc and !func->has_rest_params)
+        const size_t actual_argc = bind_self ? argc + 1 : argc;
+        if (func->has_rest_params ? actual_argc + 1 < required_argc : actual_argc != required_argc) {
+            drop_stack_from(args_base);
             throw NativeFuncError("ArgCountError", std::format(
                 "expect {} arguments but got {} arguments", required_argc, actual_argc
             ));
+        }
 
-        // 创建新调用帧
-        func->make_ref();
-        func->code->make_ref();
-        auto new_frame = new CallFrame{
-            .name = func->name,
-
-            .owner = func,
-
-            .pc = 0,
-            .return_to_pc = call_stack.back()->pc + 1,
-            .last_bp = call_stack.back()->bp,
-            .bp = op_stack.size(),
-            .code_object = func->code,
-
-            .iters{},
-
-            .curr_error = nullptr,
-            .exec_ensure_stmt = false
-        };
-        op_stack.resize(op_stack.size() + func->code->locals_count);
+        // 新帧的局部变量区从第一个参数(或self)开始
+        const size_t bp = args_base;
+        try {
+            push_frame(func, func->code, bp);
+        } catch (NativeFuncError&) {
+            drop_stack_from(args_base);
+            throw;
+        }
 
-        // 储存self
-        if (self and self->get_type() != model::Object::ObjectType::Module) {
+        // 储存self: 放在参数之前, 作为第0个局部变量
+        if (bind_self) {
             self->make_ref();
-            args_list->val.emplace(args_list->val.begin(), self);
+            op_stack.insert(op_stack.begin() + static_cast<std::ptrdiff_t>(args_base), self);
         }
 
-        if (func->has_rest_params) {
-            for (size_t i = 0; i < required_argc; ++i) {
-                std::string param_name = new_frame->code_object->var_names[i];
-                model::Object* param_val;
-                if (i == required_argc - 1 ) {
-                    args_list->val.assign(args_list->val.begin() + i, args_list->val.end());
-                    param_val = args_list;
-                }
-                else {
-                    param_val = args_list->val[i];  // 从列表取参数
-                }
-
-                assert(param_val);
-                param_val->make_ref();
-                op_stack[new_frame->bp + i] = param_val;
+        // 参数已在操作数栈上, 直接成为新帧的局部变量槽
+        for (size_t i = bp; i < op_stack.size(); ++i) {
+            // 小整数以立即数存入locals, 以便特化指令的守卫命中
+            model::Object* const param_val = op_stack[i];
+            assert(param_val != nullptr);
+            if (const auto unboxed = model::unbox_value(param_val); unboxed != param_val) {
+                op_stack[i] = unboxed;
+                param_val->del_ref();
             }
-
-            call_stack.emplace_back(new_frame);
-            return;
         }
 
-        // 从参数列表中提取参数，存入locals
-        for (size_t i = 0; i < required_argc; ++i) {
-            std::string param_name = new_frame->code_object->var_names[i];
-            model::Object* param_val = args_list->val[i];  // 从列表取参数
-
-            // 校验参数非空
-            assert(param_val != nullptr);
-
-            // 增加参数引用计数（存入locals需持有引用）
-            param_val->make_ref();
-            op_stack[new_frame->bp + i] = param_val;
+        if (func->has_rest_params) {
+            // 剩余参数打包为List, 放入最后一个参数槽
+            const size_t rest_begin = bp + required_argc - 1;
+            std::vector<model::Object*> rest;
+            rest.reserve(op_stack.size() - rest_begin);
+            for (size_t i = rest_begin; i < op_stack.size(); ++i) {
+                rest.push_back(model::box_value(op_stack[i]));
+            }
+            const auto rest_list = new model::List(rest);
+            drop_stack_from(rest_begin);
+            push_to_stack(rest_list);
         }
 
-        // 压入新调用帧，更新程序计数器
-        call_stack.emplace_back(new_frame);
+        op_stack.resize(bp + func->code->locals_count);
 
     // 处理对象魔术方法__call__
     } else {
-        model::Object* callable;
-        try {
-            callable = get_attr(func_obj, "__call__");
-        } catch (NativeFuncError& e) {
+        const auto callable = try_get_attr(func_obj, "__call__");
+        if (!callable) {
+            drop_stack_from(args_base);
             throw NativeFuncError("TypeError", "try to call an uncallable object");
         }
-        assert(callable);
-        handle_call(callable, args_obj, func_obj);
+        handle_call(callable, argc, func_obj);
+    }
+}
+
+model::Object* Vm::call_native(model::NativeFunction* func, model::Object* self, const std::span<model::Object* const> args) {
+    model::Object* return_val;
+    if (func->fast) {
+        return_val = func->fast(self, args);
+    } else {
+        // List约定: 参数(立即数装箱)放入复用的参数列表
+        const auto args_list = acquire_args_list();
+        for (auto arg : args) {
+            arg = model::box_value(arg);
+            arg->make_ref();
+            args_list->val.push_back(arg);
+        }
+        try {
+            return_val = func->func(self, args_list);
+        } catch (...) {
+            release_args_list(args_list);
+            throw;
+        }
+        if (!return_val) return_val = model::unique_nil;
+        model::ref_value(return_val);
+        release_args_list(args_list);
+        return return_val;
     }
+    // 若返回空，默认返回 Nil（避免栈异常）
+    if (!return_val) return_val = model::unique_nil;
+    model::ref_value(return_val);
+    return return_val;
 }
 
-void Vm::call_function(model::Object* func_obj, std::vector<model::Object*> args, model::Object* self) {
+void Vm::call_function(model::Object* func_obj, const std::span<model::Object* const> args, model::Object* self) {
+    if (run_depth >= max_native_depth) {
+        throw NativeFuncError("RecursionError", std::format(
+            "maximum native re-entry depth {} exceeded", max_native_depth
+        ));
+    }
     size_t old_call_stack_size = call_stack.size();
 
-    auto temp_args = new model::List(std::move(args));
-    temp_args->make_ref();
-    handle_call(func_obj, temp_args, self);
-    temp_args->del_ref();
+    for (const auto arg : args) {
+        push_to_stack(arg);
+    }
+    handle_call(func_obj, args.size(), self);
 
     if (old_call_stack_size == call_stack.size()) return;
 
-    while (running and !call_stack.empty() and call_stack.size() > old_call_stack_size) {
-        auto curr_frame = call_stack.back();
-        auto& frame_code = curr_frame->code_object;
+    // 新帧的RET会弹出自身并压入返回值, 调用方的pc由调用方自己的指令处理器维护
+    run_frames(old_call_stack_size);
+
+    // 没有执行RET就走到代码末尾的帧直接弹出
+    while (call_stack.size() > old_call_stack_size) {
+        pop_frame();
+    }
+}
+
+void Vm::call_function(model::Object* func_obj, const std::vector<model::Object*>& args, model::Object* self) {
+    call_function(func_obj, std::span<model::Object* const>(args), self);
+}
+
+model::Object* Vm::get_magic(model::Object* proto, const model::Magic magic) {
+    auto& slots = proto->magic_slots;
+    if (!slots) slots = std::make_unique<model::MagicSlots>();
+    if (slots->epoch != model::proto_epoch) {
+        // 原型链上有属性变化, 整表作废
+        slots->resolved = 0;
+        slots->epoch = model::proto_epoch;
+    }
+    const auto idx = static_cast<size_t>(magic);
+    const uint32_t bit = 1u << idx;
+    if (!(slots->resolved & bit)) {
+        slots->methods[idx] = lookup_attr_chain(proto, magic_name_strings[idx], magic_name_hashes[idx]);
+        slots->resolved |= bit;
+    }
+    return slots->methods[idx];
+}
 
-        // 检查是否执行到模块代码末尾：执行完毕则出栈
-        if (curr_frame->pc >= frame_code->code.size()) {
-            call_stack.pop_back();
-            continue;
+namespace {
+model::Object* builtin_proto(const model::BuiltinKind kind) {
+    switch (kind) {
+    case model::BuiltinKind::Int: return model::based_int;
+    case model::BuiltinKind::Float: return model::based_float;
+    case model::BuiltinKind::Str: return model::based_str;
+    case model::BuiltinKind::List: return model::based_list;
+    default: return nullptr;
+    }
+}
+} // namespace
+
+void Vm::record_builtin_magic() {
+    auto& guard = model::builtin_magic_guard;
+    for (size_t k = 0; k < model::builtin_kind_count; ++k) {
+        const auto proto = builtin_proto(static_cast<model::BuiltinKind>(k));
+        for (size_t i = 0; i < model::magic_count; ++i) {
+            guard.installed[k][i] = get_magic(proto, static_cast<model::Magic>(i));
         }
+        guard.intact[k] = UINT32_MAX;
+    }
+    guard.epoch = model::builtin_magic_epoch;
+}
 
-        // 执行当前指令
-        const Instruction& curr_inst = frame_code->code[curr_frame->pc];
-        try {
-            if (curr_inst.opc == Opcode::RET and old_call_stack_size == call_stack.size() - 1) {
-                assert(!call_stack.empty());
-                call_stack.pop_back();
-                return;
-            }
-            execute_unit(curr_inst); // 调用VM的指令执行核心方法
-        } catch (const NativeFuncError& e) {
-            // 原生函数执行错误，抛出异常
-            forward_to_handle_throw(e.name, e.msg);
-            continue;
+void Vm::refresh_builtin_magic() {
+    auto& guard = model::builtin_magic_guard;
+    for (size_t k = 0; k < model::builtin_kind_count; ++k) {
+        const auto proto = builtin_proto(static_cast<model::BuiltinKind>(k));
+        uint32_t intact = 0;
+        for (size_t i = 0; i < model::magic_count; ++i) {
+            const auto magic = static_cast<model::Magic>(i);
+            if (get_magic(proto, magic) == guard.installed[k][i]) intact |= model::magic_bit(magic);
         }
+        guard.intact[k] = intact;
+    }
+    guard.epoch = model::builtin_magic_epoch;
+}
+
+model::Object* Vm::find_magic(model::Object* obj, const model::Magic magic) {
+    assert(obj != nullptr);
+    if (model::is_imm_int(obj)) return get_magic(model::based_int, magic);
+    // 魔术方法不查找对象自身, 从其原型开始
+    const auto parent_it = obj->attrs.find_hashed("__parent__", parent_name_hash);
+    return parent_it ? get_magic(parent_it->value, magic) : nullptr;
+}
 
-        ADVANCE_PC
+void Vm::call_magic(model::Object* obj, const model::Magic magic, const std::span<model::Object* const> args) {
+    const auto method = find_magic(obj, magic);
+    if (!method) {
+        throw NativeFuncError("NameError",
+            "Undefined method '" + magic_name_strings[static_cast<size_t>(magic)] + "'"
+        );
+    }
+    std::optional<StackRef> boxed_self;
+    if (model::is_imm_int(obj)) {
+        // 方法的self可能被保存, 立即数需装箱
+        obj = model::box_value(obj);
+        obj->make_ref();
+        boxed_self.emplace(obj);
+    }
 
+    if (method->get_type() == model::Object::ObjectType::NativeFunction) {
+        op_stack.push_back(call_native(static_cast<model::NativeFunction*>(method), obj, args));
+        return;
     }
+    call_function(method, args, obj);
 }
 
-void Vm::call_method(model::Object* obj, const std::string& attr_name, std::vector<model::Object*> args) {
+void Vm::call_method(model::Object* obj, const std::string& attr_name, const std::vector<model::Object*>& args) {
     assert(obj != nullptr);
-    auto parent_it = obj->attrs.find("__parent__");
-    static const std::unordered_set<std::string_view> magic_methods = {
-    std::string_view("__add__"), std::string_view("__sub__"),
-    std::string_view("__mul__"), std::string_view("__div__"),
-    std::string_view("__pow__"), std::string_view("__mod__"),
-    std::string_view("__neg__"), std::string_view("__eq__"),
-    std::string_view("__gt__"), std::string_view("__lt__"),
-    std::string_view("__str__"), std::string_view("__dstr__"),
-    std::string_view("__bool__"), std::string_view("__getitem__"),
-    std::string_view("__setitem__"), std::string_view("contains"),
-    std::string_view("__next__"), std::string_view("__hash__")
-    };
-
-    const bool is_magic = magic_methods.contains(std::string_view(attr_name));
-    if (!is_magic) {
-        call_function(get_attr(obj, attr_name), args, obj);
+    if (const auto magic = model::magic_from_name(attr_name); magic != model::Magic::Count) {
+        call_magic(obj, magic, args);
         return;
     }
-
-    if (parent_it) {
-        call_function(get_attr(parent_it->value, attr_name), args, obj);
+    if (model::is_imm_int(obj)) {
+        // 方法的self可能被保存, 立即数需装箱
+        const auto boxed = model::box_value(obj);
+        boxed->make_ref();
+        call_function(get_attr(boxed, attr_name), args, boxed);
+        boxed->del_ref();
         return;
     }
-    throw NativeFuncError("NameError",
-        "Undefined method '" + attr_name + "'"
-    );
+    call_function(get_attr(obj, attr_name), args, obj);
 }
 
 std::string Vm::obj_to_str(model::Object* for_cast_obj) {
     DEBUG_OUTPUT("obj to str");
-    try {
-        call_method(for_cast_obj, "__str__", {});
-    } catch (NativeFuncError& e) {
-        call_method(for_cast_obj, "__dstr__", {});
+    if (model::is_imm_int(for_cast_obj)
+        and model::magic_intact(model::BuiltinKind::Int, model::magic_bit(model::Magic::Str))) {
+        return std::to_string(model::imm_int_value(for_cast_obj));
     }
+    // 没有__str__时退回__dstr__; 方法自身抛出的错误照常传播
+    call_magic(for_cast_obj,
+        find_magic(for_cast_obj, model::Magic::Str) ? model::Magic::Str : model::Magic::Dstr, {});
     auto res = simple_get_and_pop_stack_top();
     std::string val = model::cast_to_str(res)->val;
     return val;
@@ -249,11 +468,13 @@ std::string Vm::obj_to_str(model::Object* for_cast_obj) {
 
 std::string Vm::obj_to_debug_str(model::Object* for_cast_obj) {
     DEBUG_OUTPUT("obj to debug str");
-    try {
-        call_method(for_cast_obj, "__dstr__", {});
-    } catch (NativeFuncError& e) {
-        call_method(for_cast_obj, "__str__", {});
+    if (model::is_imm_int(for_cast_obj) and model::magic_intact(model::BuiltinKind::Int,
+            model::magic_bit(model::Magic::Str) | model::magic_bit(model::Magic::Dstr))) {
+        return std::to_string(model::imm_int_value(for_cast_obj));
     }
+    // 没有__dstr__时退回__str__
+    call_magic(for_cast_obj,
+        find_magic(for_cast_obj, model::Magic::Dstr) ? model::Magic::Dstr : model::Magic::Str, {});
     auto res = simple_get_and_pop_stack_top();
     std::string val = model::cast_to_str(res) ->val;
     return val;
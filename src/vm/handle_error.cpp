@@ -1,4 +1,5 @@
 #include <ranges>
+#include <span>
 
 #include "vm.hpp"
 #include "builtins/include/builtin_functions.hpp"
@@ -27,6 +28,8 @@ void Vm::forward_to_handle_throw(const std::string& name, const std::string& con
 
 void Vm::handle_throw() {
     assert(call_stack.back()->curr_error);
+    // 展开会释放操作数栈上的值, 借用的操作数必须已在慢速路径入口补上引用(见own_borrowed)
+    assert(borrowed_on_stack == 0 && "exception raised while operands were borrowed");
 
     // 提取错误对象的 __name__ 和 __msg__
     auto err = call_stack.back()->curr_error;
@@ -46,36 +49,66 @@ void Vm::handle_throw() {
     // 执行ensure确保资源被释放
     handle_ensure();
 
-    // 逆序遍历调用栈
-    for (auto frame : std::ranges::reverse_view(call_stack)) {
-        for (const auto& table : frame->code_object->exception_tables) {
+    // 逆序遍历最内层run_frames的栈帧; 更低的栈帧之上还有原生代码(如运算符慢速路径)的C++栈帧,
+    // 其操作数在那些代码返回前不能被释放
+    for (auto& frame : std::ranges::reverse_view(std::span(call_stack.begin() + run_base, call_stack.end()))) {
+        for (const auto& table : frame.code_object->exception_tables) {
             // 检查当前 pc 是否在此 try 块的范围内
-            size_t current_pc = frame->pc;
+            size_t current_pc = frame.pc;
             if (table.try_part_start_pc <= current_pc and current_pc < table.try_part_end_pc) {
                 // 寻找匹配的 catch 块
                 if (auto catch_start_pc_it = table.handle_pc.find(error_name)) {
-                    frame->pc = catch_start_pc_it->value;
+                    frame.pc = catch_start_pc_it->value;
                 } else {
-                    frame->pc = table.mismatch_pc;
+                    frame.pc = table.mismatch_pc;
                 }
 
-                // 弹出多余的栈帧
+                // 弹出多余的栈帧, 连同它们在操作数栈上的局部变量与临时值
                 for (size_t i = 0; i < frames_to_pop; ++i) {
-                    call_stack.pop_back();
+                    pop_frame();
                 }
                 err->make_ref();
-                frame->curr_error = err;
+                if (frame.curr_error) frame.curr_error->del_ref();
+                frame.curr_error = err;
                 return;
             }
         }
         ++frames_to_pop;
     }
 
+    if (run_base > 0) {
+        // 弹出本层全部栈帧, 把错误交给调用原生代码的栈帧, 由外层run_frames继续展开
+        for (size_t i = 0; i < frames_to_pop; ++i) {
+            pop_frame();
+        }
+        const auto caller = call_stack.back();
+        if (caller->curr_error) caller->curr_error->del_ref();
+        caller->curr_error = err;
+        throw KizUnwindSignal();
+    }
+
     // 没有找到任何能处理该异常的 try 块：打印错误信息并终止执行
-    if (const auto err_obj = dynamic_cast<model::Error*>(err)) {
+    if (const auto err_obj = model::dyn<model::Error>(err)) {
         std::cout << Color::BRIGHT_RED << "\nTrace Back: " << Color::RESET << std::endl;
-        for (auto& [_path, _pos] : err_obj->positions) {
-            err::context_printer(_path, _pos);
+        // 连续相同的位置(如深递归)只打印前几次, 其余折叠为一行
+        constexpr size_t max_repeat_shown = 3;
+        const auto& positions = err_obj->positions;
+        for (size_t i = 0; i < positions.size();) {
+            const auto& [_path, _pos] = positions[i];
+            size_t j = i + 1;
+            while (j < positions.size() and positions[j].first == _path
+                and positions[j].second.lno_start == _pos.lno_start and positions[j].second.lno_end == _pos.lno_end
+                and positions[j].second.col_start == _pos.col_start and positions[j].second.col_end == _pos.col_end) {
+                ++j;
+            }
+            const size_t shown = std::min(j - i, max_repeat_shown);
+            for (size_t k = 0; k < shown; ++k) {
+                err::context_printer(_path, _pos);
+            }
+            if (j - i > shown) {
+                std::cout << "  [Previous frame repeated " << j - i - shown << " more times]\n";
+            }
+            i = j;
         }
     }
 
@@ -94,35 +127,24 @@ void Vm::handle_ensure() {
     auto frame = call_stack.back();
     if (frame->exec_ensure_stmt) return;
 
-    auto ensures = frame->code_object->ensure_stmts;
-    if (ensures.empty()) {
+    auto code_object = frame->code_object;
+    if (code_object->ensure_stmts.empty()) {
         return;
     }
 
-    auto old_code = frame->code_object->code;
-    size_t old_pc = call_stack.back()->pc;
-    frame->code_object->code = ensures;
+    // 临时把ensure代码及其位置表换入当前帧的CodeObject
+    size_t old_pc = frame->pc;
+    std::swap(code_object->code, code_object->ensure_stmts);
+    std::swap(code_object->positions, code_object->ensure_positions);
+    std::swap(code_object->attr_caches, code_object->ensure_attr_caches);
     frame->pc = 0;
 
-    while (!call_stack.empty() && running) {
-        auto curr_frame = call_stack.back();
-        // 检查当前帧是否执行完毕
-        if (curr_frame->pc >= curr_frame->code_object->code.size()) {
-            break;
-        }
+    // 只执行当前帧中的ensure代码, 执行到末尾即返回
+    run_frames(call_stack.size() - 1);
 
-        // 执行当前指令
-        const Instruction& curr_inst = curr_frame->code_object->code[curr_frame->pc];
-        try {
-            execute_unit(curr_inst);
-        } catch (NativeFuncError& e) {
-            forward_to_handle_throw(e.name, e.msg);
-            continue;
-        }
-
-        ADVANCE_PC
-    }
-    frame->code_object->code = old_code;
+    std::swap(code_object->code, code_object->ensure_stmts);
+    std::swap(code_object->positions, code_object->ensure_positions);
+    std::swap(code_object->attr_caches, code_object->ensure_attr_caches);
     frame->pc = old_pc;
     frame->exec_ensure_stmt = true;
 }
@@ -170,8 +170,7 @@ void Vm::handle_import(const std::string& module_path) {
         content = err::SrcManager::get_file_by_path(actually_found_path.string());
 #endif
     } else if (auto std_init_it = std_modules.find(module_path)) {
-        auto std_init_func = dynamic_cast<model::NativeFunction*>(std_init_it->value);
-        assert(std_init_func != nullptr);
+        auto std_init_func = model::as<model::NativeFunction>(std_init_it->value);
 
         model::List* args_list = new model::List({});
         args_list->make_ref();
@@ -181,8 +180,7 @@ void Vm::handle_import(const std::string& module_path) {
 
         assert(return_val != nullptr);
 
-        auto module_obj = dynamic_cast<model::Module*>(return_val);
-        assert(module_obj != nullptr);
+        auto module_obj = model::as<model::Module>(return_val);
 
         push_to_stack(module_obj);
 
@@ -210,59 +208,19 @@ void Vm::handle_import(const std::string& module_path) {
 
     module_obj->make_ref();  // 先被handle_import这个函数持有
 
-    module_obj->make_ref();
-    module_obj->code->make_ref();
-    auto new_frame = new CallFrame{
-        .name = module_path,
-
-        .owner = module_obj,
-
-        .pc = 0,
-        .return_to_pc = module_obj->code->code.size() + 1,
-        .last_bp = call_stack.back()->bp,
-        .bp = op_stack.size(),
-        .code_object = module_obj->code,
-
-        .iters{},
-
-        .curr_error = nullptr,
-        .exec_ensure_stmt = false
-    };
-
     size_t old_call_stack_size = call_stack.size();
 
-    call_stack.emplace_back(new_frame);
+    push_frame(module_obj, module_obj->code, op_stack.size());
 
 
     /// 执行新代码
-    while (running and !call_stack.empty()) {
-        auto curr_frame = call_stack.back();
-        auto frame_code = curr_frame->code_object;
-
-        // 检查是否执行到模块代码末尾：执行完毕则出栈
-        if (curr_frame->pc >= frame_code->code.size()) {
-            if (old_call_stack_size == call_stack.size() - 1) {
-                break;
-            }
-            call_stack.pop_back();
-            continue;
-        }
-
-        // 执行当前指令
-        const Instruction& curr_inst = frame_code->code[curr_frame->pc];
-        try {
-            execute_unit(curr_inst); // 调用VM的指令执行核心方法
-        } catch (const NativeFuncError& e) {
-            // 原生函数执行错误，抛出异常
-            forward_to_handle_throw(e.name, e.msg);
-            continue;
-        }
-
-        ADVANCE_PC
-
-    }
+    run_frames(old_call_stack_size);
 
     for (size_t i = call_stack.back()->bp; i < call_stack.back()->bp + call_stack.back()->code_object->locals_count; ++i) {
+        if (model::is_imm_int(op_stack[i])) {
+            op_stack[i] = model::box_value(op_stack[i]);
+            op_stack[i]->make_ref();
+        }
         const auto local_object = op_stack[i];
         const auto name = call_stack.back()->code_object->var_names[i - call_stack.back()->bp];
         if (name.starts_with("__private__")) continue;
@@ -272,21 +230,8 @@ void Vm::handle_import(const std::string& module_path) {
     }
 
 
-    /// 处理delete frame
-    auto frame = call_stack.back();
-    call_stack.pop_back();
-    call_stack.back()->bp = frame->last_bp;
-
-    while (frame->bp < op_stack.size()) {
-        op_stack.back()->del_ref();
-        op_stack.pop_back();
-    }
-    frame->owner->del_ref();
-    frame->code_object->del_ref();
-    for (auto it: frame->iters) {
-        if (it) it->del_ref();
-    }
-    delete frame;
+    /// 弹出模块帧
+    pop_frame();
 
     /// 储存module
     push_to_stack(module_obj);
@@ -10,15 +10,15 @@ auto Vm::make_pos_info() -> std::vector<std::pair<std::string, err::PositionInfo
     std::vector<std::pair<std::string, err::PositionInfo>> positions;
     std::string path;
     for (const auto& frame: call_stack) {
-        if (const auto m = dynamic_cast<model::Module*>(frame->owner)) {
+        if (const auto m = model::dyn<model::Module>(frame.owner)) {
             path = m->path;
         }
         err::PositionInfo pos{};
         bool is_last_frame = frame_index == call_stack.size() - 1;
         if (is_last_frame) {
-            pos = frame->code_object->code.at(frame->pc).pos;
+            pos = frame.code_object->positions.find(frame.pc);
         } else {
-            pos = frame->code_object->code.at(frame->pc - 1).pos;
+            pos = frame.code_object->positions.find(frame.pc - 1);
         }
         positions.emplace_back(path, pos);
         ++frame_index;
@@ -48,31 +48,35 @@ void Vm::make_dict(size_t len) {
     const size_t total_elems = elem_count * 2;
     assert(op_stack.size() >= total_elems);
 
-    std::vector<std::pair<dep::BigInt, std::pair<model::Object*, model::Object*>>> elem_list;
+    std::vector<std::pair<model::Object*, model::Object*>> elem_list;
     elem_list.reserve(elem_count);
 
     for (size_t i = 0; i < elem_count; ++i) {
         auto value = simple_get_and_pop_stack_top(); // 弹出 value
         auto key = simple_get_and_pop_stack_top();   // 弹出 key
+        elem_list.emplace_back(key, value);
+    }
+    std::ranges::reverse(elem_list); // 恢复原序, 重复的键以后出现的为准
 
-        // 计算哈希
-        call_method(key, "__hash__", {});
-        auto hash_obj = simple_get_and_pop_stack_top();
-        auto hashed_int = dynamic_cast<model::Int*>(hash_obj);
-        if (!hashed_int) {
-            hash_obj->del_ref();
+    auto dict_obj = new model::Dictionary();
+    dict_obj->val.reserve(elem_count);
+    try {
+        for (auto& [key, value] : elem_list) {
+            dict_obj->insert(key, value); // 内部为 key/value make_ref
+        }
+    } catch (...) {
+        for (auto& [key, value] : elem_list) {
             key->del_ref();
             value->del_ref();
-            throw NativeFuncError("TypeError", "__hash__ must return an integer");
         }
-        elem_list.emplace_back(hashed_int->val, std::pair{key, value});
+        delete dict_obj;
+        throw;
+    }
 
-        hash_obj->del_ref();
+    for (auto& [key, value] : elem_list) {
         key->del_ref();
         value->del_ref();
     }
-
-    auto dict_obj = new model::Dictionary(dep::Dict(elem_list)); // 内部为 key/value make_ref
     push_to_stack(dict_obj);
 }
 }
\ No newline at end of file
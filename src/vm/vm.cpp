@@ -27,15 +27,116 @@ std::vector<std::string> Vm::builtin_names {};
 dep::HashMap<model::Module*> Vm::modules_cache {};
 model::Module* Vm::main_module;
 std::vector<model::Object*> Vm::op_stack {};
-std::vector<CallFrame*> Vm::call_stack {};
+FrameStack Vm::call_stack {};
+size_t Vm::max_call_depth = 1000;
 model::Int* Vm::small_int_pool[201] {};
 bool Vm::running = false;
 std::string Vm::main_file_path;
+QuickenStats Vm::quicken_stats {};
+GcStats Vm::gc_stats {};
+#ifndef NDEBUG
+size_t Vm::borrowed_on_stack = 0;
+#endif
+size_t Vm::gc_thresholds[gc_generation_count] = {700, 10, 10};
+bool Vm::gc_enabled = true;
+size_t Vm::run_depth = 0;
+size_t Vm::run_base = 0;
 std::vector<model::Object*> Vm::const_pool {};
 dep::HashMap<model::Object*> Vm::std_modules {};
 
 StackRef::~StackRef() { if (obj) obj->del_ref(); }
 
+namespace {
+///| 可借用操作数的消费者指令所消费的栈顶操作数个数, 0表示不参与借用.
+///| 这些指令的快速路径不执行kiz代码也不抛出异常(OP_MOD的除数为0时走慢速路径);
+///| 慢速路径在出栈前先为借用的操作数补上引用(own_borrowed)
+size_t borrowable_operands(const Opcode opc) {
+    switch (opc) {
+    case Opcode::OP_ADD: case Opcode::OP_SUB: case Opcode::OP_MUL: case Opcode::OP_DIV:
+    case Opcode::OP_MOD: case Opcode::OP_POW:
+    case Opcode::OP_EQ: case Opcode::OP_GT: case Opcode::OP_LT:
+    case Opcode::OP_GE: case Opcode::OP_LE: case Opcode::OP_NE:
+    case Opcode::OP_IS:
+        return 2;
+    case Opcode::OP_NEG: case Opcode::GET_ATTR: case Opcode::GET_ITEM:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+#ifndef NDEBUG
+bool is_borrowed_load(const Opcode opc) {
+    return opc == Opcode::LOAD_VAR_BORROW or opc == Opcode::LOAD_CONST_BORROW;
+}
+
+///| 检查标记结果: 每个借用加载恰好被紧随其后的一个消费者标记, 消费者与被借用的加载之间没有控制流入口
+bool borrowed_operands_consistent(const std::vector<Instruction>& code, const std::vector<bool>& is_entry) {
+    std::vector<uint8_t> consumed(code.size(), 0);
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const uint16_t bits = borrowable_operands(code[pc].opc) ? code[pc].opn_b : 0;
+        if (bits == 0) continue;
+        if (bits > 3 or !(bits & 1) or is_entry[pc]) return false;
+        if (pc < 1 or !is_borrowed_load(code[pc - 1].opc)) return false;
+        ++consumed[pc - 1];
+        if (bits & 2) {
+            if (borrowable_operands(code[pc].opc) != 2 or pc < 2 or is_entry[pc - 1]
+                or !is_borrowed_load(code[pc - 2].opc)) return false;
+            ++consumed[pc - 2];
+        }
+    }
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (is_borrowed_load(code[pc].opc) != (consumed[pc] == 1)) return false;
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+///| 借用操作数标记(窥孔): 消费者指令紧跟在LOAD_VAR/LOAD_CONST之后时, 被加载的值在被消费前
+///| 一直由局部变量槽或常量池持有, 压栈时的make_ref和出栈时的del_ref可以成对省去.
+///|   栈顶操作数: code[pc-1]为加载指令
+///|   次栈顶操作数: code[pc-2]和code[pc-1]都为加载指令
+///| 被借用的加载改写为*_BORROW, 消费者opn_b的第0/1位分别标记栈顶/次栈顶操作数为借用.
+///| 控制流可能从别处进入的位置(跳转目标, FOR_ITER跳过SET_LOCAL后的位置,
+///| 以及entry_pcs给出的异常处理入口)之后的操作数不参与借用
+void mark_borrowed_operands(std::vector<Instruction>& code, const std::vector<size_t>& entry_pcs) {
+    std::vector<bool> is_entry(code.size() + 2, false);
+    for (const auto pc : entry_pcs) {
+        if (pc < is_entry.size()) is_entry[pc] = true;
+    }
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const auto& inst = code[pc];
+        if ((inst.opc == Opcode::JUMP or inst.opc == Opcode::JUMP_IF_FALSE or inst.opc == Opcode::FOR_ITER)
+            and inst.opn < is_entry.size()) {
+            is_entry[inst.opn] = true;
+        }
+        // Range的快速路径直接写入循环变量, 从pc + 2继续执行
+        if (inst.opc == Opcode::FOR_ITER) is_entry[pc + 2] = true;
+    }
+
+    const auto is_load = [&code](const size_t pc) {
+        return code[pc].opc == Opcode::LOAD_VAR or code[pc].opc == Opcode::LOAD_CONST;
+    };
+    const auto borrow = [&code](const size_t pc) {
+        code[pc].opc = code[pc].opc == Opcode::LOAD_VAR ? Opcode::LOAD_VAR_BORROW : Opcode::LOAD_CONST_BORROW;
+    };
+
+    for (size_t pc = 1; pc < code.size(); ++pc) {
+        const size_t operands = borrowable_operands(code[pc].opc);
+        // opn_b非0的指令把它用作操作数, 不能再存放借用标记
+        if (operands == 0 or code[pc].opn_b != 0 or is_entry[pc] or !is_load(pc - 1)) continue;
+        if (operands == 2 and pc >= 2 and !is_entry[pc - 1] and is_load(pc - 2)) {
+            borrow(pc - 2);
+            code[pc].opn_b |= 2;
+        }
+        borrow(pc - 1);
+        code[pc].opn_b |= 1;
+    }
+    assert(borrowed_operands_consistent(code, is_entry));
+}
+
 Vm::Vm(const std::string& file_path_) {
     main_file_path = file_path_;
     DEBUG_OUTPUT("entry builtin functions...");
@@ -54,11 +155,13 @@ Vm::Vm(const std::string& file_path_) {
     model::based_native_function->mark_as_important();
     model::based_error->mark_as_important();
     model::based_decimal->mark_as_important();
+    model::based_float->mark_as_important();
     model::based_module->mark_as_important();
     model::stop_iter_signal->mark_as_important();
     model::based_file_handle->mark_as_important();
     model::based_code_object->mark_as_important();
     model::based_range->mark_as_important();
+    model::based_iterator->mark_as_important();
 
     for (dep::BigInt i = 0; i < 201; i+= 1) {
         auto int_obj = new model::Int{i};
@@ -67,6 +170,17 @@ Vm::Vm(const std::string& file_path_) {
     }
     entry_builtins();
     entry_std_modules();
+
+    // 帧区域按最大调用深度一次性分配; 操作数栈预留空间, 避免调用过程中整体搬迁
+    if (call_stack.empty()) call_stack.reserve(max_call_depth);
+    op_stack.reserve(op_stack_reserve);
+
+    // 退出(包括os.exit)前释放延迟释放队列中剩余的对象, 例如仍未关闭的文件句柄
+    static bool flush_registered = false;
+    if (!flush_registered) {
+        std::atexit(model::flush_free_queue);
+        flush_registered = true;
+    }
 }
 
 void Vm::set_main_module(model::Module* src_module) {
@@ -80,27 +194,7 @@ void Vm::set_main_module(model::Module* src_module) {
 
     // 创建模块级调用帧（CallFrame）：模块是顶层执行单元，对应一个顶层调用帧
     op_stack.resize(src_module->code->locals_count);
-    src_module->make_ref(); // owner
-    src_module->code->make_ref();
-    auto module_call_frame = new CallFrame{
-        .name = src_module->path,
-
-        .owner = src_module,
-
-        .pc = 0,
-        .return_to_pc = src_module->code->code.size(),
-        .last_bp = 0,
-        .bp = 0,
-        .code_object = src_module->code,
-
-        .iters{},
-
-        .curr_error = nullptr,
-        .exec_ensure_stmt = false
-    };
-
-    // 将调用帧压入VM的调用栈
-    call_stack.emplace_back(module_call_frame);
+    push_frame(src_module, src_module->code, 0);
 
     // 初始化VM执行状态：标记为"就绪"
     running = true; // 标记VM为运行状态（等待exec触发执行）
@@ -110,53 +204,89 @@ void Vm::set_main_module(model::Module* src_module) {
 }
 
 void Vm::exec_curr_code() {
-    // 循环执行当前调用帧下的所有指令
-    while (!call_stack.empty() && running) {
-        auto curr_frame = call_stack.back();
-        // 检查当前帧是否执行完毕
-        if (curr_frame->pc >= curr_frame->code_object->code.size()) {
-            // 非模块帧则弹出，模块帧则退出循环
-            if (call_stack.size() == 1) {
-                break;
-            }
-            call_stack.pop_back();;
-            continue;
-        }
+    // 循环执行当前调用帧下的所有指令, 模块帧执行完毕即退出
+    run_frames(0);
+}
 
-        // 执行当前指令
-        const Instruction& curr_inst = curr_frame->code_object->code[curr_frame->pc];
+void Vm::run_frames(const size_t base_depth) {
+    struct DepthGuard {
+        size_t saved_base;
+        explicit DepthGuard(const size_t base) : saved_base(run_base) { ++run_depth; run_base = base; }
+        ~DepthGuard() { --run_depth; run_base = saved_base; }
+    } depth_guard(base_depth);
+    // try块只在进入分派循环时建立一次, 原生错误转发后重新进入循环
+    while (running and call_stack.size() > base_depth) {
         try {
-            // std::cout << "current instr: " << opcode_to_string(curr_inst.opc) << std::endl;
-            // std::cout << "Stack:" << std::endl;
-            // size_t j = 0;
-            // for (auto st_mem: op_stack) {
-            //     if (st_mem)
-            //         std::cout << j << ": " << st_mem->debug_string() << std::endl;
-            //     else
-            //         std::cout << j << ": " << "<nullptr>" << std::endl;
-            //     ++j;
-            // }
-            // std::cout << "==End==" << std::endl;
-            execute_unit(curr_inst);
-            // std::cout << "finish handle instr: " << opcode_to_string(curr_inst.opc) << std::endl;
-            // std::cout << "Stack:" << std::endl;
-            // j = 0;
-            // for (auto st_mem: op_stack) {
-            //     if (st_mem)
-            //         std::cout << j << ": " << st_mem->debug_string() << std::endl;
-            //     else
-            //         std::cout << j << ": " << "<nullptr>" << std::endl;
-            //     ++j;
-            // }
-            // std::cout << "==End==" << std::endl;
+            execute_unit(base_depth);
+            return;
         } catch (NativeFuncError& e) {
             forward_to_handle_throw(e.name, e.msg);
-            continue;
+        } catch (KizUnwindSignal&) {
+            // 本层的栈帧已全部弹出时交给更外层; 否则错误已放在栈顶帧, 从这里继续展开
+            if (call_stack.size() <= base_depth) throw;
+            handle_throw();
         }
-        ADVANCE_PC
     }
 }
 
+void Vm::dump_quicken_stats(std::ostream& out) {
+    out << "==== specialization stats ====\n";
+    out << std::format("{:<20}{:>12}{:>14}{:>12}{:>10}\n", "opcode", "specialized", "hits", "misses", "hit rate");
+    size_t total_hits = 0, total_misses = 0;
+    for (size_t i = static_cast<size_t>(Opcode::OP_ADD_INT_INT); i < opcode_count; ++i) {
+        const size_t hits = quicken_stats.hits[i];
+        const size_t misses = quicken_stats.misses[i];
+        if (quicken_stats.specialized[i] == 0) continue;
+        total_hits += hits;
+        total_misses += misses;
+        out << std::format("{:<20}{:>12}{:>14}{:>12}{:>9.2f}%\n",
+            opcode_to_string(static_cast<Opcode>(i)), quicken_stats.specialized[i], hits, misses,
+            100.0 * static_cast<double>(hits) / static_cast<double>(hits + misses == 0 ? 1 : hits + misses));
+    }
+    out << std::format("{:<20}{:>12}{:>14}{:>12}{:>9.2f}%\n", "total", "", total_hits, total_misses,
+        100.0 * static_cast<double>(total_hits) / static_cast<double>(total_hits + total_misses == 0 ? 1 : total_hits + total_misses));
+}
+
+CallFrame* Vm::push_frame(model::Object* owner, model::CodeObject* code_object, const size_t bp) {
+    if (call_stack.full()) {
+        throw NativeFuncError("RecursionError", std::format(
+            "maximum call depth {} exceeded", call_stack.capacity()
+        ));
+    }
+    owner->make_ref();
+    code_object->make_ref();
+    const auto frame = call_stack.push();
+    frame->owner = owner;
+    frame->pc = 0;
+    frame->bp = bp;
+    frame->code_object = code_object;
+    frame->curr_error = nullptr;
+    frame->exec_ensure_stmt = false;
+    return frame;
+}
+
+void Vm::pop_frame() {
+    const auto frame = call_stack.back();
+    while (op_stack.size() > frame->bp) {
+        model::unref_value(op_stack.back());
+        op_stack.pop_back();
+    }
+    for (const auto it : frame->iters) {
+        if (it) it->del_ref();
+    }
+    frame->iters.clear();
+    if (frame->curr_error) frame->curr_error->del_ref();
+    frame->owner->del_ref();
+    frame->code_object->del_ref();
+    call_stack.pop_back();
+}
+
+std::string Vm::frame_name(const CallFrame* frame) {
+    if (const auto func = model::dyn<model::Function>(frame->owner)) return func->name;
+    if (const auto mod = model::dyn<model::Module>(frame->owner)) return mod->path;
+    return "<unknown>";
+}
+
 CallFrame* Vm::get_frame() {
     if ( !call_stack.empty() ) {
         return call_stack.back();
@@ -165,17 +295,24 @@ CallFrame* Vm::get_frame() {
 }
 
 StackRef Vm::get_and_pop_stack_top() {
-    if(op_stack.empty()) throw KizStopRunningSignal("Unable to fetch top of stack");
-    auto stack_top = op_stack.back();
-    if (!stack_top) throw KizStopRunningSignal("Top of stack is free");
-    op_stack.pop_back();
-    return StackRef(stack_top);
+    return StackRef(simple_get_and_pop_stack_top());
 }
 
 model::Object* Vm::simple_get_and_pop_stack_top() {
+    auto stack_top = pop_stack_raw();
+    if (model::is_imm_int(stack_top)) {
+        // 立即数离开操作数栈时装箱, 调用方持有装箱后对象的引用
+        stack_top = model::box_value(stack_top);
+        stack_top->make_ref();
+    }
+    return stack_top;
+}
+
+model::Object* Vm::pop_stack_raw() {
     if(op_stack.empty()) throw KizStopRunningSignal("Unable to fetch top of stack");
     auto stack_top = op_stack.back();
     if (!stack_top) throw KizStopRunningSignal("Top of stack is free");
+    assert(borrowed_on_stack == 0 && "borrowed operand popped as an owned reference");
     op_stack.pop_back();
     return stack_top;
 }
@@ -183,7 +320,7 @@ model::Object* Vm::simple_get_and_pop_stack_top() {
 
 void Vm::push_to_stack(model::Object* obj) {
     if (obj == nullptr) return;
-    obj->make_ref(); // 栈成为新持有者，增加引用计数
+    model::ref_value(obj); // 栈成为新持有者，增加引用计数
     op_stack.push_back(obj);
 }
 
@@ -205,7 +342,7 @@ void Vm::reset_global_code(model::CodeObject* code_object) {
     exec_curr_code();
 }
 
-std::string Vm::get_attr_name_by_idx(const size_t idx) {
+const std::string& Vm::get_attr_name_by_idx(const size_t idx) {
     auto frame = get_frame();
     return frame->code_object->attr_names[idx];
 }
@@ -216,12 +353,25 @@ void Vm::assert_argc(size_t argc, const model::List* args) {
         return;
     }
     throw NativeFuncError("ArgCountError", std::format(
-        "expect {} arguments but got {} arguments", args->val.size(), argc
+        "expect {} arguments but got {} arguments", argc, args->val.size()
+    ));
+}
+
+void Vm::assert_argc(const size_t argc, const std::span<model::Object* const> args) {
+    if (argc == args.size()) {
+        return;
+    }
+    throw NativeFuncError("ArgCountError", std::format(
+        "expect {} arguments but got {} arguments", argc, args.size()
     ));
 }
 
 void Vm::assert_argc(const std::vector<size_t>& argcs, const model::List* args) {
-    auto actually_count = args->val.size();
+    assert_argc(argcs, std::span<model::Object* const>(args->val));
+}
+
+void Vm::assert_argc(const std::vector<size_t>& argcs, const std::span<model::Object* const> args) {
+    auto actually_count = args.size();
     for (size_t i : argcs) {
         if (i == actually_count) {
             return;
@@ -247,8 +397,8 @@ std::filesystem::path Vm::get_current_file_path() {
     std::filesystem::path current_file_path = "";
     if (main_file_path == "<shell#>") return current_file_path;
     for (const auto& frame: std::ranges::reverse_view(call_stack)) {
-        if (frame->owner->get_type() == model::Object::ObjectType::Module) {
-            const auto m = dynamic_cast<model::Module*>(frame->owner);
+        if (frame.owner->get_type() == model::Object::ObjectType::Module) {
+            const auto m = model::as<model::Module>(frame.owner);
             current_file_path = m->path;
         }
     }
@@ -7,8 +7,13 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <ostream>
+#include <span>
 
 #include "../../depends/hashmap.hpp"
 
@@ -19,15 +24,14 @@
 #include "../kiz.hpp"
 #include "../error/error_reporter.hpp"
 
-#define ADVANCE_PC \
-    if (curr_inst.opc != Opcode::JUMP \
-        && curr_inst.opc != Opcode::JUMP_IF_FALSE \
-        && curr_inst.opc != Opcode::RET \
-        && curr_inst.opc != Opcode::THROW \
-        && curr_inst.opc != Opcode::JUMP_IF_FINISH_ITER\
-    ) { \
-                curr_frame->pc++; \
-    }
+// 支持"标签地址"扩展的编译器使用直接线程化分派(computed goto), 其余回退到switch
+#if !defined(KIZ_COMPUTED_GOTO)
+#if defined(__GNUC__) || defined(__clang__)
+#define KIZ_COMPUTED_GOTO 1
+#else
+#define KIZ_COMPUTED_GOTO 0
+#endif
+#endif
 
 
 namespace model {
@@ -37,36 +41,194 @@ class Object;
 class List;
 class Int;
 class Error;
+class Shape;
+class NativeFunction;
+enum class Magic : uint8_t;
 }
 
 namespace kiz {
 
 enum class Opcode : uint8_t;
 
-struct Instruction {
+///| 代码生成阶段使用的指令, 生成完毕后由CodeObject打包为Instruction
+struct IrInstruction {
     Opcode opc;
     std::vector<size_t> opn_list;
     err::PositionInfo pos{};
-    Instruction(Opcode o, std::vector<size_t> ol, err::PositionInfo& p) : opc(o), opn_list(std::move(ol)), pos(p) {}
+    IrInstruction(Opcode o, std::vector<size_t> ol, err::PositionInfo& p) : opc(o), opn_list(std::move(ol)), pos(p) {}
 };
 
-struct CallFrame {
-    std::string name;
+///| 打包后的指令: 定长8字节, 操作数内联, 源码位置移至PositionTable
+struct Instruction {
+    Opcode opc;
+    uint8_t ext = 0;     // 自适应特化的预热计数
+    uint16_t opn_b = 0;  // 第二操作数(如CALL_METHOD的参数个数)
+    uint32_t opn = 0;    // 主操作数
+};
+static_assert(sizeof(Instruction) == 8);
+
+///| 操作数栈的初始预留容量(槽数)
+constexpr size_t op_stack_reserve = 1 << 16;
+
+///| 原生代码回调kiz代码(运算符慢速路径调用魔术方法, print调用__str__等)的最大嵌套层数.
+///| 每层回调在C++栈上再嵌套一个分派循环, 调用帧数上限约束不到它; ASan下每层占用的C++栈大几十倍
+#if defined(__SANITIZE_ADDRESS__)
+constexpr size_t max_native_depth = 150;
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+constexpr size_t max_native_depth = 150;
+#else
+constexpr size_t max_native_depth = 500;
+#endif
+#else
+constexpr size_t max_native_depth = 500;
+#endif
+
+///| 通用指令连续观察到同一组操作数类型达到该次数后, 原地改写为特化指令
+constexpr uint8_t quicken_warmup = 8;
+
+///| 自适应特化统计, 按特化指令的操作码索引, 由--stats在退出时输出
+struct QuickenStats {
+    size_t specialized[256] {};  // 通用指令被改写为该指令的次数
+    size_t hits[256] {};         // 守卫通过次数
+    size_t misses[256] {};       // 守卫失败并回退到通用指令的次数
+};
+
+///| 循环垃圾回收的代数: 第0代收新登记的对象, 每次回收的存活者晋升一代
+constexpr size_t gc_generation_count = 3;
+
+///| 循环垃圾回收统计, 由gc.stats()读取
+struct GcStats {
+    size_t collections[gc_generation_count] {};  // 以第i代为最老代的回收次数
+    size_t collected = 0;          // 累计释放的环状垃圾对象数
+    uint64_t total_pause_ns = 0;   // 累计停顿时间
+    uint64_t max_pause_ns = 0;     // 单次最长停顿
+    uint64_t last_pause_ns = 0;    // 最近一次停顿
+};
+
+///| 源码位置旁表: 只记录位置发生变化的指令(游程压缩), 仅在报错/回溯时查询
+class PositionTable {
+    struct Entry {
+        uint32_t start_pc;
+        uint32_t lno_start;
+        uint32_t lno_end;
+        uint32_t col_start;
+        uint32_t col_end;
+    };
+    std::vector<Entry> entries;
+public:
+    void add(size_t pc, const err::PositionInfo& pos) {
+        if (!entries.empty()) {
+            const auto& last = entries.back();
+            if (last.lno_start == pos.lno_start and last.lno_end == pos.lno_end
+                and last.col_start == pos.col_start and last.col_end == pos.col_end) {
+                return;
+            }
+        }
+        entries.push_back({
+            static_cast<uint32_t>(pc),
+            static_cast<uint32_t>(pos.lno_start), static_cast<uint32_t>(pos.lno_end),
+            static_cast<uint32_t>(pos.col_start), static_cast<uint32_t>(pos.col_end)
+        });
+    }
+
+    [[nodiscard]] err::PositionInfo find(size_t pc) const {
+        // 找到最后一个start_pc <= pc的表项
+        auto it = std::upper_bound(entries.begin(), entries.end(), pc,
+            [](size_t target, const Entry& e) { return target < e.start_pc; });
+        if (it == entries.begin()) return {};
+        --it;
+        return {it->lno_start, it->lno_end, it->col_start, it->col_end};
+    }
+
+    [[nodiscard]] size_t size() const { return entries.size(); }
+};
+
+///| 把代码生成阶段的指令打包为定长指令流和位置旁表
+inline void assemble(const std::vector<IrInstruction>& ir, std::vector<Instruction>& code, PositionTable& positions) {
+    code.clear();
+    code.reserve(ir.size());
+    for (size_t pc = 0; pc < ir.size(); ++pc) {
+        const auto& i = ir[pc];
+        Instruction packed{i.opc};
+        if (!i.opn_list.empty()) {
+            assert(i.opn_list[0] <= UINT32_MAX);
+            packed.opn = static_cast<uint32_t>(i.opn_list[0]);
+        }
+        if (i.opn_list.size() > 1) {
+            assert(i.opn_list[1] <= UINT16_MAX);
+            packed.opn_b = static_cast<uint16_t>(i.opn_list[1]);
+        }
+        code.push_back(packed);
+        positions.add(pc, i.pos);
+    }
+}
 
-    model::Object* owner;
+///| 借用操作数标记(窥孔), 见vm.cpp. entry_pcs为跳转指令以外的控制流入口(异常处理代码)
+void mark_borrowed_operands(std::vector<Instruction>& code, const std::vector<size_t>& entry_pcs);
+
+///| 属性内联缓存
+///| 接收者的Shape与shape相同时, slot直接给出属性(own)或__parent__所在的槽位;
+///| 属性不在接收者自身时, 再记录其__parent__和从__parent__起沿原型链查到的值,
+///| 接收者的__parent__相同且model::proto_epoch未变化时直接命中
+struct AttrCache {
+    const model::Shape* shape = nullptr;
+    uint32_t slot = 0;
+    bool own = false;
+    model::Object* parent = nullptr;
+    model::Object* value = nullptr;
+    uint64_t epoch = 0;
+};
+
+struct CallFrame {
+    model::Object* owner = nullptr;  // Function或Module, 帧名由它给出(见Vm::frame_name)
 
     size_t pc = 0;
-    size_t return_to_pc;
-    size_t last_bp;
-    size_t bp;
-    model::CodeObject* code_object;
+    size_t bp = 0;
+    model::CodeObject* code_object = nullptr;
     
     std::vector<model::Object*> iters;
 
-    model::Object* curr_error;
+    model::Object* curr_error = nullptr;
     bool exec_ensure_stmt = false;
 };
 
+///| 调用帧栈: 所有帧在一块预分配的连续内存中按深度排布, 压栈/出栈不分配内存.
+///| 帧槽按深度复用(iters保留容量), 帧指针在帧存活期间保持稳定.
+///| 容量即最大调用深度, 由Vm::push_frame检查
+class FrameStack {
+    std::unique_ptr<CallFrame[]> frames_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+
+public:
+    ///| 重新分配帧区域, 只能在没有活动帧时调用
+    void reserve(const size_t capacity) {
+        assert(size_ == 0);
+        if (capacity == capacity_) return;
+        frames_ = std::make_unique<CallFrame[]>(capacity);
+        capacity_ = capacity;
+    }
+
+    ///| 取出下一个帧槽, 由调用方填写字段
+    CallFrame* push() {
+        assert(size_ < capacity_);
+        return &frames_[size_++];
+    }
+    void pop_back() { assert(size_ > 0); --size_; }
+    void clear() { size_ = 0; }
+
+    [[nodiscard]] CallFrame* back() const { return &frames_[size_ - 1]; }
+    [[nodiscard]] CallFrame* operator[](const size_t i) const { return &frames_[i]; }
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] size_t capacity() const { return capacity_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    [[nodiscard]] bool full() const { return size_ == capacity_; }
+
+    [[nodiscard]] CallFrame* begin() const { return frames_.get(); }
+    [[nodiscard]] CallFrame* end() const { return frames_.get() + size_; }
+};
+
 class StackRef {
     model::Object* obj;
 public:
@@ -84,7 +246,10 @@ public:
     static model::Module* main_module;
 
     static std::vector<model::Object*> op_stack;
-    static std::vector<CallFrame*> call_stack;
+    static FrameStack call_stack;
+    static size_t max_call_depth;  // 最大调用深度, 可由命令行--max-depth设置
+    ///| --max-depth的上限: 帧区域按最大调用深度一次性分配, 每帧几十字节
+    static constexpr size_t max_call_depth_limit = 4'000'000;
 
     static model::Int* small_int_pool[201];
     static std::vector<model::Object*> const_pool;
@@ -96,34 +261,93 @@ public:
     static bool running;
     static std::string main_file_path;
 
+    static QuickenStats quicken_stats;
+
+    static GcStats gc_stats;
+
+#ifndef NDEBUG
+    ///| 操作数栈上借用(未持有引用)的操作数个数, 仅在启用assert时维护;
+    ///| 借用只存在于加载与紧随的消费者指令之间, 其余出栈路径与异常展开时必须为0
+    static size_t borrowed_on_stack;
+#endif
+    ///| gc_thresholds[0]: 第0代净增多少对象触发回收; [i]: 第i-1代回收多少次后连带回收第i代
+    static size_t gc_thresholds[gc_generation_count];
+    static bool gc_enabled;
+    static size_t run_depth;  // run_frames的嵌套层数, 大于1表示正在原生函数的回调中执行, 上限max_native_depth
+    static size_t run_base;   // 最内层run_frames的base_depth, 异常展开不越过这一层
+
     explicit Vm(const std::string& file_path_);
 
     ///| 核心执行循环
     static void set_main_module(model::Module* src_module);
     static void exec_curr_code();
     static void reset_global_code(model::CodeObject* code_object);
-    static void execute_unit(const Instruction& instruction);
+
+    ///| 执行调用栈中高于base_depth的栈帧, 直到它们全部返回(或第base_depth+1层帧执行到代码末尾)
+    ///| 原生错误在此统一捕获并转发到handle_throw, 不进入逐条指令的执行路径;
+    ///| 内层循环抛出的KizUnwindSignal在此继续展开
+    static void run_frames(size_t base_depth);
+    ///| 指令分派循环: 每个指令处理器自行维护pc
+    static void execute_unit(size_t base_depth);
+    ///| 输出自适应特化的命中/回退统计
+    static void dump_quicken_stats(std::ostream& out);
+
+    ///| 循环垃圾回收(gc.cpp)
+    ///| 试删除回收第0代到第generation代中的引用环, 返回释放的对象数.
+    ///| 只能在没有原生函数持有未计数临时对象时调用(最外层分派循环的指令边界)
+    static size_t collect_cycles(size_t generation);
+    ///| 安全点: 第0代净增超过阈值时调用, 按各代阈值决定回收到哪一代
+    static void collect_cycles_if_needed();
+
+    ///| 帧操作
+    ///| 压入新帧并持有owner与code_object的引用, 超出最大调用深度时抛出RecursionError
+    static CallFrame* push_frame(model::Object* owner, model::CodeObject* code_object, size_t bp);
+    ///| 弹出栈顶帧: 释放其局部变量与临时值(操作数栈截断到bp)、迭代器和持有的引用
+    static void pop_frame();
+    static std::string frame_name(const CallFrame* frame);
 
     ///| 栈操作
     static CallFrame* get_frame();
     static StackRef get_and_pop_stack_top(); // 返回StackRef对象，参与RAII
     static model::Object* simple_get_and_pop_stack_top(); // 直接返回栈顶值, 需手动del_refc
+    static model::Object* pop_stack_raw(); // 同上, 但立即数不装箱, 需用model::unref_value释放
     static void push_to_stack(model::Object* obj);
-    static std::string get_attr_name_by_idx(size_t idx);
+    static const std::string& get_attr_name_by_idx(size_t idx);
 
-    ///| 如果新增了调用栈，执行循环仅处理新增的模块栈帧（call_stack.size() > old_stack_size），不影响原有调用栈
-    static void call_function(model::Object* func_obj, std::vector<model::Object*> args, model::Object* self);
+    ///| 如果新增了调用栈，执行循环仅处理新增的模块栈帧（call_stack.size() > old_stack_size），不影响原有调用栈.
+    ///| 嵌套的执行循环超过max_native_depth层时抛出RecursionError
+    static void call_function(model::Object* func_obj, std::span<model::Object* const> args, model::Object* self);
+    static void call_function(model::Object* func_obj, const std::vector<model::Object*>& args, model::Object* self);
 
-    ///| 运算符与普通方法分规则查找
-    static void call_method(model::Object* obj, const std::string& attr_name, std::vector<model::Object*> args);
+    ///| 运算符与普通方法分规则查找: 魔术方法名转到call_magic, 其余从对象自身查找
+    static void call_method(model::Object* obj, const std::string& attr_name, const std::vector<model::Object*>& args);
+
+    ///| 魔术方法分派: 从obj的原型的槽位表取方法, 原生方法直接调用, 结果压入操作数栈
+    static void call_magic(model::Object* obj, model::Magic magic, std::span<model::Object* const> args);
+    static void call_magic(model::Object* obj, const model::Magic magic, const std::initializer_list<model::Object*> args) {
+        call_magic(obj, magic, std::span<model::Object* const>(args.begin(), args.size()));
+    }
+    ///| 从原型proto(含自身)起沿原型链解析魔术方法, 结果缓存在proto的槽位表中, 没有返回nullptr
+    static model::Object* get_magic(model::Object* proto, model::Magic magic);
+    ///| obj的魔术方法(从其原型开始解析), 没有返回nullptr
+    static model::Object* find_magic(model::Object* obj, model::Magic magic);
+    ///| 记录内置原型安装的魔术方法(见model::BuiltinMagicGuard), 在内置方法全部安装后调用一次
+    static void record_builtin_magic();
+    ///| 内置原型被修改后重新解析并比较, 更新model::builtin_magic_guard
+    static void refresh_builtin_magic();
+    ///| 直接调用原生函数, 参数由调用方持有; 返回值已增加一个引用, 由调用方接管
+    static model::Object* call_native(model::NativeFunction* func, model::Object* self, std::span<model::Object* const> args);
 
     ///| 如果用户函数则创建调用栈，如果内置函数则执行并压上返回值
-    static void handle_call(model::Object* func_obj, model::Object* args_obj, model::Object* self=nullptr);
+    ///| 参数为操作数栈顶的argc个值(由栈持有引用), 调用后由被调用方消费:
+    ///| 用户函数直接把它们作为新帧的前argc个局部变量槽, 原生函数返回后弹出
+    static void handle_call(model::Object* func_obj, size_t argc, model::Object* self=nullptr);
 
     ///| 处理import
     static void handle_import(const std::string& module_path);
 
-    ///| 处理报错(设置到catch)或者进行traceback
+    ///| 处理报错(设置到catch)或者进行traceback.
+    ///| 处理位置在最内层run_frames之外时, 只弹出到run_base并抛出KizUnwindSignal
     static void handle_throw();
     static void handle_ensure();
 
@@ -133,8 +357,15 @@ public:
     static void entry_std_modules();
 
     ///| @utils
+    ///| 属性查找分两类: get_*找不到时抛出NameError, 用于错误需要传播到kiz代码的场合;
+    ///| try_*找不到时返回nullptr, 用于只是探测属性是否存在的场合(不以异常作为控制流).
+    ///| 返回的对象都不增加引用
     static model::Object* get_attr(model::Object* obj, const std::string& attr);
+    static model::Object* try_get_attr(model::Object* obj, const std::string& attr);
+    ///| 带内联缓存的属性查找, name_idx为当前帧CodeObject的属性名索引
+    static model::Object* get_attr_cached(model::Object* obj, size_t name_idx, AttrCache& cache);
     static model::Object* get_attr_current(model::Object* obj, const std::string& attr);
+    static model::Object* try_get_attr_current(model::Object* obj, const std::string& attr);
     static bool is_true(model::Object* obj);
     static std::string obj_to_str(model::Object* for_cast_obj);
     static std::string obj_to_debug_str(model::Object* for_cast_obj);
@@ -147,6 +378,8 @@ public:
     ///| @utils: 供builtins检查参数
     static void assert_argc(size_t argc, const model::List* args);
     static void assert_argc(const std::vector<size_t>& argcs, const model::List* args);
+    static void assert_argc(size_t argc, std::span<model::Object* const> args);
+    static void assert_argc(const std::vector<size_t>& argcs, std::span<model::Object* const> args);
 
     ///| @utils: 路径处理
     static std::filesystem::path get_exe_abs_dir();
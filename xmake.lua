@@ -17,8 +17,26 @@ target("version")
         end
     end)
 
+-- 引用计数默认非原子(VM单线程); xmake f --atomic_refcount=y 只让计数增减变为原子操作,
+-- 其余运行时状态仍无同步, 不能据此在线程间共享对象
+option("atomic_refcount")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Use atomic reference count updates (other runtime state stays unsynchronized)")
+    add_defines("KIZ_ATOMIC_REFCOUNT=1")
+option_end()
+
+-- 运行时对象不走slab内存池(AddressSanitizer下自动打开), 便于ASan检查释放后使用: xmake f --no_slab=y
+option("no_slab")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Allocate runtime objects with the global allocator instead of slab pools")
+    add_defines("KIZ_NO_SLAB=1")
+option_end()
+
 target("kiz")
     set_kind("binary")
+    add_options("atomic_refcount", "no_slab")
 
     -- 入口文件
     add_files("src/main.cpp")
@@ -46,6 +64,7 @@ target("kiz")
     add_files("src/vm/handle_error.cpp")
     add_files("src/vm/handle_call.cpp")
     add_files("src/vm/handle_make.cpp")
+    add_files("src/vm/gc.cpp")
 
     -- 工具模块
     add_files("src/error/error_reporter.cpp")
@@ -57,12 +76,15 @@ target("kiz")
     add_files("libs/builtins/bool_methods.cpp")
     add_files("libs/builtins/int_methods.cpp")
     add_files("libs/builtins/decimal_methods.cpp")
+    add_files("libs/builtins/float_methods.cpp")
     add_files("libs/builtins/nil_methods.cpp")
     add_files("libs/builtins/str_methods.cpp")
     add_files("libs/builtins/list_methods.cpp")
     add_files("libs/builtins/dict_methods.cpp")
     add_files("libs/builtins/builtin_functions.cpp")
     add_files("libs/os/os_lib.cpp")
+    add_files("libs/math/math_lib.cpp")
+    add_files("libs/gc/gc_lib.cpp")
     add_files("libs/builtins/builtins_lib.cpp")
     add_files("libs/builtins/file_handle_methods.cpp")
     add_files("libs/builtins/object_methods.cpp")